@@ -335,21 +335,16 @@ public:
     */
     static Notification json2ntf(json::Value const& jval)
     {
-        try
-        {
-            Notification ntf;
-            ntf.id = jval["id"].asUInt();
-            ntf.name = jval["notification"].asString();
-            ntf.params = jval["parameters"];
-            return ntf;
-        }
-        catch (std::exception const& ex)
+        Notification ntf;
+        String error;
+        if (!notificationSchema().extract(jval, ntf, &error))
         {
             OStringStream ess;
             ess << "failed to deserialize Notification:\n"
-                << ex.what();
+                << error;
             throw std::runtime_error(ess.str().c_str());
         }
+        return ntf;
     }
 
 
@@ -376,28 +371,266 @@ public:
     */
     static Command json2cmd(json::Value const& jval)
     {
-        try
-        {
-            Command cmd;
-            cmd.id = jval["id"].asUInt();
-            cmd.name = jval["command"].asString();
-            cmd.params = jval["parameters"];
-            cmd.lifetime = int(jval["lifetime"].asInt());
-            cmd.flags = int(jval["flags"].asInt());
-            cmd.status = jval["status"].asString();
-            cmd.result = jval["result"].asString();
-            return cmd;
-        }
-        catch (std::exception const& ex)
+        Command cmd;
+        String error;
+        if (!commandSchema().extract(jval, cmd, &error))
         {
             OStringStream ess;
             ess << "failed to deserialize Command:\n"
-                << ex.what();
+                << error;
             throw std::runtime_error(ess.str().c_str());
         }
+        return cmd;
     }
 
 
+    /// @brief The command list reader.
+    /**
+    This JSON events handler converts the array of commands directly
+    into the command list. No intermediate JSON document is built,
+    only the command parameters are built as JSON values.
+
+    The command fields are converted by the same schema json2cmd() uses.
+    */
+    class CommandListReader:
+        public json::Handler
+    {
+    public:
+
+        /// @brief The main constructor.
+        /**
+        @param[out] commands The command list to fill.
+        */
+        explicit CommandListReader(std::vector<Command> &commands)
+            : m_commands(commands)
+            , m_params(m_dummy)
+            , m_depth(0)
+            , m_skipDepth(0)
+            , m_inParams(false)
+        {}
+
+    public:
+
+        /// @copydoc json::Handler::onNull()
+        void onNull()
+        {
+            if (m_inParams)
+            {
+                m_params.onNull();
+                checkParams();
+            }
+            else
+                assign(json::Value());
+        }
+
+
+        /// @copydoc json::Handler::onBoolean()
+        void onBoolean(bool val)
+        {
+            if (m_inParams)
+            {
+                m_params.onBoolean(val);
+                checkParams();
+            }
+            else
+                assign(json::Value(val));
+        }
+
+
+        /// @copydoc json::Handler::onInteger()
+        void onInteger(Int64 val)
+        {
+            if (m_inParams)
+            {
+                m_params.onInteger(val);
+                checkParams();
+            }
+            else
+                assign(json::Value(val));
+        }
+
+
+        /// @copydoc json::Handler::onUInteger()
+        void onUInteger(UInt64 val)
+        {
+            if (m_inParams)
+            {
+                m_params.onUInteger(val);
+                checkParams();
+            }
+            else
+                assign(json::Value(val));
+        }
+
+
+        /// @copydoc json::Handler::onDouble()
+        void onDouble(double val)
+        {
+            if (m_inParams)
+            {
+                m_params.onDouble(val);
+                checkParams();
+            }
+            else
+                assign(json::Value(val));
+        }
+
+
+        /// @copydoc json::Handler::onString()
+        void onString(String &val)
+        {
+            if (m_inParams)
+            {
+                m_params.onString(val);
+                checkParams();
+            }
+            else
+                assign(json::Value(val));
+        }
+
+    public:
+
+        /// @copydoc json::Handler::onArrayBegin()
+        void onArrayBegin()
+        {
+            if (m_inParams)
+                m_params.onArrayBegin();
+            else
+            {
+                assign(json::Value(json::Value::TYPE_ARRAY)); // check field type
+                enter(0 == m_depth);
+            }
+        }
+
+
+        /// @copydoc json::Handler::onArrayEnd()
+        void onArrayEnd()
+        {
+            if (m_inParams)
+            {
+                m_params.onArrayEnd();
+                checkParams();
+            }
+            else
+                leave();
+        }
+
+    public:
+
+        /// @copydoc json::Handler::onObjectBegin()
+        void onObjectBegin()
+        {
+            if (m_inParams)
+                m_params.onObjectBegin();
+            else
+            {
+                if (1 == m_depth && !m_skipDepth) // new command
+                    m_commands.push_back(Command());
+                assign(json::Value(json::Value::TYPE_OBJECT)); // check field type
+                enter(1 == m_depth);
+            }
+        }
+
+
+        /// @copydoc json::Handler::onMemberName()
+        void onMemberName(String const& name)
+        {
+            if (m_inParams)
+                m_params.onMemberName(name);
+            else if (2 == m_depth && !m_skipDepth)
+            {
+                if (name == "parameters") // build parameters
+                {
+                    m_params = json::ValueBuilder(m_commands.back().params);
+                    m_inParams = true;
+                }
+                else
+                    m_field = name;
+            }
+        }
+
+
+        /// @copydoc json::Handler::onObjectEnd()
+        void onObjectEnd()
+        {
+            if (m_inParams)
+            {
+                m_params.onObjectEnd();
+                checkParams();
+            }
+            else
+                leave();
+        }
+
+    private:
+
+        /// @brief Enter the nested array or object.
+        /**
+        Only the top array of command objects is used,
+        all other nested values are ignored.
+
+        @param[in] expected The "expected value" flag.
+        */
+        void enter(bool expected)
+        {
+            if (m_skipDepth || !expected)
+                m_skipDepth += 1;
+            else
+                m_depth += 1;
+        }
+
+
+        /// @brief Leave the nested array or object.
+        void leave()
+        {
+            if (m_skipDepth)
+                m_skipDepth -= 1;
+            else
+            {
+                m_depth -= 1;
+                m_field.clear();
+            }
+        }
+
+
+        /// @brief Stop building parameters if they are complete.
+        void checkParams()
+        {
+            if (m_params.isComplete())
+                m_inParams = false;
+        }
+
+
+        /// @brief Assign the current command field.
+        /**
+        @param[in] jval The field value.
+        */
+        void assign(json::Value const& jval)
+        {
+            if (2 != m_depth || m_skipDepth)
+                return; // ignore
+
+            String error;
+            if (!commandSchema().extractMember(m_field, jval, m_commands.back(), &error))
+            {
+                OStringStream ess;
+                ess << "failed to deserialize Command:\n"
+                    << error;
+                throw std::runtime_error(ess.str().c_str());
+            }
+        }
+
+    private:
+        std::vector<Command> &m_commands; ///< @brief The command list.
+        json::Value m_dummy; ///< @brief The unused value.
+        json::ValueBuilder m_params; ///< @brief The parameters builder.
+        String m_field; ///< @brief The current field name.
+        int m_depth; ///< @brief The nesting level.
+        int m_skipDepth; ///< @brief The nesting level of ignored values.
+        bool m_inParams; ///< @brief The "parameters are building" flag.
+    };
+
+
     /// @brief Convert the command to the JSON value.
     /**
     @param[in] cmd The command to convert.
@@ -424,14 +657,32 @@ public:
     @param[in,out] deviceClass The device class to update.
     */
     static void json2deviceClass(json::Value const& jval, Device::ClassPtr deviceClass)
+    {
+        json2deviceClass(jval["id"], jval["name"], jval["version"],
+            jval["isPermanent"], jval["offlineTimeout"], deviceClass);
+    }
+
+
+    /// @brief Update device class from the extracted JSON fields.
+    /**
+    @param[in] id The "id" field.
+    @param[in] name The "name" field.
+    @param[in] version The "version" field.
+    @param[in] isPermanent The "isPermanent" field.
+    @param[in] offlineTimeout The "offlineTimeout" field.
+    @param[in,out] deviceClass The device class to update.
+    */
+    static void json2deviceClass(json::Value const& id, json::Value const& name,
+        json::Value const& version, json::Value const& isPermanent,
+        json::Value const& offlineTimeout, Device::ClassPtr deviceClass)
     {
         try
         {
-            deviceClass->id = jval["id"].asUInt();
-            deviceClass->name = jval["name"].asString();
-            deviceClass->version = jval["version"].asString();
-            deviceClass->isPermanent = jval["isPermanent"].asBool();
-            deviceClass->offlineTimeout = int(jval["offlineTimeout"].asInt());
+            deviceClass->id = id.asUInt();
+            deviceClass->name = name.asString();
+            deviceClass->version = version.asString();
+            deviceClass->isPermanent = isPermanent.asBool();
+            deviceClass->offlineTimeout = int(offlineTimeout.asInt());
         }
         catch (std::exception const& ex)
         {
@@ -468,13 +719,27 @@ public:
     @param[in,out] network The network to update.
     */
     static void json2network(json::Value const& jval, NetworkPtr network)
+    {
+        json2network(jval["id"], jval["name"], jval["description"], network);
+    }
+
+
+    /// @brief Update network from the extracted JSON fields.
+    /**
+    @param[in] id The "id" field.
+    @param[in] name The "name" field.
+    @param[in] desc The "description" field.
+    @param[in,out] network The network to update.
+    */
+    static void json2network(json::Value const& id, json::Value const& name,
+        json::Value const& desc, NetworkPtr network)
     {
         try
         {
-            network->id = jval["id"].asUInt();
-            network->name = jval["name"].asString();
+            network->id = id.asUInt();
+            network->name = name.asString();
             //network->key = jval["key"].asString();
-            network->desc = jval["description"].asString();
+            network->desc = desc.asString();
         }
         catch (std::exception const& ex)
         {
@@ -554,29 +819,38 @@ public:
 
     /// @brief Update device from the JSON value.
     /**
+    All device, network and device class fields are
+    extracted in one JSON document traversal.
+
     @param[in] jval The JSON value.
     @param[in,out] device The device to update.
     */
     static void json2device(json::Value const& jval, DevicePtr device)
     {
+        json::Value const* f[DEVICE_FIELD_COUNT];
+        deviceFields().extract(jval, f);
+
         try
         {
             { // just check identifier is the same!
-                const String id = jval["id"].asString();
+                const String id = f[DEVICE_ID]->asString();
                 if (id.empty())
                     throw std::runtime_error("identifier is empty");
                 if (device->id != id)
                     throw std::runtime_error("invalid identifier");
             }
 
-            device->name = jval["name"].asString();
+            device->name = f[DEVICE_NAME]->asString();
             //device->key = jval["key"].asString();
-            device->status = jval["status"].asString();
-            json2network(jval["network"], device->network);
-            json2deviceClass(jval["deviceClass"], device->deviceClass);
+            device->status = f[DEVICE_STATUS]->asString();
+
+            json2network(*f[NETWORK_ID], *f[NETWORK_NAME],
+                *f[NETWORK_DESC], device->network);
+            json2deviceClass(*f[CLASS_ID], *f[CLASS_NAME], *f[CLASS_VERSION],
+                *f[CLASS_IS_PERMANENT], *f[CLASS_OFFLINE_TIMEOUT], device->deviceClass);
 
             { // equipment
-                json::Value const& json_eq = jval["equipment"];
+                json::Value const& json_eq = *f[DEVICE_EQUIPMENT];
                 if (!json_eq.isNull() && !json_eq.isArray())
                     throw std::runtime_error("equipment is not an array");
 
@@ -623,6 +897,123 @@ public:
         jval["equipment"] = json_eq;
         return jval;
     }
+
+
+    /// @brief Get the changed device members.
+    /**
+    The JSON Merge Patch (see json::Patch::mergeDiff()) of two device
+    documents, except the "network", "deviceClass" and "equipment" members
+    are never patched partially: the server identifies these records
+    by all their fields (name, key, version), so they are sent whole
+    if any field is changed.
+
+    @param[in] last The last registered device document.
+    @param[in] jdevice The current device document.
+    @return The device merge patch.
+    */
+    static json::Value deviceDiff(json::Value const& last, json::Value const& jdevice)
+    {
+        json::Value patch = json::Patch::mergeDiff(last, jdevice);
+        if (!patch.isObject())
+            return patch;
+
+        static const char* const WHOLE[] = { "network", "deviceClass", "equipment" };
+        for (size_t i = 0; i < sizeof(WHOLE)/sizeof(WHOLE[0]); ++i)
+        {
+            const String name = WHOLE[i];
+            json::Value const& changed = static_cast<json::Value const&>(patch)[name];
+            if (!changed.isNull()) // changed, replace with whole value
+                patch[name] = jdevice[name];
+        }
+
+        return patch;
+    }
+
+private:
+
+    /// @brief Get the notification schema.
+    /**
+    @return The schema used by json2ntf().
+    */
+    static json::Schema<Notification> const& notificationSchema()
+    {
+        static const json::Schema<Notification> schema = json::Schema<Notification>()
+            .add("id", &Notification::id)
+            .add("notification", &Notification::name)
+            .add("parameters", &Notification::params);
+        return schema;
+    }
+
+
+    /// @brief Get the command schema.
+    /**
+    @return The schema used by json2cmd().
+    */
+    static json::Schema<Command> const& commandSchema()
+    {
+        static const json::Schema<Command> schema = json::Schema<Command>()
+            .add("id", &Command::id)
+            .add("command", &Command::name)
+            .add("parameters", &Command::params)
+            .add("lifetime", &Command::lifetime)
+            .add("flags", &Command::flags)
+            .add("status", &Command::status)
+            .add("result", &Command::result);
+        return schema;
+    }
+
+
+    /// @brief The device fields used by json2device().
+    enum DeviceField
+    {
+        DEVICE_ID,
+        DEVICE_NAME,
+        DEVICE_STATUS,
+        DEVICE_EQUIPMENT,
+        NETWORK_ID,
+        NETWORK_NAME,
+        NETWORK_DESC,
+        CLASS_ID,
+        CLASS_NAME,
+        CLASS_VERSION,
+        CLASS_IS_PERMANENT,
+        CLASS_OFFLINE_TIMEOUT,
+        DEVICE_FIELD_COUNT
+    };
+
+
+    /// @brief Get the device fields.
+    /**
+    The JSON pointers are added in the DeviceField order.
+
+    @return The precompiled device fields.
+    */
+    static json::PointerSet const& deviceFields()
+    {
+        static const json::PointerSet fields = makeDeviceFields();
+        return fields;
+    }
+
+
+    /// @brief Create the device fields.
+    /**
+    @return The device fields.
+    */
+    static json::PointerSet makeDeviceFields()
+    {
+        static const char* const PATHS[DEVICE_FIELD_COUNT] =
+        {
+            "/id", "/name", "/status", "/equipment",
+            "/network/id", "/network/name", "/network/description",
+            "/deviceClass/id", "/deviceClass/name", "/deviceClass/version",
+            "/deviceClass/isPermanent", "/deviceClass/offlineTimeout"
+        };
+
+        json::PointerSet fields;
+        for (size_t i = 0; i < DEVICE_FIELD_COUNT; ++i)
+            fields.add(PATHS[i]);
+        return fields;
+    }
 };
 
 public:
@@ -651,6 +1042,9 @@ private:
     http::Url m_baseUrl;            ///< @brief The base URL.
     size_t m_timeout_ms;            ///< @brief The HTTP request timeout, milliseconds.
 
+    bool m_deviceDiff; ///< @brief The incremental device registration flag.
+    std::map<String, json::Value> m_devices; ///< @brief The last registered device documents, by device ID.
+
 
     /// @brief The main constructor.
     /**
@@ -659,10 +1053,29 @@ private:
     */
     ServerAPI(http::Client::SharedPtr httpClient, String const& baseUrl)
         : m_http(httpClient), m_http_major(1), m_http_minor(0),
-          m_log("CloudV6"), m_baseUrl(baseUrl), m_timeout_ms(60000)
+          m_log("CloudV6"), m_baseUrl(baseUrl), m_timeout_ms(60000),
+          m_deviceDiff(false)
     {}
 
 
+private:
+
+    /// @brief Set the JSON request content.
+    /**
+    The JSON value is formatted directly to the chunked buffer
+    which is sent without any intermediate copy.
+
+    @param[in] req The HTTP request.
+    @param[in] jval The JSON value.
+    */
+    static void setJsonContent(http::RequestPtr req, json::Value const& jval)
+    {
+        boost::shared_ptr<json::OutputBuffer> content(new json::OutputBuffer());
+        json::Formatter::write(*content, jval, false);
+        req->setContentBuffer(content);
+    }
+
+
 /// @name Device
 /// @{
 public:
@@ -671,6 +1084,25 @@ public:
     typedef boost::function2<void, boost::system::error_code, Device::SharedPtr> RegisterDeviceCallback;
 
 
+    /// @brief Enable or disable incremental device registration.
+    /**
+    If enabled, the last registered device document is cached and
+    the next registration of the same device sends the changed members only
+    (see Serializer::deviceDiff()). The cached document
+    is dropped on any registration failure, so the full document is sent next time.
+
+    Disabled by default.
+
+    @param[in] enabled The incremental registration flag.
+    */
+    void setDeviceDiff(bool enabled)
+    {
+        m_deviceDiff = enabled;
+        if (!enabled)
+            m_devices.clear();
+    }
+
+
     /// @brief Register device on the server.
     /**
     @param[in] device The device to register.
@@ -682,17 +1114,25 @@ public:
         urlb.appendPath("device");
         urlb.appendPath(device->id);
 
-        const json::Value jcontent = Serializer::device2json(device);
+        json::Value jdevice = Serializer::device2json(device);
+        json::Value jcontent;
+        std::map<String, json::Value>::const_iterator last = m_devices.find(device->id);
+        if (m_deviceDiff && last != m_devices.end())
+            jcontent = Serializer::deviceDiff(last->second, jdevice);
+        else
+            jcontent = jdevice;
+
         http::RequestPtr req = http::Request::PUT(urlb.build());
         req->addHeader(http::header::Content_Type, "application/json");
         req->addHeader("Auth-DeviceID", device->id);
         req->addHeader("Auth-DeviceKey", device->key);
-        req->setContent(json::json2str(jcontent));
+        setJsonContent(req, jcontent);
         req->setVersion(m_http_major, m_http_minor);
 
-        HIVELOG_DEBUG(m_log, "register device:\n" << json::json2hstr(jcontent));
+        HIVELOG_DEBUG(m_log, "register device:\n" << json::HumanFriendly(jcontent));
+        m_devices.erase(device->id); // restored on success
         m_http->send(req, boost::bind(&ThisType::onRegisterDevice, shared_from_this(),
-            _1, _2, _3, device, callback), m_timeout_ms);
+            _1, _2, _3, device, jdevice, callback), m_timeout_ms);
     }
 
 private:
@@ -703,17 +1143,22 @@ private:
     @param[in] request The HTTP request.
     @param[in] response The HTTP response.
     @param[in] device The device registered.
+    @param[in] jdevice The full device document sent.
     @param[in] callback The callback functor.
     */
     void onRegisterDevice(boost::system::error_code err, http::RequestPtr request,
-        http::ResponsePtr response, Device::SharedPtr device, RegisterDeviceCallback callback)
+        http::ResponsePtr response, Device::SharedPtr device, json::Value const& jdevice,
+        RegisterDeviceCallback callback)
     {
         if (!err && response && response->getStatusCode() == http::status::OK)
         {
+            if (m_deviceDiff)
+                m_devices[device->id] = jdevice;
+
             // TODO: handle all exceptions
             json::Value jval = json::str2json(response->getContent());
             HIVELOG_DEBUG(m_log, "got \"register device\" response:\n"
-                << json::json2hstr(jval));
+                << json::HumanFriendly(jval));
             Serializer::json2device(jval, device);
             callback(err, device);
         }
@@ -753,41 +1198,109 @@ public:
         req->setVersion(m_http_major, m_http_minor);
 
         HIVELOG_DEBUG(m_log, "poll commands for \"" << device->id << "\"");
+        PollCommandsReader::SharedPtr reader(new PollCommandsReader());
         m_http->send(req, boost::bind(&ThisType::onPollCommands, shared_from_this(),
-            _1, _2, _3, device, callback), m_timeout_ms);
+            _1, _2, _3, device, reader, callback), m_timeout_ms,
+            boost::bind(&PollCommandsReader::onContent, reader, _1, _2));
     }
 
 private:
 
+    /// @brief The "poll commands" response reader.
+    /**
+    The long-poll response content is parsed as it arrives,
+    so most of the parsing is done while waiting for the rest of data.
+    */
+    class PollCommandsReader:
+        private NonCopyable
+    {
+    public:
+        typedef boost::shared_ptr<PollCommandsReader> SharedPtr; ///< @brief The shared pointer type.
+
+        /// @brief The default constructor.
+        PollCommandsReader()
+            : m_reader(m_commands)
+            , m_parser(m_reader)
+        {}
+
+    public:
+
+        /// @brief Parse the next part of content.
+        /**
+        The parsing error is saved, the rest of content is ignored.
+
+        @param[in] data The content data.
+        @param[in] len The content length in bytes.
+        */
+        void onContent(const char *data, size_t len)
+        {
+            if (!m_error.empty())
+                return; // ignore
+
+            try
+            {
+                m_parser.feed(data, len);
+            }
+            catch (std::exception const& ex)
+            {
+                m_error = ex.what();
+            }
+        }
+
+
+        /// @brief Finish parsing.
+        /**
+        @param[out] commands The parsed commands.
+        @throw std::exception in case of parsing error.
+        */
+        void finish(std::vector<Command> &commands)
+        {
+            if (!m_error.empty())
+                throw std::runtime_error(m_error.c_str());
+            m_parser.finish();
+            commands.swap(m_commands);
+        }
+
+    private:
+        std::vector<Command> m_commands; ///< @brief The parsed commands.
+        Serializer::CommandListReader m_reader; ///< @brief The command list reader.
+        json::IncrementalParser<Serializer::CommandListReader> m_parser; ///< @brief The content parser.
+        String m_error; ///< @brief The parsing error.
+    };
+
+
     /// @brief The "poll commands" completion handler.
     /**
     @param[in] err The error code.
     @param[in] request The HTTP request.
     @param[in] response The HTTP response.
     @param[in] device The device to poll commands for.
+    @param[in] reader The response reader.
     @param[in] callback The callback functor.
     */
     void onPollCommands(boost::system::error_code err, http::RequestPtr request,
-        http::ResponsePtr response, Device::SharedPtr device, PollCommandsCallback callback)
+        http::ResponsePtr response, Device::SharedPtr device,
+        PollCommandsReader::SharedPtr reader, PollCommandsCallback callback)
     {
         std::vector<Command> commands;
-        json::Value jval;
 
         if (!err && response && response->getStatusCode() == http::status::OK)
         {
-            // TODO: handle all exceptions
-            jval = json::str2json(response->getContent());
-            if (jval.isArray())
+            try
             {
-                commands.reserve(jval.size());
-                typedef json::Value::ElementIterator Iterator;
-                for (Iterator i = jval.elementsBegin(); i != jval.elementsEnd(); ++i)
-                    commands.push_back(Serializer::json2cmd(*i));
+                reader->finish(commands);
+                HIVELOG_DEBUG(m_log, "got \"poll commands\" response: "
+                    << commands.size() << " commands");
+            }
+            catch (std::exception const& ex)
+            {
+                HIVELOG_ERROR(m_log, "failed to parse \"poll commands\" response: "
+                    << ex.what());
+                commands.clear();
             }
         }
-
-        HIVELOG_DEBUG(m_log, "got \"poll commands\" response:\n"
-            << json::json2hstr(jval));
+        else
+            HIVELOG_DEBUG_STR(m_log, "no \"poll commands\" response");
 
         callback(err, device, commands);
     }
@@ -817,10 +1330,10 @@ public:
         req->addHeader(http::header::Content_Type, "application/json");
         req->addHeader("Auth-DeviceID", device->id);
         req->addHeader("Auth-DeviceKey", device->key);
-        req->setContent(json::json2str(jbody));
+        setJsonContent(req, jbody);
         req->setVersion(m_http_major, m_http_minor);
 
-        HIVELOG_DEBUG(m_log, "command result:\n" << json::json2hstr(jbody));
+        HIVELOG_DEBUG(m_log, "command result:\n" << json::HumanFriendly(jbody));
         m_http->send(req, boost::bind(&ThisType::onSendCommandResult,
             shared_from_this(), _1, _2, _3), m_timeout_ms);
     }
@@ -865,11 +1378,11 @@ public:
         req->addHeader(http::header::Content_Type, "application/json");
         req->addHeader("Auth-DeviceID", device->id);
         req->addHeader("Auth-DeviceKey", device->key);
-        req->setContent(json::json2str(jbody));
+        setJsonContent(req, jbody);
         req->setVersion(m_http_major, m_http_minor);
 
-        HIVELOG_DEBUG(m_log, "notification:\n" << json::json2hstr(jbody));
-        m_http->send(req, boost::bind(&ThisType::onSendNotification,
+        HIVELOG_DEBUG(m_log, "notification:\n" << json::HumanFriendly(jbody));
+        m_http->sendPipelined(req, boost::bind(&ThisType::onSendNotification,
             shared_from_this(), _1, _2, _3), m_timeout_ms);
     }
 
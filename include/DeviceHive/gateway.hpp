@@ -912,7 +912,7 @@ public:
             for (; i != e; ++i)
             {
                 const Layout::Element::SharedPtr elem = *i;
-                jval[elem->name] = bin2json(bs, elem);
+                bin2json(bs, elem).swap(jval[elem->name]);
             }
 
             return jval;
@@ -979,8 +979,9 @@ public:
                 {
                     json::Value jarr(json::Value::TYPE_ARRAY);
                     const UInt32 N = bs.getUInt16();
+                    jarr.reserve(N);
                     for (size_t i = 0; i < N; ++i)
-                        jarr.append(bin2json(bs, layoutElement->sublayout));
+                        bin2json(bs, layoutElement->sublayout).swap(jarr.append());
                     return jarr;
                 } break;
 
@@ -1060,9 +1061,18 @@ public:
                 case DT_STRING:
                 case DT_BINARY:
                 {
-                    String buf = jval.asString();
-                    bs.putUInt16(buf.size());
-                    bs.putBuffer(buf.data(), buf.size());
+                    if (jval.isString()) // no copy
+                    {
+                        const json::StringRef buf = jval.asStringRef();
+                        bs.putUInt16(buf.size());
+                        bs.putBuffer(buf.data(), buf.size());
+                    }
+                    else
+                    {
+                        const String buf = jval.asString();
+                        bs.putUInt16(buf.size());
+                        bs.putBuffer(buf.data(), buf.size());
+                    }
                 } break;
 
                 case DT_ARRAY:
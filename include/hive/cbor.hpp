@@ -0,0 +1,708 @@
+/** @file
+@brief The CBOR encoding of JSON values.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+See also RFC-7049 http://tools.ietf.org/html/rfc7049
+
+@see @ref page_hive_cbor
+*/
+#ifndef __HIVE_CBOR_HPP_
+#define __HIVE_CBOR_HPP_
+
+#include "json.hpp"
+
+#if !defined(HIVE_PCH)
+#   include <math.h>
+#   include <string.h>
+#   include <limits>
+#endif // HIVE_PCH
+
+namespace hive
+{
+    /// @brief The CBOR module.
+    /**
+    This namespace contains the binary encoder and decoder of JSON values.
+    */
+    namespace cbor
+    {
+
+/// @brief The CBOR major types.
+enum MajorType
+{
+    MAJOR_UINT     = 0, ///< @brief The unsigned integer.
+    MAJOR_NINT     = 1, ///< @brief The negative integer.
+    MAJOR_BYTES    = 2, ///< @brief The byte string.
+    MAJOR_TEXT     = 3, ///< @brief The text string.
+    MAJOR_ARRAY    = 4, ///< @brief The array.
+    MAJOR_MAP      = 5, ///< @brief The map.
+    MAJOR_TAG      = 6, ///< @brief The tagged item.
+    MAJOR_SIMPLE   = 7  ///< @brief The simple value or floating-point.
+};
+
+
+/// @brief The CBOR formatter.
+/**
+This class writes JSON values in the CBOR binary format.
+The JSON type model is mapped as follows:
+    - NULL is written as `null` simple value
+    - boolean is written as `false` or `true` simple value
+    - integer is written as unsigned or negative integer
+    - floating-point is written as single precision value if it's exact,
+      double precision otherwise
+    - string is written as text string if it's valid UTF-8,
+      byte string otherwise
+    - array is written as definite-length array
+    - object is written as definite-length map with string keys
+
+So Parser restores exactly the same JSON value.
+The output type should provide `put(char)` and `write(const char*, size_t)`
+methods like `std::ostream` and json::OutputBuffer do.
+*/
+class Formatter
+{
+public:
+
+    /// @brief Write the JSON value to the output.
+    /**
+    @param[in,out] out The output stream or json::OutputBuffer.
+    @param[in] jval The JSON value.
+    @return The output.
+    */
+    template<typename OutT>
+    static OutT& write(OutT &out, json::Value const& jval)
+    {
+        writeValue(out, jval);
+        return out;
+    }
+
+
+    /// @brief Append the JSON value to the string.
+    /**
+    @param[in,out] str The output string.
+    @param[in] jval The JSON value.
+    @return The output string.
+    */
+    static String& write(String &str, json::Value const& jval)
+    {
+        StringOutput out(str);
+        writeValue(out, jval);
+        return str;
+    }
+
+public:
+
+    /// @brief Write the data item head.
+    /**
+    The shortest form of argument is used.
+
+    @param[in,out] out The output.
+    @param[in] major The major type.
+    @param[in] arg The argument: integer value, length or number of items.
+    */
+    template<typename OutT>
+    static void writeHead(OutT &out, MajorType major, UInt64 arg)
+    {
+        const int mt = int(major) << 5;
+        if (arg < 24)
+            out.put(char(mt | int(arg)));
+        else if (arg <= 0xFF)
+        {
+            const char buf[2] = { char(mt | 24), char(arg) };
+            out.write(buf, 2);
+        }
+        else if (arg <= 0xFFFF)
+            writeBE(out, char(mt | 25), arg, 2);
+        else if (arg <= UInt64(0xFFFFFFFF))
+            writeBE(out, char(mt | 26), arg, 4);
+        else
+            writeBE(out, char(mt | 27), arg, 8);
+    }
+
+private:
+
+    /// @brief Write the JSON value.
+    /**
+    @param[in,out] out The output.
+    @param[in] jval The JSON value.
+    */
+    template<typename OutT>
+    static void writeValue(OutT &out, json::Value const& jval)
+    {
+        switch (jval.getType())
+        {
+            case json::Value::TYPE_NULL:
+                out.put(char(0xF6));
+                break;
+
+            case json::Value::TYPE_BOOLEAN:
+                out.put(char(jval.asBool() ? 0xF5 : 0xF4));
+                break;
+
+            case json::Value::TYPE_INTEGER:
+                if (jval.isUInteger())
+                    writeHead(out, MAJOR_UINT, jval.asUInt());
+                else
+                {
+                    const Int64 val = jval.asInt();
+                    if (val < 0)
+                        writeHead(out, MAJOR_NINT, UInt64(-1 - val));
+                    else
+                        writeHead(out, MAJOR_UINT, UInt64(val));
+                }
+                break;
+
+            case json::Value::TYPE_DOUBLE:
+            {
+                const double val = jval.asDouble();
+                if (isFloat(val))
+                {
+                    const float fval = float(val);
+                    UInt32 bits = 0;
+                    memcpy(&bits, &fval, sizeof(bits));
+                    writeBE(out, char(0xFA), bits, 4);
+                }
+                else
+                {
+                    UInt64 bits = 0;
+                    memcpy(&bits, &val, sizeof(bits));
+                    writeBE(out, char(0xFB), bits, 8);
+                }
+            } break;
+
+            case json::Value::TYPE_STRING:
+                writeString(out, jval.asStringRef());
+                break;
+
+            case json::Value::TYPE_ARRAY:
+            {
+                const size_t N = jval.size();
+                writeHead(out, MAJOR_ARRAY, N);
+                for (size_t i = 0; i < N; ++i)
+                    writeValue(out, jval[i]);
+            } break;
+
+            case json::Value::TYPE_OBJECT:
+            {
+                writeHead(out, MAJOR_MAP, jval.size());
+                json::Value::MemberIterator i = jval.membersBegin();
+                const json::Value::MemberIterator e = jval.membersEnd();
+                for (; i != e; ++i)
+                {
+                    writeString(out, i->first);
+                    writeValue(out, i->second);
+                }
+            } break;
+        }
+    }
+
+
+    /// @brief Write the string.
+    /**
+    The valid UTF-8 string is written as text string,
+    any other (binary) string is written as byte string.
+
+    @param[in,out] out The output.
+    @param[in] str The string.
+    */
+    template<typename OutT>
+    static void writeString(OutT &out, json::StringRef const& str)
+    {
+        writeHead(out, isUtf8(str) ? MAJOR_TEXT : MAJOR_BYTES, str.size());
+        out.write(str.data(), str.size());
+    }
+
+
+    /// @brief Check the string is valid UTF-8.
+    /**
+    @param[in] str The string.
+    @return `true` if all the sequences are valid and complete.
+    */
+    static bool isUtf8(json::StringRef const& str)
+    {
+        const char *p = str.data();
+        const char *const e = p + str.size();
+        while (p != e)
+        {
+            const int len = misc::utf8_check(p, e);
+            if (len <= 0)
+                return false; // invalid or incomplete
+            p += len;
+        }
+
+        return true;
+    }
+
+
+    /// @brief Check the double value is exact single precision.
+    /**
+    The range is checked first since the narrowing
+    of out of range values is undefined behaviour.
+
+    @param[in] val The value to check.
+    @return `true` if the value could be written as `float` without loss.
+    */
+    static bool isFloat(double val)
+    {
+        if (!(fabs(val) <= std::numeric_limits<float>::max()))
+            return false; // out of range, infinity or NaN
+
+        return double(float(val)) == val;
+    }
+
+
+    /// @brief Write the initial byte and big-endian argument.
+    /**
+    @param[in,out] out The output.
+    @param[in] ib The initial byte.
+    @param[in] arg The argument.
+    @param[in] len The argument length in bytes: 2, 4 or 8.
+    */
+    template<typename OutT>
+    static void writeBE(OutT &out, char ib, UInt64 arg, size_t len)
+    {
+        char buf[9];
+        buf[0] = ib;
+        for (size_t i = len; 0 < i; --i, arg >>= 8)
+            buf[i] = char(arg & 0xFF);
+        out.write(buf, len+1);
+    }
+
+private:
+
+    /// @brief The string output.
+    /**
+    Appends all data to the string.
+    */
+    class StringOutput
+    {
+    public:
+
+        /// @brief The main constructor.
+        /**
+        @param[in,out] str The output string.
+        */
+        explicit StringOutput(String &str)
+            : m_str(str)
+        {}
+
+        /// @brief Append one byte.
+        /**
+        @param[in] ch The byte to append.
+        */
+        void put(char ch)
+        {
+            m_str.push_back(ch);
+        }
+
+        /// @brief Append a few bytes.
+        /**
+        @param[in] data The bytes to append.
+        @param[in] len The number of bytes.
+        */
+        void write(const char *data, size_t len)
+        {
+            m_str.append(data, len);
+        }
+
+    private:
+        String &m_str; ///< @brief The output string.
+    };
+};
+
+
+/// @brief The CBOR parser.
+/**
+This class reads JSON values from the CBOR binary format.
+The JSON events are reported to the handler the same way
+json::Parser does, see json::Handler.
+
+The following CBOR data items are also accepted:
+    - byte strings are reported as strings
+    - indefinite-length strings, arrays and maps
+    - half precision floating-point values
+    - `undefined` simple value is reported as NULL
+    - tags are ignored, only the tagged item is reported
+
+The map keys should be text strings.
+*/
+class Parser
+{
+public:
+
+    /// @brief The maximum nesting level.
+    /**
+    Deeper documents are rejected to protect the stack.
+    */
+    enum { MAX_DEPTH = 512 };
+
+public:
+
+    /// @brief Parse the JSON value from the memory buffer.
+    /**
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[out] jval The parsed JSON value.
+    @return The end of parsed data.
+    @throw json::error::SyntaxError in case of parsing error.
+    */
+    static const char* parse(const char *first, const char *last, json::Value &jval)
+    {
+        json::ValueBuilder builder(jval);
+        return parse(first, last, builder);
+    }
+
+
+    /// @brief Parse the JSON value from the memory buffer using arena.
+    /**
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[out] jval The parsed JSON value.
+    @param[in] arena The arena to allocate from.
+    @return The end of parsed data.
+    @throw json::error::SyntaxError in case of parsing error.
+    */
+    static const char* parse(const char *first, const char *last, json::Value &jval, json::Arena &arena)
+    {
+        json::ValueBuilder builder(jval, &arena);
+        return parse(first, last, builder);
+    }
+
+
+    /// @brief Parse the JSON events from the memory buffer.
+    /**
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[in,out] handler The events handler.
+    @return The end of parsed data.
+    @throw json::error::SyntaxError in case of parsing error.
+    */
+    template<typename HandlerT>
+    static const char* parse(const char *first, const char *last, HandlerT &handler)
+    {
+        String buf; // shared by all strings
+        return parseEvents(first, last, handler, buf, 0);
+    }
+
+private:
+
+    /// @brief The "indefinite length" argument.
+    static UInt64 indefinite()
+    {
+        return ~UInt64(0);
+    }
+
+
+    /// @brief Parse the data item head.
+    /**
+    @param[in,out] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[out] major The major type.
+    @param[out] info The additional information.
+    @param[out] arg The argument or indefinite().
+    @throw json::error::SyntaxError in case of parsing error.
+    */
+    static void parseHead(const char* &first, const char *last, int &major, int &info, UInt64 &arg)
+    {
+        if (first == last)
+            throw json::error::SyntaxError("no CBOR data item");
+
+        const int ib = UInt8(*first++);
+        major = ib >> 5;
+        info = ib & 0x1F;
+
+        if (info < 24)
+            arg = info;
+        else if (info < 28)
+        {
+            const size_t len = size_t(1) << (info - 24);
+            if (size_t(last - first) < len)
+                throw json::error::SyntaxError("not enough CBOR data");
+
+            arg = 0;
+            for (size_t i = 0; i < len; ++i)
+                arg = (arg << 8) | UInt8(*first++);
+        }
+        else if (31 == info && MAJOR_UINT != major
+            && MAJOR_NINT != major && MAJOR_TAG != major)
+        {
+            arg = indefinite();
+        }
+        else
+            throw json::error::SyntaxError("invalid CBOR additional information");
+    }
+
+
+    /// @brief Is the next byte the "break" stop code?
+    /**
+    The "break" stop code is skipped.
+
+    @param[in,out] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @return `true` if the "break" stop code found.
+    @throw json::error::SyntaxError if no more data.
+    */
+    static bool parseBreak(const char* &first, const char *last)
+    {
+        if (first == last)
+            throw json::error::SyntaxError("no CBOR break");
+        if (char(0xFF) != *first)
+            return false;
+
+        ++first;
+        return true;
+    }
+
+
+    /// @brief Parse the string content.
+    /**
+    The indefinite-length string chunks are concatenated.
+
+    @param[in,out] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[in] major The string major type.
+    @param[in] arg The string length or indefinite().
+    @param[out] buf The string.
+    @throw json::error::SyntaxError in case of parsing error.
+    */
+    static void parseString(const char* &first, const char *last, int major, UInt64 arg, String &buf)
+    {
+        if (indefinite() != arg)
+        {
+            if (UInt64(last - first) < arg)
+                throw json::error::SyntaxError("not enough CBOR data");
+            buf.assign(first, size_t(arg));
+            first += size_t(arg);
+            return;
+        }
+
+        buf.clear();
+        while (!parseBreak(first, last))
+        {
+            int chunkMajor = 0, info = 0;
+            UInt64 len = 0;
+            parseHead(first, last, chunkMajor, info, len);
+            if (chunkMajor != major || indefinite() == len)
+                throw json::error::SyntaxError("invalid CBOR string chunk");
+            if (UInt64(last - first) < len)
+                throw json::error::SyntaxError("not enough CBOR data");
+            buf.append(first, size_t(len));
+            first += size_t(len);
+        }
+    }
+
+
+    /// @brief Convert half precision floating-point value.
+    /**
+    @param[in] half The half precision value bits.
+    @return The floating-point value.
+    */
+    static double halfToDouble(UInt32 half)
+    {
+        const int exp = (half >> 10) & 0x1F;
+        const int mant = half & 0x3FF;
+
+        double val;
+        if (0 == exp)
+            val = ldexp(double(mant), -24);
+        else if (31 != exp)
+            val = ldexp(double(mant + 1024), exp - 25);
+        else
+            val = mant ? std::numeric_limits<double>::quiet_NaN()
+                       : std::numeric_limits<double>::infinity();
+
+        return (half & 0x8000) ? -val : val;
+    }
+
+
+    /// @brief Parse the JSON events from the memory buffer.
+    /**
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[in,out] handler The events handler.
+    @param[in,out] buf The auxiliary string buffer.
+    @param[in] depth The current nesting level.
+    @return The end of parsed data.
+    @throw json::error::SyntaxError in case of parsing error.
+    */
+    template<typename HandlerT>
+    static const char* parseEvents(const char *first, const char *last, HandlerT &handler, String &buf, size_t depth)
+    {
+        int major = 0, info = 0;
+        UInt64 arg = 0;
+        parseHead(first, last, major, info, arg);
+
+        while (MAJOR_TAG == major) // ignore tags
+            parseHead(first, last, major, info, arg);
+
+        switch (major)
+        {
+            case MAJOR_UINT:
+                if (arg <= UInt64(std::numeric_limits<Int64>::max()))
+                    handler.onInteger(Int64(arg));
+                else
+                    handler.onUInteger(arg);
+                break;
+
+            case MAJOR_NINT:
+                if (arg <= UInt64(std::numeric_limits<Int64>::max()))
+                    handler.onInteger(-1 - Int64(arg));
+                else
+                    throw json::error::SyntaxError("CBOR integer overflow");
+                break;
+
+            case MAJOR_BYTES:
+            case MAJOR_TEXT:
+                parseString(first, last, major, arg, buf);
+                handler.onString(buf);
+                break;
+
+            case MAJOR_ARRAY:
+            {
+                if (MAX_DEPTH <= depth)
+                    throw json::error::SyntaxError("CBOR nesting is too deep");
+
+                handler.onArrayBegin();
+                if (indefinite() != arg)
+                {
+                    for (UInt64 i = 0; i < arg; ++i)
+                        first = parseEvents(first, last, handler, buf, depth+1);
+                }
+                else
+                {
+                    while (!parseBreak(first, last))
+                        first = parseEvents(first, last, handler, buf, depth+1);
+                }
+                handler.onArrayEnd();
+            } break;
+
+            case MAJOR_MAP:
+            {
+                if (MAX_DEPTH <= depth)
+                    throw json::error::SyntaxError("CBOR nesting is too deep");
+
+                handler.onObjectBegin();
+                for (UInt64 i = 0; indefinite() != arg ? i < arg
+                    : !parseBreak(first, last); ++i)
+                {
+                    int keyMajor = 0;
+                    UInt64 len = 0;
+                    parseHead(first, last, keyMajor, info, len);
+                    if (MAJOR_TEXT != keyMajor && MAJOR_BYTES != keyMajor)
+                        throw json::error::SyntaxError("CBOR map key is not a string");
+
+                    parseString(first, last, keyMajor, len, buf);
+                    handler.onMemberName(buf);
+                    first = parseEvents(first, last, handler, buf, depth+1);
+                }
+                handler.onObjectEnd();
+            } break;
+
+            case MAJOR_SIMPLE:
+                switch (info)
+                {
+                    case 20: handler.onBoolean(false); break;
+                    case 21: handler.onBoolean(true); break;
+                    case 22: // null
+                    case 23: // undefined
+                        handler.onNull();
+                        break;
+
+                    case 25:
+                        handler.onDouble(halfToDouble(UInt32(arg)));
+                        break;
+
+                    case 26:
+                    {
+                        const UInt32 bits = UInt32(arg);
+                        float val = 0.0f;
+                        memcpy(&val, &bits, sizeof(val));
+                        handler.onDouble(val);
+                    } break;
+
+                    case 27:
+                    {
+                        double val = 0.0;
+                        memcpy(&val, &arg, sizeof(val));
+                        handler.onDouble(val);
+                    } break;
+
+                    case 31:
+                        throw json::error::SyntaxError("unexpected CBOR break");
+
+                    default:
+                        throw json::error::SyntaxError("unsupported CBOR simple value");
+                }
+                break;
+        }
+
+        return first;
+    }
+};
+
+
+/// @brief Convert JSON value to CBOR data.
+/**
+@param[in] jval The JSON value.
+@return The CBOR data.
+*/
+inline String json2cbor(json::Value const& jval)
+{
+    String data;
+    Formatter::write(data, jval);
+    return data;
+}
+
+
+/// @brief Convert CBOR data to JSON value.
+/**
+@param[in] data The CBOR data.
+@param[in] len The CBOR data length in bytes.
+@return The parsed JSON value.
+@throw json::error::SyntaxError in case of parsing error.
+*/
+inline json::Value cbor2json(const char *data, size_t len)
+{
+    const char *last = data + len;
+
+    json::Value jval;
+    if (Parser::parse(data, last, jval) != last) // check is 'data' fully parsed
+        throw json::error::SyntaxError("partially parsed");
+    return jval;
+}
+
+
+/// @brief Convert CBOR data to JSON value.
+/**
+@param[in] data The CBOR data.
+@return The parsed JSON value.
+@throw json::error::SyntaxError in case of parsing error.
+*/
+inline json::Value cbor2json(String const& data)
+{
+    return cbor2json(data.data(), data.size());
+}
+
+    } // cbor namespace
+} // hive namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+/** @page page_hive_cbor CBOR module
+
+This module provides compact binary encoding of JSON values,
+see RFC-7049 http://tools.ietf.org/html/rfc7049
+
+The hive::cbor::Formatter and hive::cbor::Parser use the same
+type model and the same events handlers as JSON text formatter
+and parser do, so any JSON value is restored exactly:
+
+~~~{.cpp}
+String data = cbor::json2cbor(jval);
+assert(cbor::cbor2json(data) == jval);
+~~~
+
+The CBOR data is usually smaller and much faster to parse than JSON text.
+It's suitable for local persistence and inter-process communication.
+*/
+
+#endif // __HIVE_CBOR_HPP_
@@ -86,8 +86,9 @@ typedef boost::noncopyable NonCopyable;
 #if !defined(HIVE_HAS_RVALUE_REFS) // auto detection
 #   if defined(_MSC_VER) && 1600 <= _MSC_VER
 #       define HIVE_HAS_RVALUE_REFS
+#   elif defined(__GXX_EXPERIMENTAL_CXX0X__) || (defined(__cplusplus) && 201103L <= __cplusplus)
+#       define HIVE_HAS_RVALUE_REFS // gcc/clang in C++11 mode
 #   endif // _MSC_VER
-    // TODO: detect HIVE_HAS_RVALUE_REFS on gcc
 #endif // !defined(HIVE_HAS_RVALUE_REFS)
 #if defined(HIVE_DOXY_MODE)
 #undef HIVE_HAS_RVALUE_REFS
@@ -102,6 +103,27 @@ the execution speed for some data type by eliminating copying.
 #endif // defined(HIVE_DOXY_MODE)
 
 
+// HIVE_NOEXCEPT
+#if !defined(HIVE_NOEXCEPT) // auto detection
+#   if (defined(_MSC_VER) && 1900 <= _MSC_VER) || (defined(__cplusplus) && 201103L <= __cplusplus)
+#       define HIVE_NOEXCEPT noexcept
+#   else
+#       define HIVE_NOEXCEPT throw()
+#   endif
+#endif // !defined(HIVE_NOEXCEPT)
+#if defined(HIVE_DOXY_MODE)
+#undef HIVE_NOEXCEPT
+
+/// @hideinitializer @brief The "no exceptions" specification.
+/**
+Expands to `noexcept` on modern compilers and to `throw()` otherwise.
+The standard containers move (instead of copy) elements on growth
+only if the move constructor is declared with `noexcept`.
+*/
+#define HIVE_NOEXCEPT
+#endif // defined(HIVE_DOXY_MODE)
+
+
 ///////////////////////////////////////////////////////////////////////////////
 /** @page page_hive_defs Common definitions
 
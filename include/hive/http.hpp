@@ -20,7 +20,10 @@ Some implementation parts is based on urdl library by Christopher M. Kohlhoff.
 #   include <boost/shared_ptr.hpp>
 #   include <boost/asio.hpp>
 #   include <boost/bind.hpp>
+#   include <vector>
+#   include <deque>
 #   include <map>
+#   include <algorithm>
 #endif // HIVE_PCH
 
 #if !defined(HIVE_DISABLE_SSL)
@@ -68,6 +71,36 @@ const char CRLF[] = "\r\n";
 /// @hideinitializer @brief The empty line and new line string.
 const char CRLFx2[] = "\r\n\r\n";
 
+
+/// @brief Check the idle socket is closed by the peer.
+/**
+The socket is peeked without blocking: the end of stream or an error
+means the peer has closed (or reset) the connection. The pending data
+(for example TLS session tickets) is left in the socket.
+
+@param[in] socket The idle socket.
+@return `true` if the connection is closed.
+*/
+inline bool is_closed(boost::asio::ip::tcp::socket &socket)
+{
+    if (!socket.is_open())
+        return true;
+
+    boost::system::error_code err;
+    const bool nonBlocking = socket.non_blocking();
+    socket.non_blocking(true, err);
+    if (err)
+        return true;
+
+    char ch = 0;
+    socket.receive(boost::asio::buffer(&ch, 1),
+        boost::asio::socket_base::message_peek, err);
+
+    boost::system::error_code ignored;
+    socket.non_blocking(nonBlocking, ignored);
+    return err && boost::asio::error::would_block != err;
+}
+
         } // helpers
 
 
@@ -779,6 +812,7 @@ const char Content_Length[]   = "Content-Length";   ///< @hideinitializer @brief
 const char Content_Type[]     = "Content-Type";     ///< @hideinitializer @brief The "Content-Type" header name.
 const char Expires[]          = "Expires";          ///< @hideinitializer @brief The "Expires" header name.
 const char Last_Modified[]    = "Last-Modified";    ///< @hideinitializer @brief The "Last-Modified" header name.
+const char Transfer_Encoding[] = "Transfer-Encoding"; ///< @hideinitializer @brief The "Transfer-Encoding" header name.
 const char User_Agent[]       = "User-Agent";       ///< @hideinitializer @brief The "User-Agent" header name.
 const char Location[]         = "Location";         ///< @hideinitializer @brief The "Location" header name.
 
@@ -792,7 +826,8 @@ const char Location[]         = "Location";         ///< @hideinitializer @brief
 This is base class for HTTP requests and responses.
 Contains HTTP version, list of HTTP headers, and the body content.
 The HTTP version may be changed using setVersion() method.
-The body content stored as string using setContent() method.
+The body content stored as string using setContent() method
+or as a list of buffers using setContentBuffer() method.
 
 All headers are stored in map:
     - headers are case insensitive
@@ -963,11 +998,25 @@ public:
 
 /// @name Body content
 /// @{
+public:
+
+    /// @brief The list of content buffers.
+    typedef std::vector<boost::asio::const_buffer> ConstBuffers;
+
 private:
 
     /// @brief The custom content.
     String m_content;
 
+    /// @brief The content buffers.
+    /**
+    Used instead of #m_content if not empty.
+    */
+    ConstBuffers m_contentBuffers;
+
+    /// @brief The content buffers owner.
+    boost::shared_ptr<void const> m_contentHolder;
+
 public:
 
     /// @brief Set content string.
@@ -977,42 +1026,174 @@ public:
     void setContent(String const& content)
     {
         m_content = content;
+        m_contentBuffers.clear();
+        m_contentHolder.reset();
+    }
+
+
+    /// @brief Set content as a list of buffers.
+    /**
+    The content isn't copied: the buffers are sent as is
+    using scatter-gather write. The @a content is held
+    by the message until the content is changed.
+
+    The @a content should provide the following methods:
+    `chunkCount()`, `chunkData(i)` and `chunkSize(i)`,
+    for example hive::json::OutputBuffer.
+
+    @param[in] content The chunked content.
+    */
+    template<typename BufferT>
+    void setContentBuffer(boost::shared_ptr<BufferT> const& content)
+    {
+        ConstBuffers buffers;
+        const size_t N = content->chunkCount();
+        buffers.reserve(N);
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (const size_t len = content->chunkSize(i))
+            {
+                buffers.push_back(boost::asio::const_buffer(
+                    content->chunkData(i), len));
+            }
+        }
+
+        m_content.clear();
+        m_contentBuffers.swap(buffers);
+        m_contentHolder = content;
     }
 
 
     /// @brief Get content string.
+    /**
+    @return The content string or empty string if content buffers are used.
+    */
     String const& getContent() const
     {
         return m_content;
     }
 
 
+    /// @brief Get content buffers.
+    /**
+    @return The content buffers or empty list if content string is used.
+    */
+    ConstBuffers const& getContentBuffers() const
+    {
+        return m_contentBuffers;
+    }
+
+
+    /// @brief Get the content length.
+    /**
+    @return The content length in bytes.
+    */
+    size_t getContentLength() const
+    {
+        return m_contentBuffers.empty() ? m_content.size()
+            : boost::asio::buffer_size(m_contentBuffers);
+    }
+
+
+    /// @brief Check the "chunked" transfer-coding.
+    /**
+    @return `true` if "chunked" is the final coding
+        of the `Transfer-Encoding` header.
+    */
+    bool isChunked() const
+    {
+        const String te = getHeader(header::Transfer_Encoding);
+        const size_t pos = te.find_last_of(',');
+        const String last = te.substr(String::npos != pos ? pos+1 : 0);
+        return boost::iequals(boost::trim_copy(last), "chunked");
+    }
+
+
     /// @brief Write content to the output stream.
     /**
-    The `Content-Length` header will be added automatically if content isn't empty.
+    The `Content-Length` header will be added automatically if content isn't empty
+    and "chunked" transfer-coding isn't used.
+
+    If the message has `Transfer-Encoding: chunked` header the content
+    is written using "chunked" transfer-coding: one chunk per content
+    string or buffer followed by the last chunk. The content buffers
+    are always written in this case.
 
     @param[in,out] os The output stream.
+    @param[in] withBuffers Write the content buffers too.
+        If `false` the content buffers should be sent separately.
     @return The output stream.
     */
-    OStream& writeContent(OStream & os) const
+    OStream& writeContent(OStream & os, bool withBuffers = true) const
     {
-        if (!m_content.empty())
+        if (isChunked())
+        {
+            os << impl::CRLF;
+            writeChunk(os, m_content.data(), m_content.size());
+            for (size_t i = 0; i < m_contentBuffers.size(); ++i)
+            {
+                boost::asio::const_buffer const& buf = m_contentBuffers[i];
+                writeChunk(os, boost::asio::buffer_cast<const char*>(buf),
+                    boost::asio::buffer_size(buf));
+            }
+
+            // the last chunk and empty trailer
+            return os << "0" << impl::CRLF << impl::CRLF;
+        }
+
+        if (const size_t len = getContentLength())
         {
             // add "Content-Length" header
             if (!hasHeader(header::Content_Length))
             {
                 os << header::Content_Length << ": "
-                    << m_content.size() << impl::CRLF;
+                    << len << impl::CRLF;
             }
             os << impl::CRLF;
             os.write(m_content.data(),
                 m_content.size());
+
+            if (withBuffers)
+            {
+                for (size_t i = 0; i < m_contentBuffers.size(); ++i)
+                {
+                    boost::asio::const_buffer const& buf = m_contentBuffers[i];
+                    os.write(boost::asio::buffer_cast<const char*>(buf),
+                        boost::asio::buffer_size(buf));
+                }
+            }
         }
         else
             os << impl::CRLF;
 
         return os;
     }
+
+private:
+
+    /// @brief Write one chunk.
+    /**
+    Empty chunk is ignored since it means the last chunk.
+
+    @param[in,out] os The output stream.
+    @param[in] data The chunk data.
+    @param[in] len The chunk length in bytes.
+    */
+    static void writeChunk(OStream & os, const char *data, size_t len)
+    {
+        if (0 == len)
+            return;
+
+        char hex[2*sizeof(size_t)];
+        char *p = hex + sizeof(hex);
+        for (size_t n = len; 0 < n; n /= 16)
+            *--p = "0123456789ABCDEF"[n%16];
+
+        os.write(p, hex + sizeof(hex) - p);
+        os << impl::CRLF;
+        os.write(data, len);
+        os << impl::CRLF;
+    }
 /// @}
 };
 
@@ -1156,12 +1337,15 @@ public:
 
     The `Host` header will be added automatically if it's not provided.
 
-    The `Content-Length` header will be added automatically if content isn't empty.
+    The `Content-Length` header will be added automatically if content isn't empty
+    and "chunked" transfer-coding isn't used.
 
     @param[in,out] os The output stream.
+    @param[in] withBuffers Write the content buffers too.
+        If `false` the content buffers should be sent separately.
     @return The output stream.
     */
-    OStream& write(OStream & os) const
+    OStream& write(OStream & os, bool withBuffers = true) const
     {
         writeFirstLine(os);
         writeAllHeaders(os);
@@ -1173,7 +1357,7 @@ public:
                 << impl::CRLF;
         }
 
-        writeContent(os);
+        writeContent(os, withBuffers);
         return os;
     }
 
@@ -1371,7 +1555,8 @@ public:
     /**
     This method writes the first line, HTTP headers and content if present.
 
-    The `Content-Length` header will be added automatically if content isn't empty.
+    The `Content-Length` header will be added automatically if content isn't empty
+    and "chunked" transfer-coding isn't used.
 
     @param[in,out] os The output stream.
     @return The output stream.
@@ -1399,6 +1584,183 @@ inline OStream& operator<<(OStream &os, Response const& res)
 }
 
 
+/// @brief The "chunked" transfer-coding decoder.
+/**
+Extracts the content data from the "chunked" message body.
+The input might be split at any position, the decoder keeps
+its state between decode() calls. The chunk extensions and
+the trailer headers are ignored.
+
+~~~{.cpp}
+ChunkedDecoder dec;
+size_t n = dec.decode(data, len, handler); // n bytes are processed
+if (dec.isFailed()) ...; // bad format
+if (dec.isDone()) ...; // the last chunk is received
+~~~
+*/
+class ChunkedDecoder
+{
+public:
+
+    /// @brief The default constructor.
+    ChunkedDecoder()
+    {
+        reset();
+    }
+
+
+    /// @brief Reset the decoder state.
+    void reset()
+    {
+        m_state = STATE_SIZE;
+        m_size = 0;
+        m_digits = 0;
+    }
+
+
+    /// @brief Is the last chunk received?
+    bool isDone() const
+    {
+        return STATE_DONE == m_state;
+    }
+
+
+    /// @brief Is the input invalid?
+    bool isFailed() const
+    {
+        return STATE_FAILED == m_state;
+    }
+
+
+    /// @brief Decode the next part of the input.
+    /**
+    The @a handler is called for each part of content data
+    with `(const char *data, size_t len)` arguments.
+
+    The decoder stops at the end of message,
+    the rest of input isn't processed.
+
+    @param[in] data The input data.
+    @param[in] len The input length in bytes.
+    @param[in] handler The content handler.
+    @return The number of input bytes processed.
+    */
+    template<typename Handler>
+    size_t decode(const char *data, size_t len, Handler const& handler)
+    {
+        const char *p = data;
+        const char *const e = data + len;
+
+        while (p != e && !isDone() && !isFailed())
+        {
+            if (STATE_DATA == m_state)
+            {
+                const size_t n = std::min(m_size,
+                    static_cast<size_t>(e - p));
+                handler(p, n);
+                p += n;
+                if (0 == (m_size -= n))
+                    m_state = STATE_DATA_END;
+                continue;
+            }
+
+            const int ch = *p++;
+            switch (m_state)
+            {
+                case STATE_SIZE:
+                {
+                    const int x = hex(ch);
+                    if (0 <= x && m_size <= (std::numeric_limits<size_t>::max() >> 4))
+                    {
+                        m_size = (m_size << 4) | x;
+                        m_digits += 1;
+                    }
+                    else if (0 <= x || 0 == m_digits)
+                        m_state = STATE_FAILED; // too big or no size
+                    else if ('\n' == ch)
+                        onSizeLine();
+                    else if (';' == ch || ' ' == ch || '\t' == ch || '\r' == ch)
+                        m_state = STATE_SIZE_EXT;
+                    else
+                        m_state = STATE_FAILED;
+                } break;
+
+                case STATE_SIZE_EXT:
+                    if ('\n' == ch)
+                        onSizeLine();
+                    break;
+
+                case STATE_DATA_END:
+                    if ('\n' == ch)
+                        m_state = STATE_SIZE;
+                    else if ('\r' != ch)
+                        m_state = STATE_FAILED;
+                    break;
+
+                case STATE_TRAILER:
+                    if ('\n' == ch)
+                        m_state = STATE_DONE; // empty line
+                    else if ('\r' != ch)
+                        m_state = STATE_TRAILER_LINE;
+                    break;
+
+                case STATE_TRAILER_LINE:
+                    if ('\n' == ch)
+                        m_state = STATE_TRAILER;
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        return p - data;
+    }
+
+private:
+
+    /// @brief The chunk size line is parsed.
+    void onSizeLine()
+    {
+        m_state = m_size ? STATE_DATA : STATE_TRAILER;
+        m_digits = 0;
+    }
+
+
+    /// @brief Convert hexadecimal digit.
+    /**
+    @param[in] ch The input character.
+    @return The digit value or `-1`.
+    */
+    static int hex(int ch)
+    {
+        if ('0' <= ch && ch <= '9') return ch - '0';
+        if ('a' <= ch && ch <= 'f') return ch - 'a' + 10;
+        if ('A' <= ch && ch <= 'F') return ch - 'A' + 10;
+        return -1;
+    }
+
+private:
+
+    /// @brief The decoder state.
+    enum State
+    {
+        STATE_SIZE,         ///< @brief The chunk size.
+        STATE_SIZE_EXT,     ///< @brief The chunk extensions.
+        STATE_DATA,         ///< @brief The chunk data.
+        STATE_DATA_END,     ///< @brief The CRLF after chunk data.
+        STATE_TRAILER,      ///< @brief The trailer line start.
+        STATE_TRAILER_LINE, ///< @brief The trailer header.
+        STATE_DONE,         ///< @brief The last chunk is received.
+        STATE_FAILED        ///< @brief The bad input.
+    };
+
+    State m_state;   ///< @brief The current state.
+    size_t m_size;   ///< @brief The chunk size or remaining chunk data.
+    size_t m_digits; ///< @brief The number of chunk size digits.
+};
+
+
 /// @brief The base connection.
 /**
 This class represents one connection to the server.
@@ -1418,6 +1780,7 @@ public:
     typedef boost::system::error_code ErrorCode; ///< @brief The error code type.
     typedef boost::asio::ip::tcp::resolver Resolver; ///< @brief The resolver type.
     typedef boost::asio::streambuf StreamBuf; ///< @brief The stream buffer type.
+    typedef Message::ConstBuffers ConstBuffers; ///< @brief The list of buffers type.
 
 public:
 
@@ -1499,6 +1862,17 @@ public:
     */
     virtual void asyncWriteAll(StreamBuf &sbuf, WriteCallback callback) = 0;
 
+
+    /// @brief Start asynchronous "write" operation (scatter-gather).
+    /**
+    The buffers are sent without copying, so the data
+    should be valid until the callback is called.
+
+    @param[in] buffers The list of buffers to send.
+    @param[in] callback The callback functor.
+    */
+    virtual void asyncWriteAll(ConstBuffers const& buffers, WriteCallback callback) = 0;
+
 public:
 
     /// @brief The "read" operation callback.
@@ -1528,6 +1902,15 @@ public:
         Cancels all asynchronous operations.
     */
     virtual void close() = 0;
+
+
+    /// @brief Is the idle connection closed by the peer?
+    /**
+    Should be called only if there are no pending operations.
+
+    @return `true` if the connection cannot be used anymore.
+    */
+    virtual bool isClosed() = 0;
 };
 
 
@@ -1618,6 +2001,15 @@ public:
                 boost::asio::placeholders::bytes_transferred));
     }
 
+
+    /// @copydoc Connection::asyncWriteAll(ConstBuffers const&, WriteCallback)
+    virtual void asyncWriteAll(ConstBuffers const& buffers, WriteCallback callback)
+    {
+        boost::asio::async_write(getSocket(), buffers,
+            boost::bind(callback, boost::asio::placeholders::error,
+                boost::asio::placeholders::bytes_transferred));
+    }
+
 public:
 
     /// @copydoc Connection::asyncReadUntil()
@@ -1651,6 +2043,13 @@ public:
         m_socket.close(terr);
         // ignore error code?
     }
+
+
+    /// @copydoc Connection::isClosed()
+    virtual bool isClosed()
+    {
+        return impl::is_closed(m_socket);
+    }
 };
 
 
@@ -1713,6 +2112,63 @@ public:
         return m_stream;
     }
 
+public:
+
+    /// @brief The TLS session type.
+    typedef boost::shared_ptr<SSL_SESSION> Session;
+
+
+    /// @brief Set the TLS session to resume.
+    /**
+    Should be called before handshake. If the server doesn't accept
+    the session, the full handshake is performed.
+
+    @param[in] session The TLS session of the previous connection.
+    */
+    void setSession(Session const& session)
+    {
+        if (session)
+            SSL_set_session(getStream().native_handle(), session.get());
+    }
+
+
+    /// @brief Get the resumable TLS session.
+    /**
+    With TLS 1.3 the session ticket is received after handshake,
+    so this method should be called once some data is received.
+
+    The copy of session is returned, because OpenSSL marks the session
+    as not resumable if connection is closed without SSL shutdown.
+
+    @return The TLS session or NULL if session cannot be resumed.
+    */
+    Session getSession()
+    {
+        SSL_SESSION *session = SSL_get_session(getStream().native_handle());
+        if (!session)
+            return Session();
+
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+        if (!SSL_SESSION_is_resumable(session))
+            return Session();
+        session = SSL_SESSION_dup(session);
+#else
+        session = SSL_get1_session(getStream().native_handle());
+#endif // OPENSSL_VERSION_NUMBER
+
+        return session ? Session(session, SSL_SESSION_free) : Session();
+    }
+
+
+    /// @brief Is the TLS session resumed?
+    /**
+    @return `true` if the abbreviated handshake was performed.
+    */
+    bool isSessionReused()
+    {
+        return 0 != SSL_session_reused(getStream().native_handle());
+    }
+
 public:
 
     /// @copydoc Connection::asyncConnect()
@@ -1743,6 +2199,15 @@ public:
                 boost::asio::placeholders::bytes_transferred));
     }
 
+
+    /// @copydoc Connection::asyncWriteAll(ConstBuffers const&, WriteCallback)
+    virtual void asyncWriteAll(ConstBuffers const& buffers, WriteCallback callback)
+    {
+        boost::asio::async_write(getStream(), buffers,
+            boost::bind(callback, boost::asio::placeholders::error,
+                boost::asio::placeholders::bytes_transferred));
+    }
+
 public:
 
     /// @copydoc Connection::asyncReadUntil()
@@ -1776,6 +2241,13 @@ public:
         getStream().lowest_layer().close(terr);
         // ignore error code?
     }
+
+
+    /// @copydoc Connection::isClosed()
+    virtual bool isClosed()
+    {
+        return impl::is_closed(getStream().next_layer());
+    }
 };
 
 #endif // HIVE_DISABLE_SSL
@@ -1795,6 +2267,9 @@ To complete request you have to provide the callback object of Callback signatur
 It is possible to specify request's timeout.
 
 All unfinished requests are stored in the internal list and may be cancelled by cancelAll() method.
+
+The connections might be kept alive and reused for the next requests
+to the same host, see setKeepAlive().
 */
 class Client:
     public boost::enable_shared_from_this<Client>,
@@ -1845,6 +2320,17 @@ protected:
         , m_context(boost::asio::ssl::context::sslv23)
 #endif // HIVE_DISABLE_SSL
         , m_log("/hive/http/client/" + name)
+        , m_poolMaxPerHost(0)
+        , m_poolIdleTimeout_ms(0)
+        , m_poolHits(0)
+        , m_poolMisses(0)
+        , m_dnsTtl_ms(0)
+        , m_dnsNegativeTtl_ms(0)
+        , m_dnsResolves(0)
+        , m_tlsResumed(0)
+        , m_tlsFull(0)
+        , m_tlsResumption(false)
+        , m_pipelineDepth(0)
     {
         HIVELOG_TRACE_STR(m_log, "created");
     }
@@ -1889,53 +2375,78 @@ public:
         Request::SharedPtr, Response::SharedPtr> Callback;
 
 
+    /// @brief The content callback type.
+    /**
+    The callback signature should be the following:
+
+    ~~~{.cpp}
+    void cb(const char *data, size_t len)
+    ~~~
+
+    It's called for each received part of response content,
+    so the content might be processed (for example parsed by
+    json::IncrementalParser) while the rest is still being received.
+    The callback should not throw any exceptions.
+    */
+    typedef boost::function2<void, const char*, size_t> ContentCallback;
+
+
     /// @brief Send request asynchronously.
     /**
+    If the content callback is provided, the response content is passed
+    to this callback as it arrives and is not stored in the response object.
+
     @param[in] request The HTTP request to send.
     @param[in] callback The response callback function.
     @param[in] timeout_ms The request timeout, milliseconds.
         If it's zero, no any deadline timers will be started.
+    @param[in] contentCallback The optional content callback function.
     */
-    void send(Request::SharedPtr request, Callback callback, size_t timeout_ms)
+    void send(Request::SharedPtr request, Callback callback, size_t timeout_ms,
+        ContentCallback contentCallback = ContentCallback())
     {
         HIVELOG_TRACE_BLOCK(m_log, "send()");
         assert(request && "no request");
 
         // create new task for the request
         Task::SharedPtr task(new Task(m_ios, request, callback));
-
-        if (0 < timeout_ms)
-        {
-            if (ErrorCode err = asyncStartTimeout(task, timeout_ms))
-            {
-                HIVELOG_ERROR(m_log, "cannot start deadline timer: ["
-                    << err << "] " << err.message());
-                m_ios.post(boost::bind(callback, err,
-                    request, Response::SharedPtr()));
-                return; // no task started
-            }
-
-            HIVELOG_DEBUG(m_log, "{" << task.get() << "} sending "
-                << request->getMethod() << " request to <"
-                << request->getUrl().getHost() << "> with "
-                << timeout_ms << " ms timeout:\n" << *request);
-        }
-        else
-        {
-            HIVELOG_DEBUG(m_log, "{" << task.get() << "} sending "
-                << request->getMethod() << " request to <"
-                << request->getUrl().getHost()
-                << "> without timeout:\n" << *request);
-        }
-
-        m_tasks.push_back(task);
-        asyncResolve(task);
+        task->content_callback = contentCallback;
+        start(task, timeout_ms);
     }
 
 
-    /// @brief Cancel all requests.
+    /// @brief Send request asynchronously (might be pipelined).
     /**
-    All active requests will be finished with `boost::asio::error::operation_aborted` error code.
+    If pipelining is enabled (see setPipelining()) the request
+    might be written to the connection without waiting for responses
+    to the previous pipelined requests to the same host.
+    Otherwise it's the same as send().
+
+    Use this method for short requests like notifications only.
+    The long-polling requests should be sent by send() method,
+    they would block all the following responses.
+
+    @param[in] request The HTTP request to send.
+    @param[in] callback The response callback function.
+    @param[in] timeout_ms The request timeout, milliseconds.
+        If it's zero, no any deadline timers will be started.
+    */
+    void sendPipelined(Request::SharedPtr request, Callback callback, size_t timeout_ms)
+    {
+        HIVELOG_TRACE_BLOCK(m_log, "sendPipelined()");
+        assert(request && "no request");
+
+        // create new task for the request
+        Task::SharedPtr task(new Task(m_ios, request, callback));
+        task->pipelined = true;
+        start(task, timeout_ms);
+    }
+
+
+    /// @brief Cancel all requests.
+    /**
+    All active requests will be finished with `boost::asio::error::operation_aborted` error code.
+    The idle kept-alive connections are closed too.
     */
     void cancelAll()
     {
@@ -1946,9 +2457,177 @@ public:
             done(task, boost::asio::error::operation_aborted);
             task->cancel();
         }
+
+        closeIdle(boost::posix_time::ptime(boost::posix_time::pos_infin));
+    }
+
+public:
+
+    /// @brief Enable or disable persistent connections.
+    /**
+    If enabled, the connection is put into the per-host pool once
+    the response is completely received and the connection may be reused
+    (the content length is known and the server doesn't ask to close).
+    The next request to the same protocol, host and port takes that
+    connection and skips resolve, connect and SSL handshake.
+
+    The "Connection: keep-alive" header is added to the requests
+    without "Connection" header, so HTTP/1.0 servers keep connections too.
+
+    The idle connections closed by the server are detected and dropped
+    before reuse. If the kept-alive connection breaks while the request
+    is being sent, the request is sent again once using a new connection,
+    but only if its method is idempotent or nothing is sent yet: the server
+    might have processed the request (RFC 7230, section 6.3.1).
+
+    The active connections are not limited, because one long-polling
+    request should not block others.
+
+    @param[in] maxPerHost The maximum number of idle connections per host.
+        If it's zero, the persistent connections are disabled (default).
+    @param[in] idleTimeout_ms The idle connection timeout, milliseconds.
+    */
+    void setKeepAlive(size_t maxPerHost, size_t idleTimeout_ms = 30000)
+    {
+        m_poolMaxPerHost = maxPerHost;
+        m_poolIdleTimeout_ms = idleTimeout_ms;
+        if (0 == maxPerHost)
+            closeIdle(boost::posix_time::ptime(boost::posix_time::pos_infin));
+    }
+
+
+    /// @brief Get the number of pool hits.
+    /**
+    @return The number of requests sent using kept-alive connection.
+    */
+    size_t getPoolHits() const
+    {
+        return m_poolHits;
+    }
+
+
+    /// @brief Get the number of pool misses.
+    /**
+    @return The number of requests sent using new connection
+        while persistent connections are enabled.
+    */
+    size_t getPoolMisses() const
+    {
+        return m_poolMisses;
+    }
+
+public:
+
+    /// @brief Enable or disable the DNS cache.
+    /**
+    If enabled, the resolved endpoints are cached by "host:service" key,
+    so the next requests to the same host are not waiting for resolver.
+    The concurrent requests to the same host share one resolve operation.
+    The resolve errors are cached too, but usually for a shorter time.
+
+    The cached endpoints are dropped if connection to them fails.
+
+    @param[in] ttl_ms The resolved endpoints time-to-live, milliseconds.
+        If it's zero, the DNS cache is disabled (default).
+    @param[in] negativeTtl_ms The resolve error time-to-live, milliseconds.
+    */
+    void setDnsCache(size_t ttl_ms, size_t negativeTtl_ms = 5000)
+    {
+        m_dnsTtl_ms = ttl_ms;
+        m_dnsNegativeTtl_ms = negativeTtl_ms;
+
+        // keep pending operations only
+        for (DnsCache::iterator i = m_dnsCache.begin(); i != m_dnsCache.end();)
+        {
+            if (i->second.resolver)
+                ++i;
+            else
+                m_dnsCache.erase(i++);
+        }
+    }
+
+
+    /// @brief Get the number of resolve operations.
+    /**
+    @return The number of resolve operations started,
+        the requests resolved from DNS cache are not counted.
+    */
+    size_t getDnsResolves() const
+    {
+        return m_dnsResolves;
+    }
+
+public:
+
+    /// @brief Enable or disable TLS session resumption.
+    /**
+    If enabled, the TLS session of the last successful HTTPS request
+    is kept per "protocol://host:port" and the next connection
+    to the same server tries to resume it (session ID or session ticket),
+    so the abbreviated handshake is performed.
+
+    @param[in] enabled The TLS session resumption flag, disabled by default.
+    */
+    void setTlsResumption(bool enabled)
+    {
+        m_tlsResumption = enabled;
+#if !defined(HIVE_DISABLE_SSL)
+        if (!enabled)
+            m_tlsSessions.clear();
+#endif // HIVE_DISABLE_SSL
+    }
+
+
+    /// @brief Get the number of resumed TLS handshakes.
+    /**
+    @return The number of abbreviated handshakes.
+    */
+    size_t getTlsResumedHandshakes() const
+    {
+        return m_tlsResumed;
+    }
+
+
+    /// @brief Get the number of full TLS handshakes.
+    /**
+    @return The number of full handshakes.
+    */
+    size_t getTlsFullHandshakes() const
+    {
+        return m_tlsFull;
+    }
+
+public:
+
+    /// @brief Enable or disable HTTP pipelining.
+    /**
+    If enabled, the requests sent by sendPipelined() to the same
+    "protocol://host:port" share one connection: each request is written
+    as soon as the previous one is written, without waiting for response.
+    The responses are received and dispatched in the same order.
+
+    If the connection is broken or closed by the server, the requests
+    not yet written are sent again using new connection. The written but
+    unanswered requests are sent again only if their method is idempotent
+    (GET, HEAD, PUT, DELETE, OPTIONS, TRACE), all others are finished
+    with error, because the server might have processed them.
+
+    The first request on any connection (new or kept-alive, see setKeepAlive())
+    is sent alone. The rest requests are written only once its response
+    shows that the server keeps the connection open (RFC 7230, section 6.3.2),
+    otherwise they are sent using new connections.
+
+    @param[in] depth The maximum number of written but unanswered requests.
+        The rest requests are queued. If it's zero, the pipelining
+        is disabled (default).
+    */
+    void setPipelining(size_t depth)
+    {
+        m_pipelineDepth = depth;
     }
 
 private:
+    struct Pipeline;
 
     /// @brief The one task (request/response).
     /**
@@ -1963,6 +2642,7 @@ private:
         Response::SharedPtr response; ///< @brief The response object.
 
         Callback callback; ///< @brief The callback method.
+        ContentCallback content_callback; ///< @brief The content callback or NULL.
 
         bool timer_started; ///< @brief The timer "started" flag.
         Timer timer;    ///< @brief The deadline timer.
@@ -1971,7 +2651,17 @@ private:
         Connection::SharedPtr connection; ///< @brief The HTTP or HTTPS connection.
 
         bool cancelled; ///< @brief The "cancelled" flag.
+        bool reused; ///< @brief The "kept-alive connection" flag.
+        bool pipelined; ///< @brief The "might be pipelined" flag.
+        bool sent; ///< @brief The "request is sent" flag.
+        size_t retries; ///< @brief The number of pipelined attempts failed.
+        boost::shared_ptr<Pipeline> pipeline; ///< @brief The pipeline or NULL.
+        Connection::StreamBuf tx_buf; ///< @brief The request head buffer.
         size_t rx_len; ///< @brief The expected content-length.
+        size_t rx_done; ///< @brief The content length passed to the content callback or decoded.
+        bool rx_chunked; ///< @brief The "chunked" content flag.
+        ChunkedDecoder rx_decoder; ///< @brief The "chunked" content decoder.
+        String rx_content; ///< @brief The decoded "chunked" content.
 
     public:
 
@@ -1985,7 +2675,9 @@ private:
             : request(req), callback(cb),
               timer_started(false), timer(ios),
               resolver(ios), cancelled(false),
-              rx_len(std::numeric_limits<size_t>::max())
+              reused(false), pipelined(false), sent(false),
+              retries(0), rx_len(std::numeric_limits<size_t>::max()),
+              rx_done(0), rx_chunked(false)
         {}
 
     public:
@@ -2008,20 +2700,94 @@ private:
 
 private:
 
+    /// @brief Start the task.
+    /**
+    @param[in] task The task.
+    @param[in] timeout_ms The request timeout, milliseconds.
+    */
+    void start(Task::SharedPtr task, size_t timeout_ms)
+    {
+        Request::SharedPtr request = task->request;
+        if ((0 < m_poolMaxPerHost || 0 < m_pipelineDepth)
+            && !request->hasHeader(header::Connection))
+                request->addHeader(header::Connection, "keep-alive");
+
+        if (0 < timeout_ms)
+        {
+            if (ErrorCode err = asyncStartTimeout(task, timeout_ms))
+            {
+                HIVELOG_ERROR(m_log, "cannot start deadline timer: ["
+                    << err << "] " << err.message());
+                m_ios.post(boost::bind(task->callback, err,
+                    request, Response::SharedPtr()));
+                return; // no task started
+            }
+
+            HIVELOG_DEBUG(m_log, "{" << task.get() << "} sending "
+                << request->getMethod() << " request to <"
+                << request->getUrl().getHost() << "> with "
+                << timeout_ms << " ms timeout:\n" << *request);
+        }
+        else
+        {
+            HIVELOG_DEBUG(m_log, "{" << task.get() << "} sending "
+                << request->getMethod() << " request to <"
+                << request->getUrl().getHost()
+                << "> without timeout:\n" << *request);
+        }
+
+        m_tasks.push_back(task);
+        asyncStart(task);
+    }
+
+
+    /// @brief Start the task using pipeline, kept-alive or new connection.
+    /**
+    @param[in] task The task.
+    */
+    void asyncStart(Task::SharedPtr task)
+    {
+        if (joinPipeline(task))
+            return;
+
+        if (takeConnection(task))
+            asyncWriteRequest(task);
+        else
+            asyncResolve(task);
+    }
+
+
     /// @brief Finish the task.
     /**
     Gets the response content from the connection's buffer.
+    The streamed content is already passed to the content callback.
 
     @param[in] task The task.
     */
     void finish(Task::SharedPtr task)
     {
         HIVELOG_TRACE_BLOCK(m_log, "finish(task)");
+        saveTlsSession(task);
+
+        if (task->content_callback)
+        {
+            // content is already passed to the content callback
+            HIVELOG_DEBUG(m_log, "{" << task.get()
+                << "} got response (" << task->rx_done
+                << " content bytes streamed):\n"
+                << *task->response);
+            return;
+        }
 
         Connection::StreamBuf &sbuf = task->connection->getBuffer();
         Connection::StreamBuf::const_buffers_type data = sbuf.data();
 
-        if (task->rx_len != std::numeric_limits<size_t>::max())
+        if (task->rx_chunked) // already decoded
+        {
+            task->response->setContent(task->rx_content);
+            task->rx_content.clear();
+        }
+        else if (task->rx_len != std::numeric_limits<size_t>::max())
         {
             task->response->setContent(String(
                 boost::asio::buffers_begin(data),
@@ -2054,6 +2820,13 @@ private:
     {
         HIVELOG_TRACE_BLOCK(m_log, "done(task)");
 
+        if (task->pipeline && isRetryable(task, err))
+        {
+            // connection is broken, send again
+            breakPipeline(task->pipeline, err);
+            return;
+        }
+
         if (task->timer_started)
         {
             task->timer.cancel();
@@ -2071,6 +2844,8 @@ private:
         }
 
         m_tasks.remove(task);
+        if (task->pipeline)
+            pipelineDone(task, err);
     }
 
 /// @name Task timeout
@@ -2134,6 +2909,218 @@ private:
     }
 /// @}
 
+/// @name Connection pool
+/// @{
+private:
+
+    /// @brief The idle connection.
+    struct IdleConnection
+    {
+        Connection::SharedPtr connection; ///< @brief The connection.
+        boost::posix_time::ptime expires; ///< @brief The expiration time.
+    };
+
+    /// @brief The idle connections of one host, the most recent are at the end.
+    typedef std::deque<IdleConnection> IdleList;
+
+    /// @brief The connection pool type, the key is "protocol://host:port".
+    typedef std::map<String, IdleList> Pool;
+
+    Pool m_pool; ///< @brief The idle connections.
+    size_t m_poolMaxPerHost; ///< @brief The maximum number of idle connections per host.
+    size_t m_poolIdleTimeout_ms; ///< @brief The idle connection timeout, milliseconds.
+    size_t m_poolHits; ///< @brief The number of pool hits.
+    size_t m_poolMisses; ///< @brief The number of pool misses.
+
+private:
+
+    /// @brief Get the connection pool key.
+    /**
+    @param[in] url The request URL.
+    @return The "protocol://host:port" string.
+    */
+    static String poolKey(Url const& url)
+    {
+        String key = boost::to_lower_copy(url.getProtocol());
+        key += "://";
+        key += boost::to_lower_copy(url.getHost());
+        key += ":";
+        key += url.getPort().empty() ? url.getProtocol() : url.getPort();
+        return key;
+    }
+
+
+    /// @brief Take the idle connection from the pool.
+    /**
+    The most recently used connection is taken.
+
+    @param[in] task The task.
+    @return `true` if connection is taken.
+    */
+    bool takeConnection(Task::SharedPtr task)
+    {
+        if (0 == m_poolMaxPerHost)
+            return false;
+
+        closeIdle(boost::posix_time::microsec_clock::universal_time());
+        Pool::iterator i = m_pool.find(poolKey(task->request->getUrl()));
+        while (i != m_pool.end() && !task->connection)
+        {
+            Connection::SharedPtr conn = i->second.back().connection;
+            i->second.pop_back();
+            if (i->second.empty())
+            {
+                m_pool.erase(i);
+                i = m_pool.end();
+            }
+
+            if (conn->isClosed()) // closed by server while idle
+            {
+                HIVELOG_DEBUG(m_log, "{" << task.get()
+                    << "} kept-alive connection is closed by server");
+                conn->close();
+            }
+            else
+                task->connection = conn;
+        }
+
+        if (!task->connection)
+        {
+            m_poolMisses += 1;
+            return false;
+        }
+
+        task->reused = true;
+        m_poolHits += 1;
+
+        HIVELOG_DEBUG(m_log, "{" << task.get()
+            << "} reuse kept-alive connection");
+        return true;
+    }
+
+
+    /// @brief Put the task's connection into the pool.
+    /**
+    The connection is reused only if whole response is received,
+    no more data is in the buffer and both request and response
+    allow persistent connection.
+
+    The pipelined connections are handled by pipelineDone().
+
+    @param[in] task The task.
+    */
+    void releaseConnection(Task::SharedPtr task)
+    {
+        if (task->pipeline || !task->connection
+            || 0 != task->connection->getBuffer().size()
+            || !isReusable(task))
+                return;
+
+        keepIdle(poolKey(task->request->getUrl()), task->connection);
+        task->connection.reset(); // not closed by Task::cancel()
+    }
+
+
+    /// @brief Might the task's connection be used for the next request?
+    /**
+    @param[in] task The completed task.
+    @return `true` if the content length is known (or content is "chunked")
+        and both request and response allow persistent connection.
+    */
+    static bool isReusable(Task::SharedPtr const& task)
+    {
+        if (task->cancelled || !task->response || (!task->rx_chunked
+            && task->rx_len == std::numeric_limits<size_t>::max()))
+                return false;
+
+        if (boost::iequals(task->request->getHeader(header::Connection), "close"))
+            return false;
+
+        const String conn = task->response->getHeader(header::Connection);
+        const bool http11 = 1 < task->response->getVersionMajor()
+            || (1 == task->response->getVersionMajor()
+             && 1 <= task->response->getVersionMinor());
+        return http11 ? !boost::iequals(conn, "close") : boost::iequals(conn, "keep-alive");
+    }
+
+
+    /// @brief Put the connection into the pool.
+    /**
+    The connection is closed if the pool is disabled.
+    The oldest idle connection is closed if there are too many.
+
+    @param[in] key The connection pool key.
+    @param[in] connection The idle connection.
+    */
+    void keepIdle(String const& key, Connection::SharedPtr connection)
+    {
+        if (0 == m_poolMaxPerHost)
+        {
+            connection->close();
+            return;
+        }
+
+        IdleConnection idle;
+        idle.connection = connection;
+        idle.expires = boost::posix_time::microsec_clock::universal_time()
+            + boost::posix_time::milliseconds(m_poolIdleTimeout_ms);
+
+        IdleList &list = m_pool[key];
+        if (m_poolMaxPerHost <= list.size())
+        {
+            list.front().connection->close();
+            list.pop_front();
+        }
+        list.push_back(idle);
+
+        HIVELOG_DEBUG(m_log, "connection to <" << key
+            << "> is kept alive, " << list.size() << " idle");
+    }
+
+
+    /// @brief Close the expired idle connections.
+    /**
+    @param[in] now The current time or `pos_infin` to close all connections.
+    */
+    void closeIdle(boost::posix_time::ptime const& now)
+    {
+        for (Pool::iterator i = m_pool.begin(); i != m_pool.end();)
+        {
+            IdleList &list = i->second;
+            while (!list.empty() && list.front().expires <= now)
+            {
+                list.front().connection->close();
+                list.pop_front();
+            }
+
+            if (list.empty())
+                m_pool.erase(i++);
+            else
+                ++i;
+        }
+    }
+
+
+    /// @brief Send request again using new connection.
+    /**
+    Used if kept-alive connection is broken and the request
+    might be sent again safely.
+
+    @param[in] task The task.
+    */
+    void asyncRetry(Task::SharedPtr task)
+    {
+        HIVELOG_TRACE_BLOCK(m_log, "asyncRetry(task)");
+
+        task->reused = false;
+        task->connection->close();
+        task->connection.reset();
+        if (task->pipeline) // nothing else is sent yet
+            task->pipeline->connection.reset();
+        asyncResolve(task);
+    }
+/// @}
+
 /// @name Resolve the host
 /// @{
 private:
@@ -2150,9 +3137,16 @@ private:
         String const& service = url.getPort().empty()
             ? url.getProtocol() : url.getPort();
 
+        if (0 < m_dnsTtl_ms)
+        {
+            asyncResolveCached(task, url.getHost(), service);
+            return;
+        }
+
         // start async resolve operation
         HIVELOG_DEBUG(m_log, "{" << task.get() << "} start async resolve <"
             << url.getHost() << ">, \"" << service << "\" service");
+        m_dnsResolves += 1;
         task->resolver.async_resolve(Resolver::query(url.getHost(), service),
             boost::bind(&Client::onResolved, shared_from_this(),
                 task, boost::asio::placeholders::error,
@@ -2186,13 +3180,148 @@ private:
         }
         else
         {
-            HIVELOG_ERROR(m_log, "{" << task.get() << "} <"
-                << task->request->getUrl().getHost()
-                << "> async resolve error: ["
-                << err << "] " << err.message());
-            done(task, err);
+            HIVELOG_ERROR(m_log, "{" << task.get() << "} <"
+                << task->request->getUrl().getHost()
+                << "> async resolve error: ["
+                << err << "] " << err.message());
+            done(task, err);
+        }
+    }
+
+private:
+
+    /// @brief The DNS cache entry.
+    struct DnsEntry
+    {
+        Resolver::iterator endpoints; ///< @brief The resolved endpoints.
+        ErrorCode error; ///< @brief The resolve error.
+        boost::posix_time::ptime expires; ///< @brief The expiration time.
+
+        boost::shared_ptr<Resolver> resolver; ///< @brief The pending resolver or NULL.
+        std::vector<Task::SharedPtr> waiters; ///< @brief The tasks waiting for pending resolver.
+    };
+
+    /// @brief The DNS cache type, the key is "host:service".
+    typedef std::map<String, DnsEntry> DnsCache;
+
+    DnsCache m_dnsCache; ///< @brief The DNS cache.
+    size_t m_dnsTtl_ms; ///< @brief The resolved endpoints time-to-live, milliseconds.
+    size_t m_dnsNegativeTtl_ms; ///< @brief The resolve error time-to-live, milliseconds.
+    size_t m_dnsResolves; ///< @brief The number of resolve operations.
+
+private:
+
+    /// @brief Get the DNS cache key.
+    /**
+    @param[in] url The request URL.
+    @return The "host:service" string.
+    */
+    static String dnsKey(Url const& url)
+    {
+        String key = boost::to_lower_copy(url.getHost());
+        key += ":";
+        key += url.getPort().empty() ? url.getProtocol() : url.getPort();
+        return key;
+    }
+
+
+    /// @brief Resolve the host using DNS cache.
+    /**
+    The task gets the cached endpoints (or error) immediately,
+    joins the pending resolve operation or starts a new one.
+
+    @param[in] task The task.
+    @param[in] host The host name.
+    @param[in] service The service name.
+    */
+    void asyncResolveCached(Task::SharedPtr task, String const& host, String const& service)
+    {
+        HIVELOG_TRACE_BLOCK(m_log, "asyncResolveCached(task)");
+
+        const String key = dnsKey(task->request->getUrl());
+        DnsEntry &entry = m_dnsCache[key];
+
+        if (!entry.resolver && !entry.expires.is_not_a_date_time()
+            && boost::posix_time::microsec_clock::universal_time() < entry.expires)
+        {
+            HIVELOG_DEBUG(m_log, "{" << task.get() << "} <"
+                << host << "> resolved from cache");
+            onResolved(task, entry.error, entry.endpoints);
+            return;
+        }
+
+        entry.waiters.push_back(task);
+        if (entry.resolver)
+        {
+            HIVELOG_DEBUG(m_log, "{" << task.get() << "} wait for pending resolve <"
+                << host << ">, \"" << service << "\" service");
+            return;
+        }
+
+        // start async resolve operation
+        HIVELOG_DEBUG(m_log, "{" << task.get() << "} start async cached resolve <"
+            << host << ">, \"" << service << "\" service");
+        entry.resolver.reset(new Resolver(m_ios));
+        m_dnsResolves += 1;
+        entry.resolver->async_resolve(Resolver::query(host, service),
+            boost::bind(&Client::onResolvedCached, shared_from_this(),
+                key, boost::asio::placeholders::error,
+                boost::asio::placeholders::iterator));
+    }
+
+
+    /// @brief Cached resolve operation completed.
+    /**
+    Updates the cache entry and passes result to all waiting tasks.
+
+    @param[in] key The DNS cache key.
+    @param[in] err The error code.
+    @param[in] epi The endpoint iterator.
+    */
+    void onResolvedCached(String const& key, ErrorCode err, Resolver::iterator epi)
+    {
+        HIVELOG_TRACE_BLOCK(m_log, "onResolvedCached()");
+
+        DnsCache::iterator i = m_dnsCache.find(key);
+        if (i == m_dnsCache.end())
+            return; // should not happen
+
+        std::vector<Task::SharedPtr> waiters;
+        waiters.swap(i->second.waiters);
+
+        const size_t ttl_ms = err ? m_dnsNegativeTtl_ms : m_dnsTtl_ms;
+        if (0 < ttl_ms && boost::asio::error::operation_aborted != err)
+        {
+            DnsEntry &entry = i->second;
+            entry.resolver.reset();
+            entry.endpoints = epi;
+            entry.error = err;
+            entry.expires = boost::posix_time::microsec_clock::universal_time()
+                + boost::posix_time::milliseconds(ttl_ms);
+        }
+        else
+            m_dnsCache.erase(i);
+
+        for (size_t k = 0; k < waiters.size(); ++k)
+        {
+            if (!waiters[k]->cancelled)
+                onResolved(waiters[k], err, epi);
         }
     }
+
+
+    /// @brief Drop the cached endpoints.
+    /**
+    Called if connection to the cached endpoints fails.
+
+    @param[in] task The task.
+    */
+    void forgetResolved(Task::SharedPtr task)
+    {
+        DnsCache::iterator i = m_dnsCache.find(dnsKey(task->request->getUrl()));
+        if (i != m_dnsCache.end() && !i->second.resolver)
+            m_dnsCache.erase(i);
+    }
 /// @}
 
 /// @name Connect to the host
@@ -2208,15 +3337,20 @@ private:
     {
         HIVELOG_TRACE_BLOCK(m_log, "asyncConnect(task)");
 
-        if (boost::iequals(task->request->getUrl().getProtocol(), "https")) // secure connection?
+        if (isSecure(task)) // secure connection?
         {
 #if !defined(HIVE_DISABLE_SSL)
-            // TODO: select one of unused connection?
             Connection::Secure::SharedPtr conn = Connection::Secure::create(m_ios, m_context);
             conn->getStream().set_verify_mode(boost::asio::ssl::verify_none); // TODO: boost::asio::ssl::verify_peer
             conn->getStream().set_verify_callback(
                 boost::bind(&Client::onVerify,
                     shared_from_this(), _1, _2));
+            if (m_tlsResumption)
+            {
+                TlsSessions::const_iterator i = m_tlsSessions.find(poolKey(task->request->getUrl()));
+                if (i != m_tlsSessions.end())
+                    conn->setSession(i->second);
+            }
             task->connection = conn;
 #else
             HIVELOG_WARN(m_log, "{" << task.get()
@@ -2227,7 +3361,6 @@ private:
         }
         else
         {
-            // TODO: select one of unused connection?
             task->connection = Connection::Simple::create(m_ios);
         }
 
@@ -2266,6 +3399,7 @@ private:
             HIVELOG_ERROR(m_log, "{" << task.get()
                 << "} async connection error: ["
                 << err << "] " << err.message());
+            forgetResolved(task);
             done(task, err);
         }
     }
@@ -2308,6 +3442,17 @@ private:
 
         if (!err && !task->cancelled)
         {
+#if !defined(HIVE_DISABLE_SSL)
+            if (isSecure(task))
+            {
+                Connection::Secure &conn = static_cast<Connection::Secure&>(*task->connection);
+                const bool resumed = conn.isSessionReused();
+                (resumed ? m_tlsResumed : m_tlsFull) += 1;
+                HIVELOG_DEBUG(m_log, "{" << task.get() << "} "
+                    << (resumed ? "resumed" : "full") << " TLS handshake");
+            }
+#endif // HIVE_DISABLE_SSL
+
             asyncWriteRequest(task);
         }
         else if (boost::asio::error::operation_aborted == err && task->cancelled)
@@ -2321,10 +3466,56 @@ private:
             HIVELOG_ERROR(m_log, "{" << task.get()
                 << "} async handshake error: ["
                 << err << "] " << err.message());
+#if !defined(HIVE_DISABLE_SSL)
+            m_tlsSessions.erase(poolKey(task->request->getUrl()));
+#endif // HIVE_DISABLE_SSL
             done(task, err);
         }
     }
 
+
+    /// @brief Is the task's connection secure?
+    /**
+    @param[in] task The task.
+    @return `true` for HTTPS requests.
+    */
+    static bool isSecure(Task::SharedPtr const& task)
+    {
+        return boost::iequals(task->request->getUrl().getProtocol(), "https");
+    }
+
+private:
+    size_t m_tlsResumed; ///< @brief The number of resumed TLS handshakes.
+    size_t m_tlsFull;    ///< @brief The number of full TLS handshakes.
+    bool m_tlsResumption; ///< @brief The TLS session resumption flag.
+
+#if !defined(HIVE_DISABLE_SSL)
+    /// @brief The TLS sessions, the key is "protocol://host:port".
+    typedef std::map<String, Connection::Secure::Session> TlsSessions;
+    TlsSessions m_tlsSessions; ///< @brief The last TLS sessions.
+#endif // HIVE_DISABLE_SSL
+
+    /// @brief Save the TLS session for resumption.
+    /**
+    Called once the response is received, so the TLS 1.3
+    session ticket is already processed.
+
+    @param[in] task The task.
+    */
+    void saveTlsSession(Task::SharedPtr task)
+    {
+#if !defined(HIVE_DISABLE_SSL)
+        if (m_tlsResumption && task->connection && isSecure(task))
+        {
+            Connection::Secure &conn = static_cast<Connection::Secure&>(*task->connection);
+            if (Connection::Secure::Session session = conn.getSession())
+                m_tlsSessions[poolKey(task->request->getUrl())] = session;
+        }
+#else
+        (void)task; // not used
+#endif // HIVE_DISABLE_SSL
+    }
+
 #if !defined(HIVE_DISABLE_SSL)
 
     /// @brief Verify certificate.
@@ -2346,6 +3537,302 @@ private:
 #endif // HIVE_DISABLE_SSL
 /// @}
 
+/// @name Pipelining
+/// @{
+private:
+
+    /// @brief The pipeline.
+    /**
+    One connection shared by several pipelined requests.
+    */
+    struct Pipeline
+    {
+        String key; ///< @brief The "protocol://host:port" key.
+        Connection::SharedPtr connection; ///< @brief The connection, NULL until the first request is written.
+        bool ready; ///< @brief The "connection is alive" flag.
+        bool writing; ///< @brief The "write in progress" flag.
+
+        std::deque<Task::SharedPtr> queue; ///< @brief The requests to write.
+        std::deque<Task::SharedPtr> active; ///< @brief The written requests, in response order.
+
+        /// @brief The default constructor.
+        Pipeline()
+            : ready(false)
+            , writing(false)
+        {}
+    };
+
+    /// @brief The pipelines type.
+    typedef std::map<String, boost::shared_ptr<Pipeline> > Pipelines;
+
+    Pipelines m_pipelines; ///< @brief The active pipelines.
+    size_t m_pipelineDepth; ///< @brief The maximum number of written but unanswered requests.
+
+    /// @brief The maximum number of attempts to send one pipelined request.
+    enum { MAX_PIPELINE_ATTEMPTS = 3 };
+
+private:
+
+    /// @brief Join the task to the pipeline.
+    /**
+    If there is no pipeline to the task's host, the new one is created
+    and the task is started as usual: it opens the pipeline.
+
+    @param[in] task The task.
+    @return `true` if task is queued to the existing pipeline.
+    */
+    bool joinPipeline(Task::SharedPtr task)
+    {
+        if (0 == m_pipelineDepth || !task->pipelined)
+            return false;
+
+        const String key = poolKey(task->request->getUrl());
+        Pipelines::iterator i = m_pipelines.find(key);
+        if (i == m_pipelines.end())
+        {
+            boost::shared_ptr<Pipeline> p(new Pipeline());
+            p->key = key;
+            p->active.push_back(task);
+            task->pipeline = p;
+            m_pipelines[key] = p;
+            return false;
+        }
+
+        boost::shared_ptr<Pipeline> p = i->second;
+        HIVELOG_DEBUG(m_log, "{" << task.get() << "} pipelined after "
+            << (p->active.size() + p->queue.size()) << " requests");
+
+        task->pipeline = p;
+        p->queue.push_back(task);
+        asyncPipelineWrite(p);
+        return true;
+    }
+
+
+    /// @brief Write the next queued request.
+    /**
+    @param[in] p The pipeline.
+    */
+    void asyncPipelineWrite(boost::shared_ptr<Pipeline> p)
+    {
+        if (!p->ready || p->writing || p->queue.empty()
+            || m_pipelineDepth <= p->active.size())
+                return;
+
+        Task::SharedPtr task = p->queue.front();
+        p->queue.pop_front();
+        p->active.push_back(task);
+        p->writing = true;
+
+        task->connection = p->connection;
+        asyncWriteRequest(task);
+    }
+
+
+    /// @brief Pipelined request is written.
+    /**
+    Starts response receiving if all previous responses are received.
+
+    @param[in] task The task.
+    */
+    void onPipelineWritten(Task::SharedPtr task)
+    {
+        boost::shared_ptr<Pipeline> p = task->pipeline;
+        task->sent = true;
+        p->writing = false;
+
+        if (p->active.front() == task)
+            asyncReadStatus(task);
+        asyncPipelineWrite(p);
+    }
+
+
+    /// @brief Pipelined task is finished.
+    /**
+    On success the next response is received. If all requests
+    are done the connection is put into the pool.
+    The queued (not yet written) task is just removed from the queue,
+    for example on timeout. Otherwise the pipeline is broken.
+
+    @param[in] task The task.
+    @param[in] err The error code.
+    */
+    void pipelineDone(Task::SharedPtr task, ErrorCode err)
+    {
+        boost::shared_ptr<Pipeline> p = task->pipeline;
+        task->pipeline.reset();
+
+        std::deque<Task::SharedPtr>::iterator q = std::find(p->queue.begin(), p->queue.end(), task);
+        if (q != p->queue.end()) // never written, the pipeline is intact
+        {
+            HIVELOG_DEBUG(m_log, "{" << task.get() << "} removed from pipeline queue");
+            p->queue.erase(q);
+            return;
+        }
+
+        if (err || p->active.empty() || p->active.front() != task || !isReusable(task))
+        {
+            breakPipeline(p, err);
+            return;
+        }
+
+        p->active.pop_front();
+        p->ready = true;
+        if (!p->active.empty())
+        {
+            if (p->active.front()->sent)
+                asyncReadStatus(p->active.front());
+        }
+        else if (p->queue.empty()) // all done
+        {
+            m_pipelines.erase(p->key);
+            if (0 == p->connection->getBuffer().size())
+                keepIdle(p->key, p->connection);
+            else
+                p->connection->close();
+            task->connection.reset(); // not closed by Task::cancel()
+            return;
+        }
+
+        asyncPipelineWrite(p);
+    }
+
+
+    /// @brief Break the pipeline.
+    /**
+    The connection is closed. The requests are sent again or finished
+    with error, see setPipelining().
+
+    @param[in] p The pipeline.
+    @param[in] err The error code.
+    */
+    void breakPipeline(boost::shared_ptr<Pipeline> p, ErrorCode err)
+    {
+        Pipelines::iterator i = m_pipelines.find(p->key);
+        if (i != m_pipelines.end() && i->second == p)
+            m_pipelines.erase(i);
+        if (p->connection)
+            p->connection->close();
+
+        const bool aborted = (boost::asio::error::operation_aborted == err);
+        HIVELOG_DEBUG(m_log, "pipeline to <" << p->key << "> is broken, "
+            << p->active.size() << " active and "
+            << p->queue.size() << " queued requests");
+
+        std::deque<Task::SharedPtr> active;
+        active.swap(p->active);
+        for (size_t k = 0; k < active.size(); ++k)
+        {
+            Task::SharedPtr task = active[k];
+            if (!task->pipeline)
+                continue; // already done
+            task->pipeline.reset();
+
+            if (!aborted && isIdempotent(task->request)
+                && task->retries+1 < MAX_PIPELINE_ATTEMPTS)
+                    requeue(task, true);
+            else
+            {
+                done(task, aborted ? err : ErrorCode(boost::asio::error::connection_aborted));
+                task->cancel();
+            }
+        }
+
+        std::deque<Task::SharedPtr> queue;
+        queue.swap(p->queue);
+        for (size_t k = 0; k < queue.size(); ++k)
+        {
+            Task::SharedPtr task = queue[k];
+            task->pipeline.reset();
+
+            if (!aborted)
+                requeue(task, false);
+            else
+            {
+                done(task, err);
+                task->cancel();
+            }
+        }
+    }
+
+
+    /// @brief Start the task again.
+    /**
+    The new task is started with the same request, callbacks and deadline.
+    The old task is cancelled silently.
+
+    @param[in] task The task.
+    @param[in] attempted The "request was sent or being sent" flag.
+    */
+    void requeue(Task::SharedPtr task, bool attempted)
+    {
+        Task::SharedPtr copy(new Task(m_ios, task->request, task->callback));
+        copy->content_callback = task->content_callback;
+        copy->pipelined = task->pipelined;
+        copy->retries = task->retries + (attempted ? 1 : 0);
+
+        if (task->timer_started)
+        {
+            ErrorCode err;
+            copy->timer.expires_at(task->timer.expires_at(), err);
+            if (!err)
+            {
+                copy->timer.async_wait(
+                    boost::bind(&Client::onTimedOut, shared_from_this(),
+                        copy, boost::asio::placeholders::error));
+                copy->timer_started = true;
+            }
+
+            task->timer.cancel();
+            task->timer_started = false;
+        }
+
+        task->callback = Callback();
+        m_tasks.remove(task);
+        task->cancel();
+
+        HIVELOG_DEBUG(m_log, "{" << task.get() << "} requeued as {"
+            << copy.get() << "}");
+        m_tasks.push_back(copy);
+        asyncStart(copy);
+    }
+
+
+    /// @brief Might the failed pipelined task be sent again?
+    /**
+    @param[in] task The task.
+    @param[in] err The error code.
+    @return `true` if the connection is broken, the request is idempotent,
+        no content is passed to the content callback yet and
+        the number of attempts is not exceeded.
+    */
+    static bool isRetryable(Task::SharedPtr const& task, ErrorCode err)
+    {
+        return err && boost::asio::error::operation_aborted != err
+            && boost::asio::error::timed_out != err
+            && !task->cancelled && 0 == task->rx_done
+            && task->retries+1 < MAX_PIPELINE_ATTEMPTS
+            && isIdempotent(task->request);
+    }
+
+
+    /// @brief Is the request method idempotent?
+    /**
+    @param[in] request The request.
+    @return `true` if request might be sent again safely.
+    */
+    static bool isIdempotent(Request::SharedPtr const& request)
+    {
+        String const& method = request->getMethod();
+        return boost::iequals(method, "GET")
+            || boost::iequals(method, "HEAD")
+            || boost::iequals(method, "PUT")
+            || boost::iequals(method, "DELETE")
+            || boost::iequals(method, "OPTIONS")
+            || boost::iequals(method, "TRACE");
+    }
+/// @}
+
 /// @name Send request
 /// @{
 private:
@@ -2358,10 +3845,39 @@ private:
     {
         HIVELOG_TRACE_BLOCK(m_log, "asyncWriteRequest(task)");
 
-        // prepare output buffer
-        Connection::StreamBuf &sbuf = task->connection->getBuffer();
+        if (task->pipeline && !task->pipeline->connection) // opens the pipeline
+        {
+            task->pipeline->connection = task->connection;
+            task->pipeline->ready = false; // wait for response, server might close connection
+            task->pipeline->writing = true;
+        }
+
+        // prepare output buffer (connection's buffer might contain pipelined responses)
+        // "chunked" content is encoded to the same buffer
+        Connection::StreamBuf &sbuf = task->tx_buf;
+        sbuf.consume(sbuf.size()); // unsent data of the failed attempt
         OStream os(&sbuf);
-        task->request->write(os);
+        const bool chunked = task->request->isChunked();
+        task->request->write(os, chunked);
+
+        Connection::ConstBuffers const& content = task->request->getContentBuffers();
+        if (!content.empty() && !chunked)
+        {
+            // send request head along with content buffers, no copy
+            Connection::ConstBuffers buffers;
+            buffers.reserve(1 + content.size());
+            buffers.push_back(boost::asio::const_buffer(sbuf.data()));
+            buffers.insert(buffers.end(), content.begin(), content.end());
+
+            HIVELOG_DEBUG(m_log, "{" << task.get()
+                << "} start async request sending ("
+                << buffers.size() << " buffers)");
+            task->connection->asyncWriteAll(buffers,
+                boost::bind(&Client::onRequestBuffersWritten,
+                    shared_from_this(), task, boost::asio::placeholders::error,
+                    boost::asio::placeholders::bytes_transferred));
+            return;
+        }
 
         // send whole request
         HIVELOG_DEBUG(m_log, "{" << task.get()
@@ -2373,6 +3889,23 @@ private:
     }
 
 
+    /// @brief %Request send operation completed (scatter-gather).
+    /**
+    Releases the request head from the stream buffer.
+
+    @param[in] task The task.
+    @param[in] err The error code.
+    @param[in] len The number of bytes transferred.
+    */
+    void onRequestBuffersWritten(Task::SharedPtr task, ErrorCode err, size_t len)
+    {
+        Connection::StreamBuf &sbuf = task->tx_buf;
+        sbuf.consume(sbuf.size());
+
+        onRequestWritten(task, err, len);
+    }
+
+
     /// @brief %Request send operation completed.
     /**
     @param[in] task The task.
@@ -2385,7 +3918,10 @@ private:
 
         if (!err && !task->cancelled)
         {
-            asyncReadStatus(task);
+            if (task->pipeline)
+                onPipelineWritten(task);
+            else
+                asyncReadStatus(task);
         }
         else if (boost::asio::error::operation_aborted == err && task->cancelled)
         {
@@ -2393,6 +3929,14 @@ private:
                 << "} async request sending cancelled");
             // do nothing
         }
+        else if (task->reused && !task->cancelled
+            && (0 == len || isIdempotent(task->request)))
+        {
+            HIVELOG_DEBUG(m_log, "{" << task.get()
+                << "} kept-alive connection is broken: ["
+                << err << "] " << err.message());
+            asyncRetry(task);
+        }
         else
         {
             HIVELOG_ERROR(m_log, "{" << task.get()
@@ -2469,6 +4013,14 @@ private:
                 << "} async status line receiving cancelled");
             // do nothing
         }
+        else if (task->reused && !task->cancelled
+            && isIdempotent(task->request))
+        {
+            HIVELOG_DEBUG(m_log, "{" << task.get()
+                << "} kept-alive connection is broken: ["
+                << err << "] " << err.message());
+            asyncRetry(task);
+        }
         else
         {
             HIVELOG_ERROR(m_log, "{" << task.get()
@@ -2518,16 +4070,16 @@ private:
 
             if (parseHeaders(buf_beg, buf_end, task->response))
             {
+                // "Transfer-Encoding" overrides "Content-Length"
                 const String len_s = task->response->getHeader(header::Content_Length);
-                if (!len_s.empty())
+                if (task->response->isChunked())
+                    task->rx_chunked = true;
+                else if (!len_s.empty())
                     task->rx_len = boost::lexical_cast<size_t>(len_s);
 
                 // stop if we got all content data
-                if (task->rx_len <= sbuf.size())
-                {
-                    finish(task);
-                    done(task, err);
-                }
+                if (checkContent(task, err))
+                    onContentDone(task, err);
                 else // continue reading
                     asyncReadContent(task);
             }
@@ -2577,6 +4129,80 @@ private:
     }
 
 
+    /// @brief The decoded "chunked" content handler.
+    /**
+    Passes the content to the content callback
+    or appends it to the task's content.
+    */
+    struct ChunkedContent
+    {
+        Task *task; ///< @brief The task.
+
+        /// @brief Handle the next part of content.
+        /**
+        @param[in] data The content data.
+        @param[in] len The content length in bytes.
+        */
+        void operator()(const char *data, size_t len) const
+        {
+            if (task->content_callback)
+                task->content_callback(data, len);
+            else
+                task->rx_content.append(data, len);
+            task->rx_done += len;
+        }
+    };
+
+
+    /// @brief Check the received content.
+    /**
+    If the content callback is provided, the received content
+    is passed to this callback and removed from the connection's buffer.
+    Otherwise the content is kept in the buffer until finish().
+
+    The "chunked" content is always decoded and removed
+    from the connection's buffer as it arrives.
+
+    @param[in] task The task.
+    @param[out] err The error code in case of bad "chunked" content.
+    @return `true` if the whole content is received or error occurred.
+    */
+    bool checkContent(Task::SharedPtr task, ErrorCode &err)
+    {
+        Connection::StreamBuf &sbuf = task->connection->getBuffer();
+        if (task->rx_chunked)
+        {
+            ChunkedContent handler = { task.get() };
+            sbuf.consume(task->rx_decoder.decode(boost::asio::buffer_cast<const char*>(sbuf.data()),
+                sbuf.size(), handler));
+
+            if (task->rx_decoder.isFailed())
+            {
+                HIVELOG_ERROR(m_log, "{" << task.get()
+                    << "} bad chunked content");
+                err = boost::asio::error::invalid_argument;
+                return true;
+            }
+
+            return task->rx_decoder.isDone();
+        }
+
+        if (!task->content_callback)
+            return task->rx_len <= sbuf.size();
+
+        const size_t len = std::min(sbuf.size(),
+            task->rx_len - task->rx_done);
+        if (0 < len)
+        {
+            task->content_callback(boost::asio::buffer_cast<const char*>(sbuf.data()), len);
+            task->rx_done += len;
+            sbuf.consume(len);
+        }
+
+        return task->rx_len <= task->rx_done;
+    }
+
+
     /// @brief %Response content read operation completed.
     /**
     @param[in] task The task.
@@ -2586,24 +4212,21 @@ private:
     {
         HIVELOG_TRACE_BLOCK(m_log, "onContentRead(task)");
 
-        Connection::StreamBuf &sbuf = task->connection->getBuffer();
         if (!err && !task->cancelled)
         {
             // stop if we got all content data
-            if (task->rx_len <= sbuf.size())
-            {
-                finish(task);
-                done(task, err);
-            }
+            if (checkContent(task, err))
+                onContentDone(task, err);
             else // continue reading
                 asyncReadContent(task);
         }
         else if (err == boost::asio::error::eof)
         {
             // clear error if we got the whole content
-            if (task->rx_len == std::numeric_limits<size_t>::max()
-                || task->rx_len <= sbuf.size())
-                    err = ErrorCode();
+            ErrorCode content_err;
+            if (checkContent(task, content_err) || (!task->rx_chunked
+                    && task->rx_len == std::numeric_limits<size_t>::max()))
+                err = content_err;
 
             finish(task);
             done(task, err);
@@ -2616,6 +4239,22 @@ private:
             done(task, err);
         }
     }
+
+
+    /// @brief The whole content is received.
+    /**
+    @param[in] task The task.
+    @param[in] err The content error code.
+    */
+    void onContentDone(Task::SharedPtr task, ErrorCode err)
+    {
+        if (!err)
+        {
+            finish(task);
+            releaseConnection(task);
+        }
+        done(task, err);
+    }
 /// @}
 
 /// @name Dump tools
@@ -2925,6 +4564,8 @@ int main()
 
 You can customize your HTTP request by providing custom HTTP headers (see hive::http::Message::addHeader()
 method and hive::http::header namespace) and message context (see hive::http::Message::setContent()).
+The request content is sent using "chunked" transfer-coding if the `Transfer-Encoding: chunked`
+header is provided. The "chunked" responses are decoded automatically.
 
 The callback method may be any callable object with the following signature:
 
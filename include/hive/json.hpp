@@ -16,6 +16,13 @@ See also RFC-4627 http://tools.ietf.org/html/rfc4627
 
 #if !defined(HIVE_PCH)
 #   include <assert.h>
+#   include <stdlib.h>
+#   include <stdio.h>
+#   include <string.h>
+#   include <locale.h>
+#   include <algorithm>
+#   include <deque>
+#   include <new>
 #   include <sstream>
 #   include <string>
 #   include <vector>
@@ -23,6 +30,31 @@ See also RFC-4627 http://tools.ietf.org/html/rfc4627
 #   include <map>
 #endif // HIVE_PCH
 
+// SSE2 is used by the JSON lexer to scan 16 bytes at a time
+#if !defined(HIVE_DISABLE_SIMD)
+#   if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#       define IMPL_HIVE_JSON_SSE2
+#       include <emmintrin.h>
+#   endif
+#endif // HIVE_DISABLE_SIMD
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif // _MSC_VER
+
+#if defined(HIVE_JSON_PARALLEL)
+#   if defined(HIVE_JSON_INTERNED_KEYS)
+#       error The global key table is not thread-safe, it cannot be used with parallel parser
+#   endif
+#   include <boost/thread.hpp>
+#   include <boost/bind.hpp>
+#endif // HIVE_JSON_PARALLEL
+
+// the deep copy hook is for tests only, empty by default
+#if !defined(HIVE_JSON_ON_COPY)
+#   define HIVE_JSON_ON_COPY()
+#endif // HIVE_JSON_ON_COPY
+
 namespace hive
 {
     /// @brief The JSON module.
@@ -149,1739 +181,7833 @@ public:
         } // error namespace
 
 
-/// @brief The JSON value.
+/// @brief The monotonic memory arena.
 /**
-The JSON value may be one of the following:
-    - NULL
-    - boolean
-    - integer
-    - double
-    - string
-    - array
-    - object
-
-JSON conversions {#hive_json_value_conv}
-========================================
+The arena allocates memory from big blocks just by moving a pointer.
+The individual allocations are never freed, all memory is released
+in one shot by release() method or by the destructor.
 
-Some of JSON values may be converted to the another. There is the conversion table:
-    - to boolean:
-        - from NULL is always converted as `false`
-        - zero integers as `false`, non-zero as `true`
-        - zero floating-point as `false`, non-zero as `true`
-        - empty string as `false`
-        - "false" string as `false`
-        - "true" string as `true`
-    - to integer:
-        - from NULL as `0`
-        - from boolean as `0` or `1`
-        - empty string as `0`
-        - from string parsed value
-    - to double:
-        - from NULL as `0.0`
-        - from boolean as `0.0` or `1.0`
-        - from integers
-        - empty string as `0.0`
-        - from string parsed value
-    - to string:
-        - from NULL as empty string
-        - from boolean as `"true"` or `"false"`
-        - from integers
-        - from floating-point
-    - to array:
-        - from NULL as empty array
-    - to object:
-        - from NULL as empty object
+It's used to build whole JSON document with a few memory allocations
+(see ArenaAllocator and Parser::parse()), so the arena should live
+longer than all values allocated from it.
 */
-class Value
+class Arena:
+    private NonCopyable
 {
 public:
 
-    /// @brief The value type.
-    enum Type
+    /// @brief The main constructor.
+    /**
+    @param[in] blockSize The first block size in bytes.
+        Each next block is twice as big up to 1MB.
+    */
+    explicit Arena(size_t blockSize = 4096)
+        : m_blocks(0),
+          m_ptr(0),
+          m_end(0),
+          m_blockSize(blockSize),
+          m_blockCount(0)
+    {}
+
+
+    /// @brief The destructor.
+    /**
+    Releases all memory blocks.
+    */
+    ~Arena()
     {
-        TYPE_NULL,    ///< @brief The NULL value.
-        TYPE_BOOLEAN, ///< @brief The boolean value.
-        TYPE_INTEGER, ///< @brief The integer value.
-        TYPE_DOUBLE,  ///< @brief The floating-point value.
-        TYPE_STRING,  ///< @brief The string value.
-        TYPE_ARRAY,   ///< @brief The array value.
-        TYPE_OBJECT   ///< @brief The object value.
-    };
+        release();
+    }
 
-/// @name Constructors
-/// @{
 public:
 
-    /// @brief The default constructor.
+    /// @brief Allocate the memory.
     /**
-    This constructor may be used to make empty arrays or objects.
+    The memory is aligned to be suitable for any type.
 
-    @param[in] type The value type (NULL by default).
+    @param[in] size The number of bytes to allocate.
+    @return The allocated memory.
+    @throw std::bad_alloc if no memory.
     */
-    explicit Value(Type type = TYPE_NULL)
-        : m_type(type)
+    void* allocate(size_t size)
     {
-        m_val.u = 0;
+        size = align(size ? size : 1);
+        if (size_t(m_end - m_ptr) < size)
+            return allocateBlock(size);
+
+        void *p = m_ptr;
+        m_ptr += size;
+        return p;
     }
 
 
-    /// @brief Construct the boolean value.
+    /// @brief Release all memory blocks.
     /**
-    @param[in] val The boolean value.
+    All memory allocated from the arena becomes invalid.
     */
-    /*explicit*/ Value(bool val)
-        : m_type(TYPE_BOOLEAN)
+    void release()
     {
-        m_val.u = val?1:0;
+        while (Block *b = m_blocks)
+        {
+            m_blocks = b->next;
+            ::operator delete(b);
+        }
+
+        m_ptr = m_end = 0;
+        m_blockCount = 0;
     }
 
 
-    /// @brief Construct the integer value (8 bits).
+    /// @brief Release all memory blocks except the current one.
     /**
-    @param[in] val The signed integer value.
+    All memory allocated from the arena becomes invalid,
+    but the current (the biggest) block is reused.
     */
-    /*explicit*/ Value(Int8 val)
-        : m_type(TYPE_INTEGER)
+    void reset()
     {
-        m_val.i = val;
+        if (Block *b = m_blocks)
+        {
+            m_blocks = b->next;
+            b->next = 0;
+            release();
+
+            m_blocks = b;
+            m_blockCount = 1;
+            m_ptr = reinterpret_cast<char*>(b) + align(sizeof(Block));
+            m_end = m_ptr + b->size;
+        }
     }
 
 
-    /// @brief Construct the integer value (8 bits).
+    /// @brief Get the number of allocated blocks.
     /**
-    @param[in] val The unsigned integer value.
+    @return The number of memory blocks.
     */
-    /*explicit*/ Value(UInt8 val)
-        : m_type(TYPE_INTEGER)
+    size_t getBlockCount() const
     {
-        m_val.u = val;
+        return m_blockCount;
     }
 
+private:
 
-    /// @brief Construct the integer value (16 bits).
+    /// @brief Align the size.
     /**
-    @param[in] val The signed integer value.
+    @param[in] size The size in bytes.
+    @return The size rounded up to the max alignment.
     */
-    /*explicit*/ Value(Int16 val)
-        : m_type(TYPE_INTEGER)
+    static size_t align(size_t size)
     {
-        m_val.i = val;
+        return (size + ALIGNMENT-1) & ~size_t(ALIGNMENT-1);
     }
 
 
-    /// @brief Construct the integer value (16 bits).
+    /// @brief Allocate the memory from a new block.
     /**
-    @param[in] val The unsigned integer value.
+    The big requests get the dedicated block,
+    so the current block is still used for small requests.
+
+    @param[in] size The aligned number of bytes to allocate.
+    @return The allocated memory.
     */
-    /*explicit*/ Value(UInt16 val)
-        : m_type(TYPE_INTEGER)
+    void* allocateBlock(size_t size)
     {
-        m_val.u = val;
+        const size_t MAX_BLOCK_SIZE = 1024*1024;
+        const bool dedicated = (m_blockSize/4 < size) && m_blocks;
+        const size_t len = dedicated ? size : std::max(size, m_blockSize);
+
+        Block *b = static_cast<Block*>(::operator new(align(sizeof(Block)) + len));
+        char *data = reinterpret_cast<char*>(b) + align(sizeof(Block));
+        m_blockCount += 1;
+        b->size = len;
+
+        if (dedicated) // insert after the current block
+        {
+            b->next = m_blocks->next;
+            m_blocks->next = b;
+            return data;
+        }
+
+        b->next = m_blocks;
+        m_blocks = b;
+        m_ptr = data + size;
+        m_end = data + len;
+        if (m_blockSize < MAX_BLOCK_SIZE)
+            m_blockSize *= 2;
+        return data;
     }
 
+private:
 
-    /// @brief Construct the integer value (32 bits).
+    /// @brief The max alignment.
+    enum { ALIGNMENT = 16 };
+
+    /// @brief The memory block header.
+    struct Block
+    {
+        Block *next; ///< @brief The next block.
+        size_t size; ///< @brief The block data size.
+    };
+
+    Block *m_blocks; ///< @brief The list of blocks, current is the first.
+    char *m_ptr; ///< @brief The free memory of the current block.
+    char *m_end; ///< @brief The end of the current block.
+    size_t m_blockSize; ///< @brief The next block size.
+    size_t m_blockCount; ///< @brief The number of blocks.
+};
+
+
+/// @brief The arena allocator.
+/**
+This is standard allocator which uses Arena if provided
+or the global `new` and `delete` operators otherwise.
+The memory is never freed back to the arena.
+
+@see Arena
+*/
+template<typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type; ///< @brief The value type.
+    typedef T* pointer; ///< @brief The pointer type.
+    typedef T const* const_pointer; ///< @brief The constant pointer type.
+    typedef T& reference; ///< @brief The reference type.
+    typedef T const& const_reference; ///< @brief The constant reference type.
+    typedef size_t size_type; ///< @brief The size type.
+    typedef ptrdiff_t difference_type; ///< @brief The difference type.
+
+    /// @brief Get the allocator for another type.
+    template<typename U>
+    struct rebind
+    {
+        typedef ArenaAllocator<U> other; ///< @brief The allocator type.
+    };
+
+public:
+
+    /// @brief The main constructor.
     /**
-    @param[in] val The signed integer value.
+    @param[in] arena The arena to allocate from. May be NULL.
     */
-    /*explicit*/ Value(Int32 val)
-        : m_type(TYPE_INTEGER)
-    {
-        m_val.i = val;
-    }
+    explicit ArenaAllocator(Arena *arena = 0)
+        : m_arena(arena)
+    {}
 
 
-    /// @brief Construct the integer value (32 bits).
+    /// @brief Construct from allocator for another type.
     /**
-    @param[in] val The unsigned integer value.
+    @param[in] other The other allocator.
     */
-    /*explicit*/ Value(UInt32 val)
-        : m_type(TYPE_INTEGER)
-    {
-        m_val.u = val;
-    }
+    template<typename U>
+    ArenaAllocator(ArenaAllocator<U> const& other)
+        : m_arena(other.getArena())
+    {}
 
 
-    /// @brief Construct the integer value (64 bits).
+    /// @brief Get the arena.
     /**
-    @param[in] val The signed integer value.
+    @return The arena or NULL.
     */
-    /*explicit*/ Value(Int64 val)
-        : m_type(TYPE_INTEGER)
+    Arena* getArena() const
     {
-        m_val.i = val;
+        return m_arena;
     }
 
+public:
 
-    /// @brief Construct the integer value (64 bits).
-    /**
-    @param[in] val The unsigned integer value.
-    */
-    /*explicit*/ Value(UInt64 val)
-        : m_type(TYPE_INTEGER)
+    /// @brief Get the object address.
+    pointer address(reference x) const
     {
-        m_val.u = val;
+        return &x;
     }
 
 
-    /// @brief Construct the floating-point value.
-    /**
-    @param[in] val The floating-point value.
-    */
-    /*explicit*/ Value(double val)
-        : m_type(TYPE_DOUBLE)
+    /// @brief Get the object address (read-only).
+    const_pointer address(const_reference x) const
     {
-        m_val.f = val;
+        return &x;
     }
 
 
-    /// @brief Construct the floating-point value.
-    /**
-    @param[in] val The floating-point value.
-    */
-    /*explicit*/ Value(float val)
-        : m_type(TYPE_DOUBLE)
+    /// @brief Allocate memory for @a n objects.
+    pointer allocate(size_type n, const void* = 0)
     {
-        m_val.f = val;
+        if (max_size() < n)
+            throw std::bad_alloc();
+
+        const size_t len = n*sizeof(T);
+        return static_cast<pointer>(m_arena
+            ? m_arena->allocate(len)
+            : ::operator new(len));
     }
 
 
-    /// @brief Construct the string value.
-    /**
-    @param[in] val The string value.
-    */
-    /*explicit*/ Value(const char* val)
-        : m_type(TYPE_STRING)
-        , m_str(val)
+    /// @brief Deallocate memory.
+    void deallocate(pointer p, size_type)
     {
-        m_val.u = 0; // avoid garbage
+        if (!m_arena)
+            ::operator delete(p);
     }
 
 
-    /// @brief Constring the string value.
-    /**
-    @param[in] val The string value.
-    */
-    /*explicit*/ Value(String const& val)
-        : m_type(TYPE_STRING)
-        , m_str(val)
+    /// @brief Get the maximum number of objects.
+    size_type max_size() const
     {
-        m_val.u = 0; // avoid garbage
+        return size_t(-1)/sizeof(T);
     }
-/// @}
 
 
-/// @name Copy, move and swap
-/// @{
+    /// @brief Construct the object.
+    void construct(pointer p, const_reference val)
+    {
+        new (static_cast<void*>(p)) T(val);
+    }
+
+#if defined(HIVE_HAS_RVALUE_REFS)
+    /// @brief Construct the object (move).
+    void construct(pointer p, T && val)
+    {
+        new (static_cast<void*>(p)) T(std::move(val));
+    }
+#endif // defined(HIVE_HAS_RVALUE_REFS)
+
+
+    /// @brief Destroy the object.
+    void destroy(pointer p)
+    {
+        p->~T();
+    }
+
+private:
+    Arena *m_arena; ///< @brief The arena or NULL.
+};
+
+
+/// @brief Are two allocators equal?
+/** @relates ArenaAllocator
+@return `true` if both allocators use the same arena.
+*/
+template<typename T, typename U> inline
+bool operator==(ArenaAllocator<T> const& a, ArenaAllocator<U> const& b)
+{
+    return a.getArena() == b.getArena();
+}
+
+
+/// @brief Are two allocators different?
+/** @relates ArenaAllocator
+@return `true` if allocators use different arenas.
+*/
+template<typename T, typename U> inline
+bool operator!=(ArenaAllocator<T> const& a, ArenaAllocator<U> const& b)
+{
+    return a.getArena() != b.getArena();
+}
+
+
+/// @brief The non-owning string reference.
+/**
+This class refers to the string data owned by someone else:
+by the JSON value, by the `std::string` or by the string literal.
+The referenced data is not NULL-terminated.
+
+The reference is valid while the owner exists and is not changed.
+*/
+class StringRef
+{
 public:
+    typedef const char* const_iterator; ///< @brief The iterator type.
 
-    /// @brief The copy-constructor.
+public:
+
+    /// @brief The default constructor.
     /**
-    @param[in] other The other value to copy.
+    Refers to the empty string.
     */
-    Value(Value const& other)
-        : m_type(other.m_type)
-        , m_val(other.m_val)
-        , m_str(other.m_str)
-        , m_arr(other.m_arr)
-        , m_obj(other.m_obj)
+    StringRef()
+        : m_data("")
+        , m_size(0)
     {}
 
 
-    /// @brief The copy assignment.
+    /// @brief Refer to the data.
     /**
-    @param[in] other The other value to copy.
-    @return The self reference.
+    @param[in] data The string data.
+    @param[in] size The string data size in bytes.
     */
-    Value& operator=(Value const& other)
-    {
-        Value tmp(other);
-        swap(tmp);
-        return *this;
-    }
+    StringRef(const char *data, size_t size)
+        : m_data(data)
+        , m_size(size)
+    {}
 
 
-    /// @brief Swap the two values.
+    /// @brief Refer to the NULL-terminated string.
     /**
-    Swap content of two values.
-
-    @param[in,out] other The value to swap.
+    @param[in] str The NULL-terminated string.
     */
-    void swap(Value &other)
-    {
-        std::swap(m_type, other.m_type);
-        std::swap(m_val, other.m_val);
-        std::swap(m_str, other.m_str);
-        std::swap(m_arr, other.m_arr);
-        std::swap(m_obj, other.m_obj);
-    }
+    /*explicit*/ StringRef(const char *str)
+        : m_data(str)
+        , m_size(strlen(str))
+    {}
 
-#if defined(HIVE_HAS_RVALUE_REFS)
 
-    /// @brief The move-constructor.
+    /// @brief Refer to the standard string.
     /**
-    @param[in] other The other value to move.
+    @param[in] str The standard string.
     */
-    Value(Value && other)
-        : m_type(other.m_type)
-        , m_val(other.m_val)
-        , m_str(std::move(other.m_str))
-        , m_arr(std::move(other.m_arr))
-        , m_obj(std::move(other.m_obj))
+    /*explicit*/ StringRef(String const& str)
+        : m_data(str.data())
+        , m_size(str.size())
     {}
 
+public:
 
-    /// @brief The move assignment.
+    /// @brief Get the string data.
     /**
-    @param[in] other The other value to copy.
-    @return The self reference.
+    @return The string data, not NULL-terminated.
     */
-    Value& operator=(Value && other)
+    const char* data() const
     {
-        if (this != &other)
-            swap(other);
-        return *this;
+        return m_data;
     }
 
-#endif // defined(HIVE_HAS_RVALUE_REFS)
-/// @}
-
-public:
 
-    /// @brief Get the NULL value.
+    /// @brief Get the string size.
     /**
-    This static value is used to indicate the NULL value references.
-
-    @return The NULL value static reference.
+    @return The string size in bytes.
     */
-    static Value const& null()
+    size_t size() const
     {
-        static Value N;
-        return N;
+        return m_size;
     }
 
 
-/// @name Type checks
-/// @{
-public:
-
-    /// @brief Get the value type.
+    /// @brief Is the string empty?
     /**
-    @return The value type.
+    @return `true` if the string is empty.
     */
-    Type getType() const
+    bool empty() const
     {
-        return m_type;
+        return 0 == m_size;
     }
 
 
-    /// @brief Is the value NULL?
+    /// @brief Get the character.
     /**
-    @return `true` if the value is NULL.
+    @param[in] i The character index.
+    @return The character.
     */
-    bool isNull() const
+    char operator[](size_t i) const
     {
-        return (TYPE_NULL == m_type);
+        assert(i < m_size && "index out of range");
+        return m_data[i];
     }
 
 
-    /// @copydoc isNull()
-    bool operator!() const
+    /// @brief Get the begin of string.
+    /**
+    @return The begin iterator.
+    */
+    const_iterator begin() const
     {
-        return isNull();
+        return m_data;
     }
 
 
-    /// @brief Is the value boolean?
+    /// @brief Get the end of string.
     /**
-    @return `true` if the value is boolean.
+    @return The end iterator.
     */
-    bool isBool() const
+    const_iterator end() const
     {
-        return (TYPE_BOOLEAN == m_type);
+        return m_data + m_size;
     }
 
 
-    /// @brief Is the value integer?
+    /// @brief Copy to the standard string.
     /**
-    @return `true` if the value is integer.
+    @return The string copy.
     */
-    bool isInteger() const
+    String str() const
     {
-        return (TYPE_INTEGER == m_type);
+        return String(m_data, m_size);
     }
 
+public:
 
-    /// @brief Is the value floating-point?
+    /// @brief Is equal to the other string?
     /**
-    @return `true` if the value if floating-point.
+    @param[in] other The other string to compare.
+    @return `true` if both strings have the same content.
     */
-    bool isDouble() const
+    bool equal(StringRef const& other) const
     {
-        return (TYPE_DOUBLE == m_type);
+        return m_size == other.m_size
+            && (m_data == other.m_data
+             || 0 == memcmp(m_data, other.m_data, m_size));
     }
 
+private:
+    const char *m_data; ///< @brief The string data.
+    size_t m_size; ///< @brief The string size in bytes.
+};
+
 
-    /// @brief Is the value string?
+/// @brief Are two strings equal?
+/** @relates StringRef
+@param[in] a The first string.
+@param[in] b The second string.
+@return `true` if two strings are equal.
+*/
+inline bool operator==(StringRef const& a, StringRef const& b)
+{
+    return a.equal(b);
+}
+
+
+/// @brief Are two strings different?
+/** @relates StringRef
+@param[in] a The first string.
+@param[in] b The second string.
+@return `true` if two strings are different.
+*/
+inline bool operator!=(StringRef const& a, StringRef const& b)
+{
+    return !a.equal(b);
+}
+
+
+/// @brief Write the string to the output stream.
+/** @relates StringRef
+@param[in,out] os The output stream.
+@param[in] str The string to write.
+@return The output stream.
+*/
+inline OStream& operator<<(OStream &os, StringRef const& str)
+{
+    return os.write(str.data(), str.size());
+}
+
+
+/// @brief The member name table.
+/**
+This table keeps one copy of each distinct member name (interning).
+The JSON values still own their member names, but these names
+are copied from the table:
+    - with reference-counted `std::string` implementations the copies
+      share the same buffer, so repeated member names like "id"
+      or "parameters" take no extra memory and no allocation
+    - member name comparison checks the buffer address first,
+      so the equal shared names are compared without `memcmp()`
+
+If #HIVE_JSON_INTERNED_KEYS macro is defined, the global() table
+is used by ValueBuilder (and so by Parser) and by Value::operator[] on string literals.
+
+The table never removes names, so it's useful for the fixed set of member names.
+The parsed member names are interned by tryIntern() which respects
+the table limits: data-driven names (for example arbitrary command
+parameters) stop being interned once the table is full, so memory
+of a long-running application doesn't grow forever.
+Clearing the table doesn't affect existing JSON values.
+*/
+class KeyTable:
+    private NonCopyable
+{
+public:
+
+    /// @brief The default limits.
+    enum
+    {
+        DEFAULT_MAX_KEYS = 4096,      ///< @brief The default maximum number of names.
+        DEFAULT_MAX_KEY_LENGTH = 64   ///< @brief The default maximum name length in bytes.
+    };
+
+
+    /// @brief The main constructor.
     /**
-    @return `true` if the value is string.
+    @param[in] maxKeys The maximum number of names interned by tryIntern().
+    @param[in] maxKeyLength The maximum name length interned by tryIntern().
     */
-    bool isString() const
-    {
-        return (TYPE_STRING == m_type);
-    }
+    explicit KeyTable(size_t maxKeys = DEFAULT_MAX_KEYS,
+                      size_t maxKeyLength = DEFAULT_MAX_KEY_LENGTH)
+        : m_maxKeys(maxKeys)
+        , m_maxKeyLength(maxKeyLength)
+    {}
 
+public:
 
-    /// @brief Is the value array or NULL?
+    /// @brief Intern the member name.
     /**
-    @return `true` if the value is array or NULL.
+    @param[in] name The member name.
+    @param[in] len The member name length in bytes.
+    @return The interned member name.
     */
-    bool isArray() const
+    String const& intern(const char *name, size_t len)
     {
-        return (TYPE_NULL == m_type) || (TYPE_ARRAY == m_type);
+        const UInt32 h = hash(name, len);
+        const size_t k = indexOf(name, len, h);
+        if (k < m_keys.size())
+            return m_keys[k];
+
+        if (m_slots.size() < 2*(m_keys.size() + 1))
+            rehash(std::max(size_t(64), 2*m_slots.size()));
+
+        m_keys.push_back(String(name, len));
+        m_hashes.push_back(h);
+        insert(m_keys.size() - 1);
+        return m_keys.back();
     }
 
 
-    /// @brief Is the value object or NULL?
+    /// @brief Intern the member name.
     /**
-    @return `true` if the value is object or NULL.
+    @param[in] name The member name.
+    @return The interned member name.
     */
-    bool isObject() const
+    String const& intern(String const& name)
     {
-        return (TYPE_NULL == m_type) || (TYPE_OBJECT == m_type);
+        return intern(name.data(), name.size());
     }
 
 
-    /// @brief Is the value convertible to the other type?
+    /// @brief Intern the member name if the limits allow.
     /**
-    See @ref hive_json_value_conv for all possible conversions.
+    The name already interned is always found. The new name is interned
+    only if it's not too long and the table is not full.
 
-    @param[in] type The type convert to.
-    @return `true` if the value is convertible.
-    @see asBool()
-    @see asInt()
-    @see asUInt()
-    @see asDouble()
-    @see asString()
+    @param[in] name The member name.
+    @param[in] len The member name length in bytes.
+    @return The interned member name or `0` if the name is not interned.
     */
-    bool isConvertibleTo(Type type) const
+    String const* tryIntern(const char *name, size_t len)
     {
-        switch (m_type)
-        {
-            case TYPE_NULL: // NULL -> ...
-                return true;
-
-            case TYPE_BOOLEAN: // boolean -> ...
-                return (TYPE_NULL == type && !m_val.u)
-                    || (TYPE_BOOLEAN == type)
-                    || (TYPE_INTEGER == type)
-                    || (TYPE_DOUBLE == type)
-                    || (TYPE_STRING == type);
-
-            case TYPE_INTEGER: // integer -> ...
-                return (TYPE_NULL == type &&  !m_val.u)
-                    || (TYPE_BOOLEAN == type)
-                    || (TYPE_INTEGER == type)
-                    || (TYPE_DOUBLE == type)
-                    || (TYPE_STRING == type);
+        if (String const* key = find(name, len))
+            return key;
+        if (m_maxKeyLength < len || m_maxKeys <= m_keys.size())
+            return 0; // limits exceeded
 
-            case TYPE_DOUBLE: // double -> ...
-                return (TYPE_NULL == type && m_val.f != 0.0)
-                    || (TYPE_BOOLEAN == type)
-                    || (TYPE_INTEGER == type)
-                    || (TYPE_DOUBLE == type)
-                    || (TYPE_STRING == type);
+        return &intern(name, len);
+    }
 
-            case TYPE_STRING: // string -> ...
-                if (TYPE_BOOLEAN == type) // -> boolean
-                {
-                    return m_str.empty()
-                        || m_str=="false"
-                        || m_str=="true";
-                }
-                else if (TYPE_INTEGER == type) // -> integer
-                {
-                    const size_t N = m_str.size();
-                    if (0 < N)
-                    {
-                        size_t i = 0;
 
-                        // ignore leading '+' or '-'
-                        if ('+'==m_str[i] || '-'==m_str[i])
-                        {
-                            if (N == ++i)
-                                return false; // one sign isn't allowed
-                        }
+    /// @brief Find the interned member name.
+    /**
+    @param[in] name The member name.
+    @param[in] len The member name length in bytes.
+    @return The interned member name or `0` if not found.
+    */
+    String const* find(const char *name, size_t len) const
+    {
+        const size_t k = indexOf(name, len, hash(name, len));
+        return (k < m_keys.size()) ? &m_keys[k] : 0;
+    }
 
-                        for (; i < N; ++i)
-                            if (!misc::is_digit(m_str[i]))
-                                return false;
-                    }
 
-                    return true;
-                }
-                else if (TYPE_DOUBLE == type) // -> double
-                {
-                    const size_t N = m_str.size();
-                    if (0 < N)
-                    {
-                        // TODO: check m_str is double
-                        IStringStream iss(m_str);
-                        double val = 0.0;
-                        if (!(iss >> val))
-                            return false;
-                    }
+    /// @brief Get the number of interned member names.
+    size_t size() const
+    {
+        return m_keys.size();
+    }
 
-                    return true;
-                }
-                else
-                    return (TYPE_NULL == type && m_str.empty())
-                        || (TYPE_STRING == type);
 
-            case TYPE_ARRAY:
-                return (TYPE_NULL == type && m_arr.empty())
-                    || (TYPE_ARRAY == type);
+    /// @brief Remove all member names.
+    void clear()
+    {
+        m_keys.clear();
+        m_hashes.clear();
+        m_slots.clear();
+    }
 
-            case TYPE_OBJECT:
-                return (TYPE_NULL == type && m_obj.empty())
-                    || (TYPE_OBJECT == type);
-        }
+#if defined(HIVE_JSON_INTERNED_KEYS)
+public:
 
-        return false; // no conversion
+    /// @brief Get the global table.
+    /**
+    @warning The global table is not thread-safe.
+    @return The global table.
+    */
+    static KeyTable& global()
+    {
+        static KeyTable table;
+        return table;
     }
-/// @}
+#endif // HIVE_JSON_INTERNED_KEYS
 
 public:
 
-    /// @brief Convert value to the boolean.
+    /// @brief Calculate the member name hash.
     /**
-    @return The boolean value.
-    @throw error::CastError if cannot convert.
-    @see @ref hive_json_value_conv
+    The FNV-1a hash function is used.
+
+    @param[in] name The member name.
+    @param[in] len The member name length in bytes.
+    @return The hash value.
     */
-    bool asBool() const
+    static UInt32 hash(const char *name, size_t len)
     {
-        switch (m_type)
+        UInt32 h = 2166136261U;
+        for (size_t i = 0; i < len; ++i)
         {
-            case TYPE_NULL:
-                return false; // NULL as false
-
-            case TYPE_BOOLEAN:
-            case TYPE_INTEGER: // true as non-zero
-                return (0 != m_val.u);
+            h ^= UInt8(name[i]);
+            h *= 16777619U;
+        }
+        return h;
+    }
 
-            case TYPE_DOUBLE: // true as non-zero
-                return (0.0 != m_val.f); // exactly!
+private:
 
-            case TYPE_STRING:
-                if (!m_str.empty())
-                {
-                    if (m_str == "true")
-                        return true;
-                    else if (m_str == "false")
-                        return false;
-                    else
-                        break; // will throw
-                }
-                else
-                    return false; // false if empty
+    /// @brief Find the member name index.
+    /**
+    @param[in] name The member name.
+    @param[in] len The member name length in bytes.
+    @param[in] h The member name hash.
+    @return The member name index or size() if not found.
+    */
+    size_t indexOf(const char *name, size_t len, UInt32 h) const
+    {
+        const size_t N = m_keys.size();
+        if (m_slots.empty())
+            return N;
 
-            case TYPE_ARRAY:
-            case TYPE_OBJECT:
-                break; // no conversion
+        const size_t mask = m_slots.size() - 1;
+        for (size_t i = h&mask; m_slots[i]; i = (i+1)&mask)
+        {
+            const size_t k = m_slots[i] - 1;
+            String const& key = m_keys[k];
+            if (m_hashes[k] == h && key.size() == len
+                && (key.data() == name || 0 == memcmp(key.data(), name, len)))
+                    return k;
         }
 
-        // TODO: detail information about value type?
-        throw error::CastError("cannot convert to boolean");
+        return N; // not found
     }
 
 
-    /// @brief Convert value to the signed integer.
+    /// @brief Insert the member name index into the hash table.
     /**
-    @return The signed integer value.
-    @throw error::CastError if cannot convert.
-    @see @ref hive_json_value_conv
+    @param[in] k The member name index.
     */
-    Int64 asInt() const
+    void insert(size_t k)
     {
-        switch (m_type)
-        {
-            case TYPE_NULL:
-                return 0; // NULL as zero
+        const size_t mask = m_slots.size() - 1;
+        size_t i = m_hashes[k]&mask;
+        while (m_slots[i])
+            i = (i+1)&mask;
+        m_slots[i] = k + 1;
+    }
 
-            case TYPE_BOOLEAN:
-            case TYPE_INTEGER:
-                return m_val.i;
 
-            case TYPE_DOUBLE:
-                return Int64(m_val.f);
+    /// @brief Resize the hash table.
+    /**
+    @param[in] n The new hash table size, power of two.
+    */
+    void rehash(size_t n)
+    {
+        std::vector<size_t>(n, 0).swap(m_slots);
+        for (size_t k = 0; k < m_keys.size(); ++k)
+            insert(k);
+    }
 
-            case TYPE_STRING:
-            {
-                if (!m_str.empty())
-                {
-                    if (isConvertibleTo(TYPE_INTEGER))
-                    {
-                        IStringStream iss(m_str);
-                        Int64 val = 0;
-                        if (iss >> val)
-                            return val;
-                    }
-                }
-                else
-                    return 0;
-            } break;
+private:
+    std::deque<String> m_keys; ///< @brief The member names, stable addresses.
+    std::vector<UInt32> m_hashes; ///< @brief The member name hashes.
+    std::vector<size_t> m_slots; ///< @brief The hash table: index+1 or zero if empty.
+    size_t m_maxKeys; ///< @brief The maximum number of names interned by tryIntern().
+    size_t m_maxKeyLength; ///< @brief The maximum name length interned by tryIntern().
+};
 
-            case TYPE_ARRAY:
-            case TYPE_OBJECT:
-                break; // no conversion
-        }
 
-        // TODO: detail information about value type?
-        throw error::CastError("cannot convert to integer");
-    }
+/// @brief The flat JSON object.
+/**
+This is an alternative to `std::map` used as JSON object storage
+if #HIVE_JSON_FLAT_OBJECTS macro is defined.
 
+All members are stored in one contiguous array in insertion order.
+The member name hashes are stored in a separate array, so the member
+lookup is a linear scan over integers and the member name is compared
+only if hashes are equal. For typical small objects (a few tens of
+members) it's faster than tree walk and there is no any per-member
+heap node.
 
-    /// @brief Convert value to the unsigned integer.
-    /**
-    @return The unsigned integer value.
-    @throw error::CastError if cannot convert.
-    @see @ref hive_json_value_conv
-    */
-    UInt64 asUInt() const
-    {
-        switch (m_type)
-        {
-            case TYPE_NULL:
-                return 0; // NULL as zero
+Only the subset of `std::map` interface used by Value is provided.
 
-            case TYPE_BOOLEAN:
-            case TYPE_INTEGER:
-                return m_val.u;
+@warning The members are iterated in insertion order, not sorted.
+*/
+template<typename T, typename A = std::allocator< std::pair<String, T> > >
+class FlatObject
+{
+public:
+    typedef String key_type; ///< @brief The member name type.
+    typedef T mapped_type; ///< @brief The member value type.
+    typedef std::pair<String, T> value_type; ///< @brief The member type.
+    typedef std::less<String> key_compare; ///< @brief Not used, for compatibility only.
+    typedef A allocator_type; ///< @brief The allocator type.
 
-            case TYPE_DOUBLE:
-                return UInt64(m_val.f);
+private:
+    typedef std::vector<value_type, A> Members; ///< @brief The members container.
+    typedef std::vector<UInt32, typename A::template rebind<UInt32>::other> Hashes; ///< @brief The hashes container.
 
-            case TYPE_STRING:
-            {
-                if (!m_str.empty())
-                {
-                    if (isConvertibleTo(TYPE_INTEGER))
-                    {
-                        IStringStream iss(m_str);
-                        Int64 val = 0;
-                        if (iss >> val)
-                            return val;
-                    }
-                }
-                else
-                    return 0;
-            } break;
+public:
 
-            case TYPE_ARRAY:
-            case TYPE_OBJECT:
-                break; // no conversion
-        }
+    /// @brief The members iterator.
+    typedef typename Members::iterator iterator;
 
-        // TODO: detail information about value type?
-        throw error::CastError("cannot convert to integer");
-    }
+    /// @brief The members iterator (read-only).
+    typedef typename Members::const_iterator const_iterator;
 
+public:
 
-    /// @brief Convert value to the floating-point.
+    /// @brief The default constructor.
     /**
-    @return The floating-point value.
-    @throw error::CastError if cannot convert.
-    @see @ref hive_json_value_conv
+    @param[in] alloc The allocator.
     */
-    double asDouble() const
+    explicit FlatObject(key_compare const& = key_compare(), A const& alloc = A())
+        : m_members(alloc),
+          m_hashes(alloc)
+    {}
+
+
+    /// @brief Construct from the range of members.
+    /**
+    @param[in] first The begin of members.
+    @param[in] last The end of members.
+    */
+    template<typename In>
+    FlatObject(In first, In last)
+        : m_members(first, last)
     {
-        switch (m_type)
-        {
-            case TYPE_NULL:
-                return 0.0;
+        m_hashes.reserve(m_members.size());
+        for (size_t i = 0; i < m_members.size(); ++i)
+            m_hashes.push_back(hash(m_members[i].first));
+    }
 
-            case TYPE_BOOLEAN:
-            case TYPE_INTEGER:
-                return double(m_val.i);
+public:
 
-            case TYPE_DOUBLE:
-                return m_val.f;
+    /// @brief Get the begin of members.
+    iterator begin()
+    {
+        return m_members.begin();
+    }
 
-            case TYPE_STRING:
-            {
-                if (!m_str.empty())
-                {
-                    IStringStream iss(m_str);
-                    double val = 0.0;
-                    if (iss >> val)
-                        return val;
-                }
-                else
-                    return 0.0;
-            } break;
+    /// @brief Get the end of members.
+    iterator end()
+    {
+        return m_members.end();
+    }
 
-            case TYPE_ARRAY:
-            case TYPE_OBJECT:
-                break; // no conversion
-        }
+    /// @brief Get the begin of members (read-only).
+    const_iterator begin() const
+    {
+        return m_members.begin();
+    }
 
-        // TODO: detail information about value type?
-        throw error::CastError("cannot convert to floating-point");
+    /// @brief Get the end of members (read-only).
+    const_iterator end() const
+    {
+        return m_members.end();
     }
 
+public:
 
-    /// @brief Convert value to the string.
-    /**
-    @return The floating-point value.
-    @throw error::CastError if cannot convert.
-    @see @ref hive_json_value_conv
-    */
-    String asString() const
+    /// @brief Get the number of members.
+    size_t size() const
     {
-        switch (m_type)
-        {
-            case TYPE_NULL:
-                return String(); // NULL as empty string
+        return m_members.size();
+    }
 
-            case TYPE_BOOLEAN:
-                return m_val.u ? "true" : "false";
 
-            case TYPE_INTEGER:
-            {
-                OStringStream oss;
-                oss << m_val.i;
-                return oss.str();
-            }
+    /// @brief Is object empty?
+    bool empty() const
+    {
+        return m_members.empty();
+    }
 
-            case TYPE_DOUBLE:
-            {
-                OStringStream oss;
-                oss << m_val.f; // default format
-                return oss.str();
-            }
 
-            case TYPE_STRING:
-                return m_str;
+    /// @brief Remove all members.
+    void clear()
+    {
+        m_members.clear();
+        m_hashes.clear();
+    }
 
-            case TYPE_ARRAY:
-            case TYPE_OBJECT:
-                break; // no conversion
-        }
 
-        // TODO: detail information about value type?
-        throw error::CastError("cannot convert to string");
+    /// @brief Reserve space for members.
+    /**
+    @param[in] n The expected number of members.
+    */
+    void reserve(size_t n)
+    {
+        m_members.reserve(n);
+        m_hashes.reserve(n);
     }
 
 public:
 
-    /// @brief Is equal to the other value?
+    /// @brief Find the member by name.
     /**
-    The two values are equal if they have the same type
-    and exactly the same content.
-
-    @param[in] other The other value to compare.
-    @return `true` if value is equal to the other.
+    @param[in] name The member name.
+    @return The member iterator or end().
     */
-    bool equal(Value const& other) const
+    iterator find(String const& name)
     {
-        // different types
-        if (m_type != other.m_type)
-            return false;
+        return m_members.begin() + indexOf(name, hash(name));
+    }
 
-        // the same type
-        switch (m_type)
-        {
-            case TYPE_NULL:
-                return true;
 
-            case TYPE_BOOLEAN:
-            case TYPE_INTEGER:
-                return m_val.u == other.m_val.u;
+    /// @brief Find the member by name (read-only).
+    /**
+    @param[in] name The member name.
+    @return The member iterator or end().
+    */
+    const_iterator find(String const& name) const
+    {
+        return m_members.begin() + indexOf(name, hash(name));
+    }
 
-            case TYPE_DOUBLE:
-                return m_val.f == other.m_val.f;
 
-            case TYPE_STRING:
-                return m_str == other.m_str;
+    /// @brief Find the member by name and precalculated hash (read-only).
+    /**
+    @param[in] name The member name.
+    @param[in] h The member name hash, see hash().
+    @return The member iterator or end().
+    */
+    const_iterator find(String const& name, UInt32 h) const
+    {
+        return m_members.begin() + indexOf(name, h);
+    }
 
-            case TYPE_ARRAY:
-                return m_arr.size() == other.m_arr.size()
-                    && std::equal(m_arr.begin(), m_arr.end(),
-                            other.m_arr.begin());
 
-            case TYPE_OBJECT:
-                return m_obj.size() == other.m_obj.size()
-                    && std::equal(m_obj.begin(), m_obj.end(),
-                            other.m_obj.begin());
-        }
+    /// @brief Get the member by name or create new one.
+    /**
+    New member is appended to the end.
 
-        return false;
+    @param[in] name The member name.
+    @return The member value.
+    */
+    T& operator[](String const& name)
+    {
+        const UInt32 h = hash(name);
+        const size_t i = indexOf(name, h);
+        if (i < m_members.size())
+            return m_members[i].second;
+
+        if (m_members.size() == m_members.capacity())
+            grow();
+        m_hashes.reserve(m_hashes.size() + 1); // strong guarantee
+        m_members.push_back(value_type(name, T()));
+        m_hashes.push_back(h);
+        return m_members.back().second;
     }
 
-public: // array & object
 
-    /// @brief Get the number of elements in array or object.
+    /// @brief Remove the member by name.
     /**
-    For all other types returns zero.
+    The order of remaining members is preserved.
 
-    @return The number of array elements or the number of members.
+    @param[in] name The member name.
+    @return The number of removed members: `0` or `1`.
     */
-    size_t size() const
+    size_t erase(String const& name)
     {
-        switch (m_type)
-        {
-            case TYPE_ARRAY:
-                return m_arr.size();
-
-            case TYPE_OBJECT:
-                return m_obj.size();
+        const size_t i = indexOf(name, hash(name));
+        if (i == m_members.size())
+            return 0;
 
-            default:
-                break;
-        }
-
-        return 0; // otherwise
+        m_members.erase(m_members.begin() + i);
+        m_hashes.erase(m_hashes.begin() + i);
+        return 1;
     }
 
 
-    /// @brief Is value empty?
+    /// @brief Swap two objects.
     /**
-    @return `true` if array is empty, object is empty, or value is NULL.
+    @param[in,out] other The object to swap with.
     */
-    bool empty() const
+    void swap(FlatObject &other)
     {
-        switch (m_type)
-        {
-            case TYPE_NULL:
-                return true;
-
-            //case TYPE_STRING:
-            //    return m_str.empty();
-
-            case TYPE_ARRAY:
-                return m_arr.empty();
-
-            case TYPE_OBJECT:
-                return m_obj.empty();
-
-            default:
-                break;
-        }
-
-        return false; // otherwise
+        m_members.swap(other.m_members);
+        m_hashes.swap(other.m_hashes);
     }
 
 
-    /// @brief Remove all object members or array elements.
-    void clear()
-    {
-        switch (m_type)
-        {
-            //case TYPE_STRING:
-            //    m_str.clear();
-            //    break;
-
-            case TYPE_ARRAY:
-                m_arr.clear();
-                break;
+    /// @brief Are two objects equal?
+    /**
+    The members order is ignored.
 
-            case TYPE_OBJECT:
-                m_obj.clear();
-                break;
+    @param[in] other The object to compare with.
+    @return `true` if both objects have the same members.
+    */
+    bool equal(FlatObject const& other) const
+    {
+        const size_t N = m_members.size();
+        if (N != other.m_members.size())
+            return false;
 
-            default:
-                break;
+        for (size_t i = 0; i < N; ++i)
+        {
+            value_type const& m = m_members[i];
+            const size_t k = (m_hashes[i] == other.m_hashes[i]
+                && m.first == other.m_members[i].first) ? i // same order
+                : other.indexOf(m.first, m_hashes[i]);
+            if (k == N || !(m.second == other.m_members[k].second))
+                return false;
         }
+
+        return true;
     }
 
-/// @name Array
-/// @{
 public:
 
-    /// @brief Resize the array.
+    /// @brief Calculate the member name hash.
     /**
-    This method changes value type to TYPE_ARRAY.
-
-    New array elements initialized to @a def values, NULL by default.
+    The FNV-1a hash function is used.
 
-    @param[in] size The new array size.
-    @param[in] def The default value to fill array.
+    @param[in] name The member name.
+    @return The hash value.
     */
-    void resize(size_t size, Value const& def = Value())
+    static UInt32 hash(String const& name)
     {
-        assert(isArray() && "not an array");
-        if (m_type != TYPE_ARRAY)
-            m_type = TYPE_ARRAY;
-        m_arr.resize(size, def);
+        return KeyTable::hash(name.data(), name.size());
     }
 
+private:
 
-    /// @brief Get an array element.
+    /// @brief Grow the members storage.
     /**
-    @param[in] index The zero-based element index.
-    @return The array element reference.
+    The existing members are swapped to the new storage, not copied.
     */
-    Value& operator[](size_t index)
+    void grow()
     {
-        assert(isArray() && "not an array");
-        assert(index < m_arr.size()
-            && "index out of range");
-        return m_arr[index];
+        const size_t N = m_members.size();
+        Members tmp(m_members.get_allocator());
+        tmp.reserve(std::max(size_t(4), 2*N));
+        tmp.resize(N);
+        for (size_t i = 0; i < N; ++i)
+        {
+            tmp[i].first.swap(m_members[i].first);
+            tmp[i].second.swap(m_members[i].second);
+        }
+        m_members.swap(tmp);
     }
 
 
-    /// @brief Get an array element (read-only).
+    /// @brief Find the member index.
     /**
-    @param[in] index The zero-based element index.
-    @return The array element reference.
+    @param[in] name The member name.
+    @param[in] h The member name hash.
+    @return The member index or size() if not found.
     */
-    Value const& operator[](size_t index) const
+    size_t indexOf(String const& name, UInt32 h) const
     {
-        assert(isArray() && "not an array");
-        assert(index < m_arr.size()
-            && "index out of range");
-        return m_arr[index];
+        const size_t N = m_hashes.size();
+        for (size_t i = 0; i < N; ++i)
+        {
+            String const& key = m_members[i].first;
+            if (m_hashes[i] == h && (key.data() == name.data() || key == name))
+                return i;
+        }
+
+        return N; // not found
     }
 
+private:
+    Members m_members; ///< @brief The members.
+    Hashes m_hashes; ///< @brief The member name hashes.
+};
 
-    /// @brief Append value to array at the end.
+
+/// @brief Are two flat objects equal?
+/** @relates FlatObject
+@param[in] a The first object.
+@param[in] b The second object.
+@return `true` if both objects have the same members.
+*/
+template<typename T, typename A> inline
+bool operator==(FlatObject<T,A> const& a, FlatObject<T,A> const& b)
+{
+    return a.equal(b);
+}
+
+
+/// @brief The JSON value.
+/**
+The JSON value may be one of the following:
+    - NULL
+    - boolean
+    - integer
+    - double
+    - string
+    - array
+    - object
+
+The short strings (up to 8 bytes, like "OK" or "Online") are stored
+inline, without heap allocation. Use asStringRef() to read string
+content without copy.
+
+JSON conversions {#hive_json_value_conv}
+========================================
+
+Some of JSON values may be converted to the another. There is the conversion table:
+    - to boolean:
+        - from NULL is always converted as `false`
+        - zero integers as `false`, non-zero as `true`
+        - zero floating-point as `false`, non-zero as `true`
+        - empty string as `false`
+        - "false" string as `false`
+        - "true" string as `true`
+    - to integer:
+        - from NULL as `0`
+        - from boolean as `0` or `1`
+        - empty string as `0`
+        - from string parsed value
+    - to double:
+        - from NULL as `0.0`
+        - from boolean as `0.0` or `1.0`
+        - from integers
+        - empty string as `0.0`
+        - from string parsed value
+    - to string:
+        - from NULL as empty string
+        - from boolean as `"true"` or `"false"`
+        - from integers
+        - from floating-point
+    - to array:
+        - from NULL as empty array
+    - to object:
+        - from NULL as empty object
+*/
+class Value
+{
+public:
+
+    /// @brief The value type.
+    enum Type
+    {
+        TYPE_NULL,    ///< @brief The NULL value.
+        TYPE_BOOLEAN, ///< @brief The boolean value.
+        TYPE_INTEGER, ///< @brief The integer value.
+        TYPE_DOUBLE,  ///< @brief The floating-point value.
+        TYPE_STRING,  ///< @brief The string value.
+        TYPE_ARRAY,   ///< @brief The array value.
+        TYPE_OBJECT   ///< @brief The object value.
+    };
+
+/// @name Constructors
+/// @{
+public:
+
+    /// @brief The default constructor.
     /**
-    This method changes value type to TYPE_ARRAY.
+    This constructor may be used to make empty arrays or objects.
 
-    @param[in] jval The JSON value to append.
+    @param[in] type The value type (NULL by default).
     */
-    void append(Value const& jval)
+    explicit Value(Type type = TYPE_NULL)
+        : m_type(TYPE_NULL)
+        , m_inArena(false)
+        , m_shortSize(0)
+        , m_unsigned(false)
     {
-        assert(isArray() && "not an array");
-        if (m_type != TYPE_ARRAY)
-            m_type = TYPE_ARRAY;
-        m_arr.push_back(jval);
+        m_val.u = 0;
+        init(type);
     }
 
 
-    /// @brief The array elements iterator.
+    /// @brief Construct the boolean value.
     /**
-    This type is used to iterate all elements in array JSON value.
+    @param[in] val The boolean value.
     */
-    typedef std::vector<Value>::const_iterator ElementIterator;
+    /*explicit*/ Value(bool val)
+        : m_type(TYPE_BOOLEAN)
+        , m_inArena(false)
+        , m_shortSize(0)
+        , m_unsigned(false)
+    {
+        m_val.u = val?1:0;
+    }
 
 
-    /// @brief Get the begin of array.
+    /// @brief Construct the integer value (8 bits).
     /**
-    @return The begin of array.
+    @param[in] val The signed integer value.
     */
-    ElementIterator elementsBegin() const
+    /*explicit*/ Value(Int8 val)
+        : m_type(TYPE_INTEGER)
+        , m_inArena(false)
+        , m_shortSize(0)
+        , m_unsigned(false)
     {
-        assert(isArray() && "not an array");
-        return m_arr.begin();
+        m_val.i = val;
     }
 
 
-    /// @brief Get the end of array.
+    /// @brief Construct the integer value (8 bits).
     /**
-    @return The end of array.
+    @param[in] val The unsigned integer value.
     */
-    ElementIterator elementsEnd() const
+    /*explicit*/ Value(UInt8 val)
+        : m_type(TYPE_INTEGER)
+        , m_inArena(false)
+        , m_shortSize(0)
+        , m_unsigned(false)
     {
-        assert(isArray() && "not an array");
-        return m_arr.end();
+        m_val.u = val;
     }
-/// @}
 
 
-/// @name Object
-/// @{
-public:
-
-    /// @brief Get the member by name.
+    /// @brief Construct the integer value (16 bits).
     /**
-    @param[in] name The member name.
-    @param[in] def The default value if no member with such name exists.
-    @return The member value or @a def if no member with such name exists.
+    @param[in] val The signed integer value.
     */
-    Value const& get(String const& name, Value const& def) const
+    /*explicit*/ Value(Int16 val)
+        : m_type(TYPE_INTEGER)
+        , m_inArena(false)
+        , m_shortSize(0)
+        , m_unsigned(false)
     {
-        assert(isObject() && "not an object");
-
-        Object::const_iterator m = m_obj.find(name);
-        return (m == m_obj.end()) ? def : m->second;
+        m_val.i = val;
     }
 
 
-    /// @brief Get the member by name or create new one.
+    /// @brief Construct the integer value (16 bits).
     /**
-    This method changes value type to TYPE_OBJECT.
+    @param[in] val The unsigned integer value.
+    */
+    /*explicit*/ Value(UInt16 val)
+        : m_type(TYPE_INTEGER)
+        , m_inArena(false)
+        , m_shortSize(0)
+        , m_unsigned(false)
+    {
+        m_val.u = val;
+    }
 
-    NULL member value created if no member with such name exists.
 
-    @param[in] name The member name.
-    @return The member value.
+    /// @brief Construct the integer value (32 bits).
+    /**
+    @param[in] val The signed integer value.
     */
-    Value& get(String const& name)
+    /*explicit*/ Value(Int32 val)
+        : m_type(TYPE_INTEGER)
+        , m_inArena(false)
+        , m_shortSize(0)
+        , m_unsigned(false)
     {
-        assert(isObject() && "not an object");
+        m_val.i = val;
+    }
 
-        Object::iterator m = m_obj.find(name);
-        if (m == m_obj.end())
-        {
-            if (TYPE_NULL == m_type)
-                m_type = TYPE_OBJECT;
-            m = m_obj.insert(m, std::make_pair(name, Value()));
-        }
 
-        return m->second;
+    /// @brief Construct the integer value (32 bits).
+    /**
+    @param[in] val The unsigned integer value.
+    */
+    /*explicit*/ Value(UInt32 val)
+        : m_type(TYPE_INTEGER)
+        , m_inArena(false)
+        , m_shortSize(0)
+        , m_unsigned(false)
+    {
+        m_val.u = val;
     }
 
 
-    /// @brief Get the member by name.
+    /// @brief Construct the integer value (64 bits).
     /**
-    @param[in] name The member name.
-    @return The member value or null().
+    @param[in] val The signed integer value.
     */
-    Value const& operator[](String const& name) const
+    /*explicit*/ Value(Int64 val)
+        : m_type(TYPE_INTEGER)
+        , m_inArena(false)
+        , m_shortSize(0)
+        , m_unsigned(false)
     {
-        return get(name, null());
+        m_val.i = val;
     }
 
 
-    /// @brief Get the member by name or create new.
+    /// @brief Construct the integer value (64 bits).
     /**
-    NULL member value created if no member with such name exists.
-
-    @param[in] name The member name.
-    @return The member value.
+    @param[in] val The unsigned integer value.
     */
-    Value& operator[](String const& name)
+    /*explicit*/ Value(UInt64 val)
+        : m_type(TYPE_INTEGER)
+        , m_inArena(false)
+        , m_shortSize(0)
+        , m_unsigned(UInt64(std::numeric_limits<Int64>::max()) < val)
     {
-        return get(name);
+        m_val.u = val;
     }
 
 
-    /// @brief Is member value exists?
+    /// @brief Construct the floating-point value.
     /**
-    @param[in] name The member name.
-    @return `true` if member with such name exists.
+    @param[in] val The floating-point value.
     */
-    bool hasMemeber(String const& name) const
+    /*explicit*/ Value(double val)
+        : m_type(TYPE_DOUBLE)
+        , m_inArena(false)
+        , m_shortSize(0)
+        , m_unsigned(false)
     {
-        assert(isObject() && "not an object");
-
-        Object::const_iterator m = m_obj.find(name);
-        return (m != m_obj.end());
+        m_val.f = val;
     }
 
 
-    /// @brief Remove member.
+    /// @brief Construct the floating-point value.
     /**
-    @param[in] name The member name to remove.
+    @param[in] val The floating-point value.
     */
-    void removeMember(String const& name)
+    /*explicit*/ Value(float val)
+        : m_type(TYPE_DOUBLE)
+        , m_inArena(false)
+        , m_shortSize(0)
+        , m_unsigned(false)
     {
-        assert(isObject() && "not an object");
-        m_obj.erase(name);
+        m_val.f = val;
     }
 
 
-    /// @brief The members iterator.
+    /// @brief Construct the string value.
     /**
-    This type is used to iterate all member names on object JSON value.
+    @param[in] val The string value.
     */
-    typedef std::map<String,Value>::const_iterator MemberIterator;
+    /*explicit*/ Value(const char* val)
+        : m_type(TYPE_NULL)
+        , m_inArena(false)
+        , m_shortSize(0)
+        , m_unsigned(false)
+    {
+        m_val.u = 0;
+        initString(val, strlen(val), 0);
+    }
 
 
-    /// @brief Get the begin of object's members.
+    /// @brief Constring the string value.
     /**
-    @return The begin of object's members.
+    @param[in] val The string value.
     */
-    MemberIterator membersBegin() const
+    /*explicit*/ Value(String const& val)
+        : m_type(TYPE_NULL)
+        , m_inArena(false)
+        , m_shortSize(0)
+        , m_unsigned(false)
     {
-        assert(isObject() && "not an object");
-        return m_obj.begin();
+        m_val.u = 0;
+        initString(val.data(), val.size(), 0);
     }
 
 
-    /// @brief Get the end of object's members.
+    /// @brief The destructor.
     /**
-    @return The end of object's members.
+    Releases the string, array or object content.
     */
-    MemberIterator membersEnd() const
+    ~Value()
     {
-        assert(isObject() && "not an object");
-        return m_obj.end();
+        release();
     }
 /// @}
 
-private:
-    Type m_type; ///< @brief The value type.
-
-    /// @brief The %POD data holder type.
-    union POD
-    {
-        double f; ///< @brief The floating-point value.
-        UInt64 u; ///< @brief The unsigned integer value.
-         Int64 i; ///< @brief The signed integer value.
-    } m_val; ///< @brief The %POD data holder.
 
-    typedef std::vector<Value> Array; ///< @brief The array type.
-    typedef std::map<String,Value> Object; ///< @brief The object type.
+/// @name Copy, move and swap
+/// @{
+public:
 
-    // TODO: move these to union as pointers?
-    String m_str; ///< @brief The string value.
-    Array  m_arr; ///< @brief The array value.
-    Object m_obj; ///< @brief The object value.
-};
+    /// @brief The copy-constructor.
+    /**
+    @param[in] other The other value to copy.
+    */
+    Value(Value const& other)
+        : m_type(TYPE_NULL)
+        , m_inArena(false)
+        , m_shortSize(0)
+        , m_unsigned(false)
+    {
+        m_val.u = 0;
+        assign(other);
+    }
 
 
-/// @brief Are two JSON values equal?
-/** @relates Value
-@param[in] a The first JSON value.
-@param[in] b The second JSON value.
-@return `true` if two JSON values are equal.
-@see Value::equal()
+    /// @brief The copy assignment.
+    /**
+    @param[in] other The other value to copy.
+    @return The self reference.
+    */
+    Value& operator=(Value const& other)
+    {
+        Value tmp(other);
+        swap(tmp);
+        return *this;
+    }
+
+
+    /// @brief Swap the two values.
+    /**
+    Swap content of two values.
+
+    @param[in,out] other The value to swap.
+    */
+    void swap(Value &other) HIVE_NOEXCEPT
+    {
+        std::swap(m_type, other.m_type);
+        std::swap(m_inArena, other.m_inArena);
+        std::swap(m_shortSize, other.m_shortSize);
+        std::swap(m_unsigned, other.m_unsigned);
+        std::swap(m_val, other.m_val);
+    }
+
+#if defined(HIVE_HAS_RVALUE_REFS)
+
+    /// @brief The move-constructor.
+    /**
+    @param[in] other The other value to move.
+    */
+    Value(Value && other) HIVE_NOEXCEPT
+        : m_type(other.m_type)
+        , m_inArena(other.m_inArena)
+        , m_shortSize(other.m_shortSize)
+        , m_unsigned(other.m_unsigned)
+        , m_val(other.m_val)
+    {
+        other.m_type = TYPE_NULL;
+        other.m_inArena = false;
+        other.m_shortSize = 0;
+        other.m_unsigned = false;
+        other.m_val.u = 0;
+    }
+
+
+    /// @brief The move assignment.
+    /**
+    The previous content is released.
+
+    @param[in] other The other value to move.
+    @return The self reference.
+    */
+    Value& operator=(Value && other) HIVE_NOEXCEPT
+    {
+        if (this != &other)
+        {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+
+#endif // defined(HIVE_HAS_RVALUE_REFS)
+/// @}
+
+public:
+
+    /// @brief Get the NULL value.
+    /**
+    This static value is used to indicate the NULL value references.
+
+    @return The NULL value static reference.
+    */
+    static Value const& null()
+    {
+        static Value N;
+        return N;
+    }
+
+
+/// @name Type checks
+/// @{
+public:
+
+    /// @brief Get the value type.
+    /**
+    @return The value type.
+    */
+    Type getType() const
+    {
+        return m_type;
+    }
+
+
+    /// @brief Is the value NULL?
+    /**
+    @return `true` if the value is NULL.
+    */
+    bool isNull() const
+    {
+        return (TYPE_NULL == m_type);
+    }
+
+
+    /// @copydoc isNull()
+    bool operator!() const
+    {
+        return isNull();
+    }
+
+
+    /// @brief Is the value boolean?
+    /**
+    @return `true` if the value is boolean.
+    */
+    bool isBool() const
+    {
+        return (TYPE_BOOLEAN == m_type);
+    }
+
+
+    /// @brief Is the value integer?
+    /**
+    @return `true` if the value is integer.
+    */
+    bool isInteger() const
+    {
+        return (TYPE_INTEGER == m_type);
+    }
+
+
+    /// @brief Is the value big unsigned integer?
+    /**
+    The integer values up to Int64 maximum are always treated as signed.
+    Only the greater values are marked as unsigned,
+    such values cannot be converted by asInt().
+
+    @return `true` if the value is integer greater than Int64 maximum.
+    */
+    bool isUInteger() const
+    {
+        return (TYPE_INTEGER == m_type) && m_unsigned;
+    }
+
+
+    /// @brief Is the value floating-point?
+    /**
+    @return `true` if the value if floating-point.
+    */
+    bool isDouble() const
+    {
+        return (TYPE_DOUBLE == m_type);
+    }
+
+
+    /// @brief Is the value string?
+    /**
+    @return `true` if the value is string.
+    */
+    bool isString() const
+    {
+        return (TYPE_STRING == m_type);
+    }
+
+
+    /// @brief Is the value array or NULL?
+    /**
+    @return `true` if the value is array or NULL.
+    */
+    bool isArray() const
+    {
+        return (TYPE_NULL == m_type) || (TYPE_ARRAY == m_type);
+    }
+
+
+    /// @brief Is the value object or NULL?
+    /**
+    @return `true` if the value is object or NULL.
+    */
+    bool isObject() const
+    {
+        return (TYPE_NULL == m_type) || (TYPE_OBJECT == m_type);
+    }
+
+
+    /// @brief Is the value convertible to the other type?
+    /**
+    See @ref hive_json_value_conv for all possible conversions.
+
+    @param[in] type The type convert to.
+    @return `true` if the value is convertible.
+    @see asBool()
+    @see asInt()
+    @see asUInt()
+    @see asDouble()
+    @see asString()
+    */
+    bool isConvertibleTo(Type type) const
+    {
+        switch (m_type)
+        {
+            case TYPE_NULL: // NULL -> ...
+                return true;
+
+            case TYPE_BOOLEAN: // boolean -> ...
+                return (TYPE_NULL == type && !m_val.u)
+                    || (TYPE_BOOLEAN == type)
+                    || (TYPE_INTEGER == type)
+                    || (TYPE_DOUBLE == type)
+                    || (TYPE_STRING == type);
+
+            case TYPE_INTEGER: // integer -> ...
+                return (TYPE_NULL == type &&  !m_val.u)
+                    || (TYPE_BOOLEAN == type)
+                    || (TYPE_INTEGER == type)
+                    || (TYPE_DOUBLE == type)
+                    || (TYPE_STRING == type);
+
+            case TYPE_DOUBLE: // double -> ...
+                return (TYPE_NULL == type && m_val.f != 0.0)
+                    || (TYPE_BOOLEAN == type)
+                    || (TYPE_INTEGER == type)
+                    || (TYPE_DOUBLE == type)
+                    || (TYPE_STRING == type);
+
+            case TYPE_STRING: // string -> ...
+            {
+                const StringRef str = stringRef();
+                if (TYPE_BOOLEAN == type) // -> boolean
+                {
+                    return str.empty()
+                        || str=="false"
+                        || str=="true";
+                }
+                else if (TYPE_INTEGER == type) // -> integer
+                {
+                    const size_t N = str.size();
+                    if (0 < N)
+                    {
+                        size_t i = 0;
+
+                        // ignore leading '+' or '-'
+                        if ('+'==str[i] || '-'==str[i])
+                        {
+                            if (N == ++i)
+                                return false; // one sign isn't allowed
+                        }
+
+                        for (; i < N; ++i)
+                            if (!misc::is_digit(str[i]))
+                                return false;
+                    }
+
+                    return true;
+                }
+                else if (TYPE_DOUBLE == type) // -> double
+                {
+                    const size_t N = str.size();
+                    if (0 < N)
+                    {
+                        // TODO: check string is double
+                        IStringStream iss(str.str());
+                        double val = 0.0;
+                        if (!(iss >> val))
+                            return false;
+                    }
+
+                    return true;
+                }
+                else
+                    return (TYPE_NULL == type && str.empty())
+                        || (TYPE_STRING == type);
+            }
+
+            case TYPE_ARRAY:
+                return (TYPE_NULL == type && m_val.arr->empty())
+                    || (TYPE_ARRAY == type);
+
+            case TYPE_OBJECT:
+                return (TYPE_NULL == type && m_val.obj->empty())
+                    || (TYPE_OBJECT == type);
+        }
+
+        return false; // no conversion
+    }
+/// @}
+
+public:
+
+    /// @brief Convert value to the boolean.
+    /**
+    @return The boolean value.
+    @throw error::CastError if cannot convert.
+    @see @ref hive_json_value_conv
+    */
+    bool asBool() const
+    {
+        switch (m_type)
+        {
+            case TYPE_NULL:
+                return false; // NULL as false
+
+            case TYPE_BOOLEAN:
+            case TYPE_INTEGER: // true as non-zero
+                return (0 != m_val.u);
+
+            case TYPE_DOUBLE: // true as non-zero
+                return (0.0 != m_val.f); // exactly!
+
+            case TYPE_STRING:
+            {
+                const StringRef str = stringRef();
+                if (!str.empty())
+                {
+                    if (str == "true")
+                        return true;
+                    else if (str == "false")
+                        return false;
+                    else
+                        break; // will throw
+                }
+                else
+                    return false; // false if empty
+            }
+
+            case TYPE_ARRAY:
+            case TYPE_OBJECT:
+                break; // no conversion
+        }
+
+        // TODO: detail information about value type?
+        throw error::CastError("cannot convert to boolean");
+    }
+
+
+    /// @brief Convert value to the signed integer.
+    /**
+    @return The signed integer value.
+    @throw error::CastError if cannot convert.
+    @see @ref hive_json_value_conv
+    */
+    Int64 asInt() const
+    {
+        switch (m_type)
+        {
+            case TYPE_NULL:
+                return 0; // NULL as zero
+
+            case TYPE_BOOLEAN:
+                return m_val.i;
+
+            case TYPE_INTEGER:
+                if (m_unsigned)
+                    break; // out of range
+                return m_val.i;
+
+            case TYPE_DOUBLE:
+                return Int64(m_val.f);
+
+            case TYPE_STRING:
+            {
+                const StringRef str = stringRef();
+                if (!str.empty())
+                {
+                    if (isConvertibleTo(TYPE_INTEGER))
+                    {
+                        IStringStream iss(str.str());
+                        Int64 val = 0;
+                        if (iss >> val)
+                            return val;
+                    }
+                }
+                else
+                    return 0;
+            } break;
+
+            case TYPE_ARRAY:
+            case TYPE_OBJECT:
+                break; // no conversion
+        }
+
+        // TODO: detail information about value type?
+        throw error::CastError("cannot convert to integer");
+    }
+
+
+    /// @brief Convert value to the unsigned integer.
+    /**
+    @return The unsigned integer value.
+    @throw error::CastError if cannot convert.
+    @see @ref hive_json_value_conv
+    */
+    UInt64 asUInt() const
+    {
+        switch (m_type)
+        {
+            case TYPE_NULL:
+                return 0; // NULL as zero
+
+            case TYPE_BOOLEAN:
+            case TYPE_INTEGER:
+                return m_val.u;
+
+            case TYPE_DOUBLE:
+                return UInt64(m_val.f);
+
+            case TYPE_STRING:
+            {
+                const StringRef str = stringRef();
+                if (!str.empty())
+                {
+                    if (isConvertibleTo(TYPE_INTEGER))
+                    {
+                        IStringStream iss(str.str());
+                        Int64 val = 0;
+                        if (iss >> val)
+                            return val;
+                    }
+                }
+                else
+                    return 0;
+            } break;
+
+            case TYPE_ARRAY:
+            case TYPE_OBJECT:
+                break; // no conversion
+        }
+
+        // TODO: detail information about value type?
+        throw error::CastError("cannot convert to integer");
+    }
+
+
+    /// @brief Convert value to the floating-point.
+    /**
+    @return The floating-point value.
+    @throw error::CastError if cannot convert.
+    @see @ref hive_json_value_conv
+    */
+    double asDouble() const
+    {
+        switch (m_type)
+        {
+            case TYPE_NULL:
+                return 0.0;
+
+            case TYPE_BOOLEAN:
+            case TYPE_INTEGER:
+                return m_unsigned ? double(m_val.u)
+                                  : double(m_val.i);
+
+            case TYPE_DOUBLE:
+                return m_val.f;
+
+            case TYPE_STRING:
+            {
+                const StringRef str = stringRef();
+                if (!str.empty())
+                {
+                    IStringStream iss(str.str());
+                    double val = 0.0;
+                    if (iss >> val)
+                        return val;
+                }
+                else
+                    return 0.0;
+            } break;
+
+            case TYPE_ARRAY:
+            case TYPE_OBJECT:
+                break; // no conversion
+        }
+
+        // TODO: detail information about value type?
+        throw error::CastError("cannot convert to floating-point");
+    }
+
+
+    /// @brief Convert value to the string.
+    /**
+    @return The floating-point value.
+    @throw error::CastError if cannot convert.
+    @see @ref hive_json_value_conv
+    */
+    String asString() const
+    {
+        switch (m_type)
+        {
+            case TYPE_NULL:
+                return String(); // NULL as empty string
+
+            case TYPE_BOOLEAN:
+                return m_val.u ? "true" : "false";
+
+            case TYPE_INTEGER:
+            {
+                OStringStream oss;
+                if (m_unsigned)
+                    oss << m_val.u;
+                else
+                    oss << m_val.i;
+                return oss.str();
+            }
+
+            case TYPE_DOUBLE:
+            {
+                OStringStream oss;
+                oss << m_val.f; // default format
+                return oss.str();
+            }
+
+            case TYPE_STRING:
+                if (m_shortSize)
+                    return String(m_val.sso, m_shortSize-1);
+                return *m_val.str; // might share the buffer
+
+            case TYPE_ARRAY:
+            case TYPE_OBJECT:
+                break; // no conversion
+        }
+
+        // TODO: detail information about value type?
+        throw error::CastError("cannot convert to string");
+    }
+
+
+    /// @brief Get the string reference.
+    /**
+    Unlike asString() this method doesn't copy the string content.
+    The reference is valid while this value is not changed.
+
+    Only NULL, boolean and string values can be referenced:
+    NULL as empty string, boolean as "true" or "false" literals.
+
+    @return The string reference.
+    @throw error::CastError if cannot reference.
+    @see asString()
+    */
+    StringRef asStringRef() const
+    {
+        switch (m_type)
+        {
+            case TYPE_NULL:
+                return StringRef(); // NULL as empty string
+
+            case TYPE_BOOLEAN:
+                return m_val.u ? StringRef("true", 4)
+                               : StringRef("false", 5);
+
+            case TYPE_STRING:
+                return stringRef();
+
+            case TYPE_INTEGER:
+            case TYPE_DOUBLE:
+            case TYPE_ARRAY:
+            case TYPE_OBJECT:
+                break; // no reference
+        }
+
+        // TODO: detail information about value type?
+        throw error::CastError("cannot reference as string");
+    }
+
+public:
+
+    /// @brief Is equal to the other value?
+    /**
+    The two values are equal if they have the same type
+    and exactly the same content.
+
+    @param[in] other The other value to compare.
+    @return `true` if value is equal to the other.
+    */
+    bool equal(Value const& other) const
+    {
+        // different types
+        if (m_type != other.m_type)
+            return false;
+
+        // the same type
+        switch (m_type)
+        {
+            case TYPE_NULL:
+                return true;
+
+            case TYPE_BOOLEAN:
+            case TYPE_INTEGER:
+                return m_val.u == other.m_val.u
+                    && m_unsigned == other.m_unsigned;
+
+            case TYPE_DOUBLE:
+                return m_val.f == other.m_val.f;
+
+            case TYPE_STRING:
+                return stringRef() == other.stringRef();
+
+            case TYPE_ARRAY:
+                return m_val.arr->size() == other.m_val.arr->size()
+                    && std::equal(m_val.arr->begin(), m_val.arr->end(),
+                            other.m_val.arr->begin());
+
+            case TYPE_OBJECT:
+                return *m_val.obj == *other.m_val.obj;
+        }
+
+        return false;
+    }
+
+public: // array & object
+
+    /// @brief Get the number of elements in array or object.
+    /**
+    For all other types returns zero.
+
+    @return The number of array elements or the number of members.
+    */
+    size_t size() const
+    {
+        switch (m_type)
+        {
+            case TYPE_ARRAY:
+                return m_val.arr->size();
+
+            case TYPE_OBJECT:
+                return m_val.obj->size();
+
+            default:
+                break;
+        }
+
+        return 0; // otherwise
+    }
+
+
+    /// @brief Is value empty?
+    /**
+    @return `true` if array is empty, object is empty, or value is NULL.
+    */
+    bool empty() const
+    {
+        switch (m_type)
+        {
+            case TYPE_NULL:
+                return true;
+
+            //case TYPE_STRING:
+            //    return m_str.empty();
+
+            case TYPE_ARRAY:
+                return m_val.arr->empty();
+
+            case TYPE_OBJECT:
+                return m_val.obj->empty();
+
+            default:
+                break;
+        }
+
+        return false; // otherwise
+    }
+
+
+    /// @brief Remove all object members or array elements.
+    void clear()
+    {
+        switch (m_type)
+        {
+            //case TYPE_STRING:
+            //    m_str.clear();
+            //    break;
+
+            case TYPE_ARRAY:
+                m_val.arr->clear();
+                break;
+
+            case TYPE_OBJECT:
+                m_val.obj->clear();
+                break;
+
+            default:
+                break;
+        }
+    }
+
+/// @name Array
+/// @{
+public:
+
+    /// @brief Resize the array.
+    /**
+    This method changes value type to TYPE_ARRAY.
+
+    New array elements initialized to @a def values, NULL by default.
+
+    @param[in] size The new array size.
+    @param[in] def The default value to fill array.
+    */
+    void resize(size_t size, Value const& def = Value())
+    {
+        assert(isArray() && "not an array");
+        if (m_type != TYPE_ARRAY)
+            init(TYPE_ARRAY);
+        if (m_val.arr->capacity() < size)
+            grow(size);
+        m_val.arr->resize(size, def);
+    }
+
+
+    /// @brief Reserve space for array elements or object members.
+    /**
+    NULL value is changed to TYPE_ARRAY.
+
+    The object members are reserved only for flat objects
+    (see #HIVE_JSON_FLAT_OBJECTS), `std::map` has no such ability.
+
+    @param[in] size The expected number of elements or members.
+    */
+    void reserve(size_t size)
+    {
+        assert((isArray() || isObject()) && "not an array or object");
+        if (TYPE_NULL == m_type)
+            init(TYPE_ARRAY);
+
+        if (TYPE_ARRAY == m_type)
+        {
+            if (m_val.arr->capacity() < size)
+                grow(size);
+        }
+#if defined(HIVE_JSON_FLAT_OBJECTS)
+        else if (TYPE_OBJECT == m_type)
+            m_val.obj->reserve(size);
+#endif // HIVE_JSON_FLAT_OBJECTS
+    }
+
+
+    /// @brief Get an array element.
+    /**
+    @param[in] index The zero-based element index.
+    @return The array element reference.
+    */
+    Value& operator[](size_t index)
+    {
+        assert(isArray() && "not an array");
+        assert(index < size()
+            && "index out of range");
+        return (*m_val.arr)[index];
+    }
+
+
+    /// @brief Get an array element (read-only).
+    /**
+    @param[in] index The zero-based element index.
+    @return The array element reference.
+    */
+    Value const& operator[](size_t index) const
+    {
+        assert(isArray() && "not an array");
+        assert(index < size()
+            && "index out of range");
+        return (*m_val.arr)[index];
+    }
+
+
+
+
+    /// @brief Append value to array at the end.
+    /**
+    This method changes value type to TYPE_ARRAY.
+
+    @param[in] jval The JSON value to append.
+    */
+    void append(Value const& jval)
+    {
+        Value tmp(jval);
+        append().swap(tmp);
+    }
+
+
+    /// @brief Append NULL value to array at the end.
+    /**
+    This method changes value type to TYPE_ARRAY.
+
+    The new element is constructed in place, so it's possible
+    to fill it without any copy:
+
+    ~~~{.cpp}
+    json::Value elem = ...;
+    jarr.append().swap(elem);
+    ~~~
+
+    The existing elements are never copied on growth, they are swapped.
+
+    @return The new array element.
+    */
+    Value& append()
+    {
+        assert(isArray() && "not an array");
+        if (m_type != TYPE_ARRAY)
+            init(TYPE_ARRAY);
+
+        Array &arr = *m_val.arr;
+        if (arr.size() == arr.capacity())
+            grow(std::max(size_t(4), 2*arr.size()));
+
+        arr.push_back(Value());
+        return arr.back();
+    }
+
+#if defined(HIVE_HAS_RVALUE_REFS)
+
+    /// @brief Append value to array at the end (move).
+    /**
+    This method changes value type to TYPE_ARRAY.
+
+    @param[in] jval The JSON value to move.
+    */
+    void append(Value && jval)
+    {
+        append().swap(jval);
+    }
+
+#endif // defined(HIVE_HAS_RVALUE_REFS)
+
+
+    /// @brief The array elements iterator.
+    /**
+    This type is used to iterate all elements in array JSON value.
+    */
+    typedef std::vector<Value, ArenaAllocator<Value> >::const_iterator ElementIterator;
+
+
+    /// @brief Get the begin of array.
+    /**
+    @return The begin of array.
+    */
+    ElementIterator elementsBegin() const
+    {
+        assert(isArray() && "not an array");
+        return (TYPE_ARRAY == m_type)
+            ? m_val.arr->begin()
+            : emptyArray().begin();
+    }
+
+
+    /// @brief Get the end of array.
+    /**
+    @return The end of array.
+    */
+    ElementIterator elementsEnd() const
+    {
+        assert(isArray() && "not an array");
+        return (TYPE_ARRAY == m_type)
+            ? m_val.arr->end()
+            : emptyArray().end();
+    }
+/// @}
+
+
+/// @name Object
+/// @{
+public:
+
+    /// @brief Get the member by name.
+    /**
+    @param[in] name The member name.
+    @param[in] def The default value if no member with such name exists.
+    @return The member value or @a def if no member with such name exists.
+    */
+    Value const& get(String const& name, Value const& def) const
+    {
+        assert(isObject() && "not an object");
+        if (TYPE_OBJECT != m_type)
+            return def;
+
+        Object::const_iterator m = m_val.obj->find(name);
+        return (m == m_val.obj->end()) ? def : m->second;
+    }
+
+
+    /// @brief Get the member by name or create new one.
+    /**
+    This method changes value type to TYPE_OBJECT.
+
+    NULL member value created if no member with such name exists.
+
+    @param[in] name The member name.
+    @return The member value.
+    */
+    Value& get(String const& name)
+    {
+        assert(isObject() && "not an object");
+        if (TYPE_OBJECT != m_type)
+            init(TYPE_OBJECT);
+
+        return (*m_val.obj)[name];
+    }
+
+
+    /// @brief Get the member by name.
+    /**
+    @param[in] name The member name.
+    @return The member value or null().
+    */
+    Value const& operator[](String const& name) const
+    {
+        return get(name, null());
+    }
+
+
+    /// @brief Get the member by name or create new.
+    /**
+    NULL member value created if no member with such name exists.
+
+    @param[in] name The member name.
+    @return The member value.
+    */
+    Value& operator[](String const& name)
+    {
+        return get(name);
+    }
+
+
+    /// @brief Get the member by name.
+    /**
+    No temporary string is created if the member name
+    is already interned (see KeyTable).
+
+    This overload accepts string literals and character arrays only,
+    so `size_t` is the only integral overload and `jval[0]` or `jval[n]`
+    with any integer type is not ambiguous. Other `const char*`
+    names are converted to String.
+
+    @param[in] name The member name.
+    @return The member value or null().
+    */
+    template<size_t N>
+    Value const& operator[](const char (&name)[N]) const
+    {
+#if defined(HIVE_JSON_INTERNED_KEYS)
+        if (String const* key = KeyTable::global().find(name, strlen(name)))
+            return get(*key, null());
+#endif // HIVE_JSON_INTERNED_KEYS
+        return get(String(name), null());
+    }
+
+
+    /// @brief Get the member by name or create new.
+    /**
+    NULL member value created if no member with such name exists.
+    The member name is interned if #HIVE_JSON_INTERNED_KEYS macro is defined.
+
+    @param[in] name The member name, string literal or character array.
+    @return The member value.
+    */
+    template<size_t N>
+    Value& operator[](const char (&name)[N])
+    {
+#if defined(HIVE_JSON_INTERNED_KEYS)
+        return get(KeyTable::global().intern(name, strlen(name)));
+#else
+        return get(String(name));
+#endif // HIVE_JSON_INTERNED_KEYS
+    }
+
+
+    /// @brief Is member value exists?
+    /**
+    @param[in] name The member name.
+    @return `true` if member with such name exists.
+    */
+    bool hasMemeber(String const& name) const
+    {
+        assert(isObject() && "not an object");
+        if (TYPE_OBJECT != m_type)
+            return false;
+
+        Object::const_iterator m = m_val.obj->find(name);
+        return (m != m_val.obj->end());
+    }
+
+
+    /// @brief Remove member.
+    /**
+    @param[in] name The member name to remove.
+    */
+    void removeMember(String const& name)
+    {
+        assert(isObject() && "not an object");
+        if (TYPE_OBJECT == m_type)
+            m_val.obj->erase(name);
+    }
+
+
+    /// @brief The members iterator.
+    /**
+    This type is used to iterate all member names on object JSON value.
+    */
+#if defined(HIVE_JSON_FLAT_OBJECTS)
+    typedef FlatObject<Value, ArenaAllocator< std::pair<String, Value> > >::const_iterator MemberIterator;
+#else
+    typedef std::map<String, Value, std::less<String>,
+        ArenaAllocator< std::pair<const String, Value> > >::const_iterator MemberIterator;
+#endif // HIVE_JSON_FLAT_OBJECTS
+
+
+    /// @brief Get the begin of object's members.
+    /**
+    @return The begin of object's members.
+    */
+    MemberIterator membersBegin() const
+    {
+        assert(isObject() && "not an object");
+        return (TYPE_OBJECT == m_type)
+            ? m_val.obj->begin()
+            : emptyObject().begin();
+    }
+
+
+    /// @brief Get the end of object's members.
+    /**
+    @return The end of object's members.
+    */
+    MemberIterator membersEnd() const
+    {
+        assert(isObject() && "not an object");
+        return (TYPE_OBJECT == m_type)
+            ? m_val.obj->end()
+            : emptyObject().end();
+    }
+/// @}
+
+private:
+    friend class ValueBuilder;
+    friend class Pointer;
+    friend class PointerSet;
+    friend class Patch;
+    template<typename> friend class Schema;
+
+    typedef std::vector<Value, ArenaAllocator<Value> > Array; ///< @brief The array type.
+#if defined(HIVE_JSON_FLAT_OBJECTS)
+    typedef FlatObject<Value, ArenaAllocator< std::pair<String, Value> > > Object; ///< @brief The object type.
+#else
+    typedef std::map<String, Value, std::less<String>,
+        ArenaAllocator< std::pair<const String, Value> > > Object; ///< @brief The object type.
+#endif // HIVE_JSON_FLAT_OBJECTS
+
+
+    /// @brief Find the member by name and precalculated hash.
+    /**
+    The hash is used by flat objects only, see FlatObject::hash().
+
+    @param[in] name The member name.
+    @param[in] h The member name hash.
+    @return The member value or `0` if not found.
+    */
+    Value const* findMember(String const& name, UInt32 h) const
+    {
+        if (TYPE_OBJECT != m_type)
+            return 0;
+
+#if defined(HIVE_JSON_FLAT_OBJECTS)
+        Object::const_iterator m = m_val.obj->find(name, h);
+#else
+        Object::const_iterator m = m_val.obj->find(name);
+        (void)h; // not used
+#endif // HIVE_JSON_FLAT_OBJECTS
+        return (m == m_val.obj->end()) ? 0 : &m->second;
+    }
+
+
+    /// @brief Get the empty array.
+    /**
+    Used to iterate NULL value as an empty array.
+
+    @return The empty array static reference.
+    */
+    static Array const& emptyArray()
+    {
+        static Array A;
+        return A;
+    }
+
+
+    /// @brief Get the empty object.
+    /**
+    Used to iterate NULL value as an empty object.
+
+    @return The empty object static reference.
+    */
+    static Object const& emptyObject()
+    {
+        static Object O;
+        return O;
+    }
+
+private:
+
+    /// @brief Grow the array storage.
+    /**
+    The existing elements are swapped to the new storage,
+    not copied, so they also stay in the same arena.
+
+    @param[in] capacity The new array capacity.
+    */
+    void grow(size_t capacity)
+    {
+        Array &arr = *m_val.arr;
+        const size_t N = arr.size();
+
+        Array tmp(arr.get_allocator());
+        tmp.reserve(capacity);
+        tmp.resize(N);
+        for (size_t i = 0; i < N; ++i)
+            tmp[i].swap(arr[i]);
+        arr.swap(tmp);
+    }
+
+
+    /// @brief Change the value type.
+    /**
+    The previous content is released.
+    The string, array or object content is initialized as empty.
+    The empty string is short, so it is never allocated.
+
+    @param[in] type The new value type.
+    @param[in] arena The arena to allocate content from. May be NULL.
+    */
+    void init(Type type, Arena *arena = 0)
+    {
+        POD val;
+        val.u = 0;
+
+        switch (type) // might throw std::bad_alloc
+        {
+            case TYPE_ARRAY:  val.arr = create<Array>(arena, Array(Array::allocator_type(arena))); break;
+            case TYPE_OBJECT: val.obj = create<Object>(arena, Object(Object::key_compare(), Object::allocator_type(arena))); break;
+            default: break;
+        }
+
+        release();
+        m_type = type;
+        m_inArena = (0 != arena);
+        m_shortSize = (TYPE_STRING == type) ? 1 : 0;
+        m_val = val;
+    }
+
+
+    /// @brief Change the value to the string.
+    /**
+    The previous content is released.
+    The short string is stored inline, the long one is allocated.
+
+    @param[in] data The string data.
+    @param[in] size The string size in bytes.
+    @param[in] arena The arena to allocate long string from. May be NULL.
+    */
+    void initString(const char *data, size_t size, Arena *arena)
+    {
+        if (size <= SHORT_STRING_MAX)
+        {
+            init(TYPE_STRING);
+            memcpy(m_val.sso, data, size);
+            m_shortSize = UInt8(size + 1);
+        }
+        else
+        {
+            String *str = arena // might throw std::bad_alloc
+                ? new (arena->allocate(sizeof(String))) String(data, size)
+                : new String(data, size);
+
+            release();
+            m_type = TYPE_STRING;
+            m_inArena = (0 != arena);
+            m_val.str = str;
+        }
+    }
+
+
+    /// @brief Change the value to the string.
+    /**
+    The previous content is released.
+    The long string content is swapped, not copied.
+
+    @param[in,out] val The string value. Might be swapped.
+    @param[in] arena The arena to allocate long string holder from. May be NULL.
+    */
+    void setString(String &val, Arena *arena)
+    {
+        if (val.size() <= SHORT_STRING_MAX)
+            initString(val.data(), val.size(), arena);
+        else
+        {
+            String *str = create<String>(arena, String()); // might throw std::bad_alloc
+            str->swap(val);
+
+            release();
+            m_type = TYPE_STRING;
+            m_inArena = (0 != arena);
+            m_val.str = str;
+        }
+    }
+
+
+    /// @brief Get the string content.
+    /**
+    The value type should be string.
+
+    @return The short or long string reference.
+    */
+    StringRef stringRef() const
+    {
+        assert(TYPE_STRING == m_type && "not a string");
+        return m_shortSize ? StringRef(m_val.sso, m_shortSize-1)
+                           : StringRef(*m_val.str);
+    }
+
+
+    /// @brief Copy the other value content.
+    /**
+    Only the active alternative of the other value is copied.
+    The copy is always allocated on the heap, even if
+    the other value is allocated from an arena.
+
+    @param[in] other The other value to copy.
+    */
+    void assign(Value const& other)
+    {
+        HIVE_JSON_ON_COPY();
+        POD val = other.m_val;
+
+        switch (other.m_type) // might throw std::bad_alloc
+        {
+            case TYPE_STRING:
+                if (!other.m_shortSize)
+                    val.str = new String(*other.m_val.str);
+                break;
+            case TYPE_ARRAY:  val.arr = new Array(other.m_val.arr->begin(), other.m_val.arr->end()); break;
+            case TYPE_OBJECT: val.obj = new Object(other.m_val.obj->begin(), other.m_val.obj->end()); break;
+            default: break;
+        }
+
+        release();
+        m_type = other.m_type;
+        m_shortSize = other.m_shortSize;
+        m_unsigned = other.m_unsigned;
+        m_val = val;
+    }
+
+
+    /// @brief Release the content.
+    /**
+    The value becomes NULL.
+    */
+    void release()
+    {
+        switch (m_type)
+        {
+            case TYPE_STRING: if (!m_shortSize) destroy(m_val.str); break;
+            case TYPE_ARRAY:  destroy(m_val.arr); break;
+            case TYPE_OBJECT: destroy(m_val.obj); break;
+            default: break;
+        }
+
+        m_type = TYPE_NULL;
+        m_inArena = false;
+        m_shortSize = 0;
+        m_unsigned = false;
+        m_val.u = 0;
+    }
+
+
+    /// @brief Create the content holder.
+    /**
+    @param[in] arena The arena to allocate from. May be NULL.
+    @param[in] empty The empty content.
+    @return The new content holder.
+    */
+    template<typename T>
+    static T* create(Arena *arena, T const& empty)
+    {
+        return arena ? new (arena->allocate(sizeof(T))) T(empty)
+                     : new T(empty);
+    }
+
+
+    /// @brief Destroy the content holder.
+    /**
+    The arena memory is not freed, just the destructor is called.
+
+    @param[in] p The content holder.
+    */
+    template<typename T>
+    void destroy(T *p)
+    {
+        if (m_inArena)
+            p->~T();
+        else
+            delete p;
+    }
+
+private:
+
+    /// @brief The maximum short string size in bytes.
+    /**
+    The short strings are stored inline, without heap allocation.
+    */
+    enum { SHORT_STRING_MAX = sizeof(UInt64) };
+
+private:
+    Type m_type; ///< @brief The value type.
+    bool m_inArena; ///< @brief The content is allocated from an arena.
+    UInt8 m_shortSize; ///< @brief The short string size plus one, zero for long string.
+    bool m_unsigned; ///< @brief The integer value is greater than Int64 maximum.
+
+    /// @brief The data holder type.
+    /**
+    Only one alternative is active depending on the value type.
+    The long string, array and object content is allocated on the heap,
+    so the empty containers are never constructed for scalar values.
+    The short string is stored inline.
+    */
+    union POD
+    {
+        double f; ///< @brief The floating-point value.
+        UInt64 u; ///< @brief The unsigned integer value.
+         Int64 i; ///< @brief The signed integer value.
+
+        char sso[SHORT_STRING_MAX]; ///< @brief The short string value.
+        String *str; ///< @brief The long string value.
+        Array  *arr; ///< @brief The array value.
+        Object *obj; ///< @brief The object value.
+    } m_val; ///< @brief The data holder.
+};
+
+
+/// @brief Swap two JSON values.
+/** @relates Value
+@param[in,out] a The first JSON value.
+@param[in,out] b The second JSON value.
+*/
+inline void swap(Value &a, Value &b) HIVE_NOEXCEPT
+{
+    a.swap(b);
+}
+
+
+/// @brief Are two JSON values equal?
+/** @relates Value
+@param[in] a The first JSON value.
+@param[in] b The second JSON value.
+@return `true` if two JSON values are equal.
+@see Value::equal()
+*/
+inline bool operator==(Value const& a, Value const& b)
+{
+    return a.equal(b);
+}
+
+
+/// @brief Are two JSON values different?
+/** @relates Value
+@param[in] a The first JSON value.
+@param[in] b The second JSON value.
+@return `true` if two JSON values are different.
+@see Value::equal()
+*/
+inline bool operator!=(Value const& a, Value const& b)
+{
+    return !(a == b);
+}
+
+/// @brief The JSON pointer.
+/**
+This class is the precompiled path to the nested JSON value,
+see RFC-6901 http://tools.ietf.org/html/rfc6901
+
+The path is parsed once: reference tokens are unescaped,
+array indices are converted to integers and member name hashes
+are calculated. So the path might be resolved many times
+without any string processing.
+
+~~~{.cpp}
+static const json::Pointer path("/deviceClass/name");
+String name = path.resolve(jval).asString();
+~~~
+
+If the path doesn't exist the NULL value is returned.
+The "-" array index (past the last element) is never resolved.
+
+Use PointerSet to resolve several paths at once.
+*/
+class Pointer
+{
+public:
+
+    /// @brief The main constructor.
+    /**
+    @param[in] path The JSON pointer string, empty string refers to the whole document.
+    @throw error::SyntaxError if path is invalid.
+    */
+    explicit Pointer(String const& path)
+        : m_path(path)
+    {
+        parse(path, m_tokens);
+    }
+
+public:
+
+    /// @brief Get the JSON pointer string.
+    /**
+    @return The JSON pointer string.
+    */
+    String const& toString() const
+    {
+        return m_path;
+    }
+
+
+    /// @brief Get the number of reference tokens.
+    /**
+    @return The number of reference tokens.
+    */
+    size_t size() const
+    {
+        return m_tokens.size();
+    }
+
+public:
+
+    /// @brief Find the value.
+    /**
+    @param[in] root The root JSON value.
+    @return The value or `0` if not found.
+    */
+    Value const* find(Value const& root) const
+    {
+        Value const* jval = &root;
+        for (size_t i = 0; jval && i < m_tokens.size(); ++i)
+            jval = step(*jval, m_tokens[i]);
+        return jval;
+    }
+
+
+    /// @brief Resolve the value.
+    /**
+    @param[in] root The root JSON value.
+    @return The value or Value::null() if not found.
+    */
+    Value const& resolve(Value const& root) const
+    {
+        Value const* jval = find(root);
+        return jval ? *jval : Value::null();
+    }
+
+private:
+    friend class PointerSet;
+    friend class Patch;
+
+    /// @brief The reference token.
+    struct Token
+    {
+        String name; ///< @brief The member name.
+        UInt32 hash; ///< @brief The member name hash.
+        size_t index; ///< @brief The array index or `-1` if not an index.
+
+        /// @brief The default constructor.
+        Token()
+            : hash(0)
+            , index(size_t(-1))
+        {}
+
+        /// @brief Are two tokens equal?
+        bool operator==(Token const& other) const
+        {
+            return hash == other.hash && name == other.name;
+        }
+    };
+
+    /// @brief The list of reference tokens.
+    typedef std::vector<Token> TokenList;
+
+
+    /// @brief Parse the JSON pointer string.
+    /**
+    @param[in] path The JSON pointer string.
+    @param[out] tokens The list of reference tokens.
+    @throw error::SyntaxError if path is invalid.
+    */
+    static void parse(String const& path, TokenList &tokens)
+    {
+        if (path.empty())
+            return; // whole document
+        if ('/' != path[0])
+            throw error::SyntaxError("JSON pointer should start with '/'");
+
+        const size_t N = path.size();
+        for (size_t i = 1; i <= N; ++i)
+        {
+            Token token;
+
+            for (; i < N && '/' != path[i]; ++i)
+            {
+                const char ch = path[i];
+                if ('~' == ch)
+                {
+                    const char esc = (i+1 < N) ? path[++i] : 0;
+                    if ('0' == esc)
+                        token.name.push_back('~');
+                    else if ('1' == esc)
+                        token.name.push_back('/');
+                    else
+                        throw error::SyntaxError("invalid JSON pointer escape");
+                }
+                else
+                    token.name.push_back(ch);
+            }
+
+            token.hash = FlatObject<Value>::hash(token.name);
+            token.index = parseIndex(token.name);
+            tokens.push_back(token);
+        }
+    }
+
+
+    /// @brief Parse the array index.
+    /**
+    The leading zeros are not allowed.
+
+    @param[in] name The reference token.
+    @return The array index or `-1` if token is not an index.
+    */
+    static size_t parseIndex(String const& name)
+    {
+        const size_t NONE = size_t(-1);
+        if (name.empty() || (1 < name.size() && '0' == name[0]))
+            return NONE;
+
+        size_t index = 0;
+        for (size_t i = 0; i < name.size(); ++i)
+        {
+            const int d = name[i] - '0';
+            if (d < 0 || 9 < d || (NONE - d)/10 < index)
+                return NONE; // not a digit or overflow
+            index = index*10 + d;
+        }
+
+        return index;
+    }
+
+
+    /// @brief Do one step.
+    /**
+    @param[in] jval The current JSON value.
+    @param[in] token The reference token.
+    @return The nested value or `0` if not found.
+    */
+    static Value const* step(Value const& jval, Token const& token)
+    {
+        switch (jval.m_type)
+        {
+            case Value::TYPE_OBJECT:
+                return jval.findMember(token.name, token.hash);
+
+            case Value::TYPE_ARRAY:
+                return (token.index < jval.m_val.arr->size())
+                    ? &(*jval.m_val.arr)[token.index] : 0;
+
+            default:
+                return 0;
+        }
+    }
+
+private:
+    String m_path; ///< @brief The JSON pointer string.
+    TokenList m_tokens; ///< @brief The reference tokens.
+};
+
+
+/// @brief The set of JSON pointers.
+/**
+This class resolves several JSON pointers in one document traversal.
+The pointers are stored as a tree: common prefixes, like "/network"
+in "/network/id" and "/network/name", are resolved only once.
+
+~~~{.cpp}
+json::PointerSet fields;
+const size_t ID = fields.add("/id");
+const size_t NAME = fields.add("/deviceClass/name");
+
+json::Value const* res[2];
+fields.extract(jval, res);
+res[ID]->asUInt();
+res[NAME]->asString();
+~~~
+*/
+class PointerSet
+{
+public:
+
+    /// @brief The default constructor.
+    PointerSet()
+        : m_nodes(1)
+        , m_count(0)
+    {}
+
+public:
+
+    /// @brief Add JSON pointer.
+    /**
+    @param[in] path The JSON pointer string.
+    @return The result slot index.
+    @throw error::SyntaxError if path is invalid.
+    */
+    size_t add(String const& path)
+    {
+        return add(Pointer(path));
+    }
+
+
+    /// @brief Add JSON pointer.
+    /**
+    The same pointer added twice shares the same result slot.
+
+    @param[in] ptr The JSON pointer.
+    @return The result slot index.
+    */
+    size_t add(Pointer const& ptr)
+    {
+        size_t node = 0; // root
+        for (size_t i = 0; i < ptr.m_tokens.size(); ++i)
+        {
+            Pointer::Token const& token = ptr.m_tokens[i];
+
+            size_t next = 0;
+            for (size_t k = 0; !next && k < m_nodes[node].children.size(); ++k)
+            {
+                const size_t child = m_nodes[node].children[k];
+                if (m_nodes[child].token == token)
+                    next = child;
+            }
+
+            if (!next) // new node
+            {
+                next = m_nodes.size();
+                m_nodes.push_back(Node());
+                m_nodes.back().token = token;
+                m_nodes[node].children.push_back(next);
+            }
+
+            node = next;
+        }
+
+        Node &n = m_nodes[node];
+        if (!n.hasSlot)
+        {
+            n.slot = m_count++;
+            n.hasSlot = true;
+        }
+        return n.slot;
+    }
+
+
+    /// @brief Get the number of result slots.
+    /**
+    @return The number of distinct JSON pointers added.
+    */
+    size_t size() const
+    {
+        return m_count;
+    }
+
+public:
+
+    /// @brief Resolve all JSON pointers.
+    /**
+    The values not found are set to Value::null().
+
+    @param[in] root The root JSON value.
+    @param[out] results The results, should be at least size() elements.
+    */
+    void extract(Value const& root, Value const** results) const
+    {
+        for (size_t i = 0; i < m_count; ++i)
+            results[i] = &Value::null();
+        walk(0, root, results);
+    }
+
+
+    /// @brief Resolve all JSON pointers.
+    /**
+    @param[in] root The root JSON value.
+    @param[out] results The results, resized to size() elements.
+    */
+    void extract(Value const& root, std::vector<Value const*> &results) const
+    {
+        results.resize(m_count);
+        if (m_count)
+            extract(root, &results[0]);
+    }
+
+private:
+
+    /// @brief Resolve the node and all its children.
+    /**
+    @param[in] node The node index.
+    @param[in] jval The node value.
+    @param[out] results The results.
+    */
+    void walk(size_t node, Value const& jval, Value const** results) const
+    {
+        Node const& n = m_nodes[node];
+        if (n.hasSlot)
+            results[n.slot] = &jval;
+
+        for (size_t k = 0; k < n.children.size(); ++k)
+        {
+            const size_t child = n.children[k];
+            if (Value const* next = Pointer::step(jval, m_nodes[child].token))
+                walk(child, *next, results);
+        }
+    }
+
+private:
+
+    /// @brief The tree node.
+    struct Node
+    {
+        Pointer::Token token; ///< @brief The reference token.
+        std::vector<size_t> children; ///< @brief The child nodes.
+        size_t slot; ///< @brief The result slot.
+        bool hasSlot; ///< @brief Is this node the end of JSON pointer?
+
+        /// @brief The default constructor.
+        Node()
+            : slot(0)
+            , hasSlot(false)
+        {}
+    };
+
+    std::vector<Node> m_nodes; ///< @brief The tree nodes, the first is root.
+    size_t m_count; ///< @brief The number of result slots.
+};
+
+
+/// @brief The JSON object schema.
+/**
+The schema describes object members and binds them to the fields
+of the typed structure through member pointers. The schema is built
+once and then used to validate and extract many JSON values:
+
+~~~{.cpp}
+json::Schema<Command> schema;
+schema.add("id", &Command::id, json::Schema<Command>::REQUIRED)
+      .add("command", &Command::name)
+      .add("parameters", &Command::params);
+
+Command cmd;
+String error;
+if (!schema.extract(jval, cmd, &error))
+    std::cerr << error << "\n"; // "/id: is required"
+~~~
+
+The member names are hashed when the schema is built.
+The members are converted the same way as Value::asInt(),
+Value::asString() and so on do, but the convertibility is checked first,
+so no exception is thrown for invalid data.
+
+The missing optional members don't change the corresponding fields.
+*/
+template<typename T>
+class Schema
+{
+public:
+
+    /// @brief The member flags.
+    enum Flags
+    {
+        OPTIONAL = 0, ///< @brief The member might be missing or NULL.
+        REQUIRED = 1  ///< @brief The member should be present and non-NULL.
+    };
+
+public:
+
+    /// @brief Add the boolean member.
+    /**
+    @param[in] name The member name.
+    @param[in] member The field to extract to.
+    @param[in] flags The member flags.
+    @return The self reference.
+    */
+    Schema& add(String const& name, bool T::*member, int flags = OPTIONAL)
+    {
+        Field &f = push(name, FIELD_BOOLEAN, flags);
+        f.member.b = member;
+        return *this;
+    }
+
+
+    /// @brief Add the integer member.
+    /**
+    The out of range values are reported as errors.
+
+    @param[in] name The member name.
+    @param[in] member The field to extract to.
+    @param[in] flags The member flags.
+    @return The self reference.
+    */
+    Schema& add(String const& name, int T::*member, int flags = OPTIONAL)
+    {
+        Field &f = push(name, FIELD_INT, flags);
+        f.member.i = member;
+        return *this;
+    }
+
+
+    /// @brief Add the signed integer member.
+    /**
+    @param[in] name The member name.
+    @param[in] member The field to extract to.
+    @param[in] flags The member flags.
+    @return The self reference.
+    */
+    Schema& add(String const& name, Int64 T::*member, int flags = OPTIONAL)
+    {
+        Field &f = push(name, FIELD_INT64, flags);
+        f.member.i64 = member;
+        return *this;
+    }
+
+
+    /// @brief Add the unsigned integer member.
+    /**
+    The negative values are reported as errors.
+
+    @param[in] name The member name.
+    @param[in] member The field to extract to.
+    @param[in] flags The member flags.
+    @return The self reference.
+    */
+    Schema& add(String const& name, UInt64 T::*member, int flags = OPTIONAL)
+    {
+        Field &f = push(name, FIELD_UINT64, flags);
+        f.member.u64 = member;
+        return *this;
+    }
+
+
+    /// @brief Add the floating-point member.
+    /**
+    @param[in] name The member name.
+    @param[in] member The field to extract to.
+    @param[in] flags The member flags.
+    @return The self reference.
+    */
+    Schema& add(String const& name, double T::*member, int flags = OPTIONAL)
+    {
+        Field &f = push(name, FIELD_DOUBLE, flags);
+        f.member.f = member;
+        return *this;
+    }
+
+
+    /// @brief Add the string member.
+    /**
+    @param[in] name The member name.
+    @param[in] member The field to extract to.
+    @param[in] flags The member flags.
+    @return The self reference.
+    */
+    Schema& add(String const& name, String T::*member, int flags = OPTIONAL)
+    {
+        Field &f = push(name, FIELD_STRING, flags);
+        f.member.str = member;
+        return *this;
+    }
+
+
+    /// @brief Add the JSON value member.
+    /**
+    The member is copied as is, without any validation.
+
+    @param[in] name The member name.
+    @param[in] member The field to extract to.
+    @param[in] flags The member flags.
+    @return The self reference.
+    */
+    Schema& add(String const& name, Value T::*member, int flags = OPTIONAL)
+    {
+        Field &f = push(name, FIELD_VALUE, flags);
+        f.member.val = member;
+        return *this;
+    }
+
+
+    /// @brief Get the number of members.
+    /**
+    @return The number of members.
+    */
+    size_t size() const
+    {
+        return m_fields.size();
+    }
+
+public:
+
+    /// @brief Validate and extract the JSON value.
+    /**
+    The JSON value should be an object or NULL. All members are checked
+    in one pass, the first invalid member stops extraction. In this case
+    the @a obj might be partially changed.
+
+    @param[in] jval The JSON value to extract.
+    @param[in,out] obj The typed structure to extract to.
+    @param[out] error The error description with the member path. May be NULL.
+    @return `true` if the JSON value is valid.
+    */
+    bool extract(Value const& jval, T &obj, String *error = 0) const
+    {
+        if (!jval.isObject())
+            return fail(error, 0, "should be object");
+
+        const size_t N = m_fields.size();
+        for (size_t i = 0; i < N; ++i)
+        {
+            Field const& f = m_fields[i];
+
+            Value const* m = jval.findMember(f.name, f.hash);
+            if (!m || m->isNull())
+            {
+                if (f.flags & REQUIRED)
+                    return fail(error, &f, "is required");
+                if (!m) continue; // keep field as is
+            }
+
+            if (const char *what = assign(f, *m, obj))
+                return fail(error, &f, what);
+        }
+
+        return true;
+    }
+
+
+    /// @brief Validate and extract one member.
+    /**
+    This method is used by the event-based readers which get members
+    one by one and don't build the whole JSON object. The member is
+    converted exactly as extract() does. The unknown members are ignored.
+
+    Note, the missing required members cannot be detected this way.
+
+    @param[in] name The member name.
+    @param[in] jval The member value.
+    @param[in,out] obj The typed structure to extract to.
+    @param[out] error The error description with the member path. May be NULL.
+    @return `true` if the member is valid or unknown.
+    */
+    bool extractMember(String const& name, Value const& jval, T &obj, String *error = 0) const
+    {
+        const UInt32 hash = KeyTable::hash(name.data(), name.size());
+
+        const size_t N = m_fields.size();
+        for (size_t i = 0; i < N; ++i)
+        {
+            Field const& f = m_fields[i];
+            if (f.hash != hash || f.name != name)
+                continue;
+
+            if (jval.isNull() && (f.flags & REQUIRED))
+                return fail(error, &f, "is required");
+
+            if (const char *what = assign(f, jval, obj))
+                return fail(error, &f, what);
+
+            break;
+        }
+
+        return true;
+    }
+
+private:
+
+    /// @brief The field type.
+    enum FieldType
+    {
+        FIELD_BOOLEAN,
+        FIELD_INT,
+        FIELD_INT64,
+        FIELD_UINT64,
+        FIELD_DOUBLE,
+        FIELD_STRING,
+        FIELD_VALUE
+    };
+
+
+    /// @brief The member pointer.
+    /**
+    Only one alternative is active depending on the field type.
+    */
+    union Member
+    {
+        bool   T::*b;   ///< @brief The boolean field.
+        int    T::*i;   ///< @brief The integer field.
+        Int64  T::*i64; ///< @brief The signed integer field.
+        UInt64 T::*u64; ///< @brief The unsigned integer field.
+        double T::*f;   ///< @brief The floating-point field.
+        String T::*str; ///< @brief The string field.
+        Value  T::*val; ///< @brief The JSON value field.
+    };
+
+
+    /// @brief The schema field.
+    struct Field
+    {
+        String name; ///< @brief The member name.
+        UInt32 hash; ///< @brief The member name hash.
+        FieldType type; ///< @brief The field type.
+        int flags; ///< @brief The member flags.
+        Member member; ///< @brief The member pointer.
+    };
+
+private:
+
+    /// @brief Add the new field.
+    /**
+    @param[in] name The member name.
+    @param[in] type The field type.
+    @param[in] flags The member flags.
+    @return The new field reference.
+    */
+    Field& push(String const& name, FieldType type, int flags)
+    {
+        Field f;
+        f.name = name;
+        f.hash = KeyTable::hash(name.data(), name.size());
+        f.type = type;
+        f.flags = flags;
+        m_fields.push_back(f);
+        return m_fields.back();
+    }
+
+
+    /// @brief Assign the field.
+    /**
+    @param[in] f The schema field.
+    @param[in] jval The member value.
+    @param[in,out] obj The typed structure.
+    @return The error description or `0` if assigned.
+    */
+    static const char* assign(Field const& f, Value const& jval, T &obj)
+    {
+        switch (f.type)
+        {
+            case FIELD_BOOLEAN:
+                if (!jval.isConvertibleTo(Value::TYPE_BOOLEAN))
+                    return "should be boolean";
+                obj.*f.member.b = jval.asBool();
+                break;
+
+            case FIELD_INT:
+            {
+                Int64 val = 0;
+                if (jval.isUInteger())
+                    return "out of range";
+                if (!integer(jval, val))
+                    return "should be integer";
+                if (val < std::numeric_limits<int>::min()
+                 || val > std::numeric_limits<int>::max())
+                    return "out of range";
+                obj.*f.member.i = int(val);
+            } break;
+
+            case FIELD_INT64:
+            {
+                Int64 val = 0;
+                if (jval.isUInteger())
+                    return "out of range";
+                if (!integer(jval, val))
+                    return "should be integer";
+                obj.*f.member.i64 = val;
+            } break;
+
+            case FIELD_UINT64:
+            {
+                Int64 val = 0;
+                if (jval.isDouble() || jval.isUInteger())
+                    obj.*f.member.u64 = jval.asUInt();
+                else if (integer(jval, val))
+                    obj.*f.member.u64 = UInt64(val);
+                else
+                    return "should be integer";
+            } break;
+
+            case FIELD_DOUBLE:
+                if (!jval.isConvertibleTo(Value::TYPE_DOUBLE))
+                    return "should be number";
+                obj.*f.member.f = jval.asDouble();
+                break;
+
+            case FIELD_STRING:
+                if (!jval.isConvertibleTo(Value::TYPE_STRING))
+                    return "should be string";
+                obj.*f.member.str = jval.asString();
+                break;
+
+            case FIELD_VALUE:
+                obj.*f.member.val = jval;
+                break;
+        }
+
+        return 0; // OK
+    }
+
+
+    /// @brief Convert to the integer.
+    /**
+    Unlike Value::asInt() doesn't throw if string value is out of range.
+
+    @param[in] jval The member value.
+    @param[out] val The integer value.
+    @return `true` if converted.
+    */
+    static bool integer(Value const& jval, Int64 &val)
+    {
+        if (!jval.isConvertibleTo(Value::TYPE_INTEGER))
+            return false;
+
+        if (!jval.isString())
+        {
+            val = jval.asInt();
+            return true;
+        }
+
+        const StringRef str = jval.asStringRef();
+        if (str.empty())
+        {
+            val = 0; // empty string as zero
+            return true;
+        }
+
+        IStringStream iss(str.str());
+        return !!(iss >> val);
+    }
+
+
+    /// @brief Report the error.
+    /**
+    The error path is the JSON pointer to the invalid member.
+
+    @param[out] error The error description. May be NULL.
+    @param[in] f The invalid field. NULL for the whole object.
+    @param[in] what The error description.
+    @return Always `false`.
+    */
+    static bool fail(String *error, Field const* f, const char *what)
+    {
+        if (error)
+        {
+            OStringStream ess;
+            if (f) // escape as JSON pointer
+            {
+                ess << "/";
+                const size_t N = f->name.size();
+                for (size_t i = 0; i < N; ++i)
+                {
+                    const char ch = f->name[i];
+                    if ('~' == ch) ess << "~0";
+                    else if ('/' == ch) ess << "~1";
+                    else ess << ch;
+                }
+            }
+            if (f) ess << ": ";
+            ess << what;
+            *error = ess.str();
+        }
+
+        return false;
+    }
+
+private:
+    std::vector<Field> m_fields; ///< @brief The schema fields.
+};
+
+
+
+/// @brief The chunked output buffer.
+/**
+This buffer is used to format JSON values without one big contiguous
+string: the data is appended to a list of fixed-size chunks, so the
+already written data is never moved or copied on growth.
+
+The chunks might be passed to the network layer as a scatter-gather
+sequence (see hive::http::Message::setContentBuffer()):
+
+~~~{.cpp}
+boost::shared_ptr<json::OutputBuffer> body(new json::OutputBuffer());
+json::Formatter::write(*body, jval, false);
+request->setContentBuffer(body);
+~~~
+*/
+class OutputBuffer:
+    private NonCopyable
+{
+public:
+
+    /// @brief The main constructor.
+    /**
+    @param[in] chunkSize The default chunk size in bytes.
+    */
+    explicit OutputBuffer(size_t chunkSize = 4096)
+        : m_chunkSize(chunkSize ? chunkSize : 1),
+          m_size(0)
+    {}
+
+
+    /// @brief The destructor.
+    /**
+    Releases all chunks.
+    */
+    ~OutputBuffer()
+    {
+        for (size_t i = 0; i < m_chunks.size(); ++i)
+            delete[] m_chunks[i].data;
+    }
+
+public:
+
+    /// @brief Append one character.
+    /**
+    @param[in] ch The character to append.
+    */
+    void put(char ch)
+    {
+        if (m_chunks.empty() || m_chunks.back().full())
+            addChunk(1);
+
+        Chunk &c = m_chunks.back();
+        c.data[c.size++] = ch;
+        m_size += 1;
+    }
+
+
+    /// @brief Append a few characters.
+    /**
+    @param[in] data The characters to append.
+    @param[in] len The number of characters.
+    */
+    void write(const char *data, size_t len)
+    {
+        while (len)
+        {
+            if (m_chunks.empty() || m_chunks.back().full())
+                addChunk(len);
+
+            Chunk &c = m_chunks.back();
+            const size_t n = std::min(len, c.capacity - c.size);
+            memcpy(c.data + c.size, data, n);
+            c.size += n;
+            m_size += n;
+            data += n;
+            len -= n;
+        }
+    }
+
+
+    /// @brief Remove all data.
+    /**
+    The first chunk is kept to be reused.
+    */
+    void clear()
+    {
+        for (size_t i = 1; i < m_chunks.size(); ++i)
+            delete[] m_chunks[i].data;
+        if (!m_chunks.empty())
+        {
+            m_chunks.resize(1);
+            m_chunks[0].size = 0;
+        }
+        m_size = 0;
+    }
+
+public:
+
+    /// @brief Get the total data size.
+    /**
+    @return The number of bytes written.
+    */
+    size_t size() const
+    {
+        return m_size;
+    }
+
+
+    /// @brief Is buffer empty?
+    /**
+    @return `true` if no data written.
+    */
+    bool empty() const
+    {
+        return 0 == m_size;
+    }
+
+
+    /// @brief Get the number of chunks.
+    /**
+    @return The number of chunks.
+    */
+    size_t chunkCount() const
+    {
+        return m_chunks.size();
+    }
+
+
+    /// @brief Get the chunk data.
+    /**
+    @param[in] i The zero-based chunk index.
+    @return The chunk data.
+    */
+    const char* chunkData(size_t i) const
+    {
+        return m_chunks[i].data;
+    }
+
+
+    /// @brief Get the chunk size.
+    /**
+    @param[in] i The zero-based chunk index.
+    @return The number of bytes in the chunk.
+    */
+    size_t chunkSize(size_t i) const
+    {
+        return m_chunks[i].size;
+    }
+
+
+    /// @brief Get all data as a string.
+    /**
+    @return The contiguous copy of all chunks.
+    */
+    String toString() const
+    {
+        String str;
+        str.reserve(m_size);
+        for (size_t i = 0; i < m_chunks.size(); ++i)
+            str.append(m_chunks[i].data, m_chunks[i].size);
+        return str;
+    }
+
+private:
+
+    /// @brief Add new chunk.
+    /**
+    @param[in] hint The number of bytes going to be written.
+    */
+    void addChunk(size_t hint)
+    {
+        m_chunks.reserve(m_chunks.size() + 1); // might throw std::bad_alloc
+
+        Chunk c;
+        c.capacity = std::max(hint, m_chunkSize);
+        c.data = new char[c.capacity];
+        c.size = 0;
+        m_chunks.push_back(c);
+    }
+
+private:
+
+    /// @brief The data chunk.
+    struct Chunk
+    {
+        char *data; ///< @brief The chunk data.
+        size_t size; ///< @brief The number of bytes used.
+        size_t capacity; ///< @brief The chunk capacity.
+
+        /// @brief Is chunk full?
+        bool full() const
+        {
+            return size == capacity;
+        }
+    };
+
+    std::vector<Chunk> m_chunks; ///< @brief The chunks.
+    size_t m_chunkSize; ///< @brief The default chunk size.
+    size_t m_size; ///< @brief The total data size.
+};
+
+
+/// @brief The basic JSON formatter.
+/**
+description is under construction.
+
+Writes JSON value in compact format without spaces and new lines.
+
+The output might be an output stream or a string. The numbers are
+formatted without any locale and stream formatting overhead: integers
+are converted by digit pairs, floating-point values are written with
+enough digits to parse exactly the same value back.
+*/
+class Formatter
+{
+public:
+
+    /// @brief The maximum length of formatted number.
+    /**
+    The buffer passed to formatInteger(), formatUInteger()
+    and formatDouble() should be at least of this size.
+    */
+    enum { MAX_NUMBER_LENGTH = 32 };
+
+public:
+
+    /// @brief Write the JSON value to the output stream.
+    /**
+    In "human friendly" format there also the line feeds and indents in the output.
+    Otherwise no any indents or spaces are used.
+
+    @param[in,out] os The output stream.
+    @param[in] jval The JSON value.
+    @param[in] humanFriendly The human fiendly format flag.
+    @param[in] indent The first line indent. Used for human friendly format.
+    @return The output stream.
+    */
+    static OStream& write(OStream &os, Value const& jval, bool humanFriendly, size_t indent = 0)
+    {
+        StreamOutput out(os);
+        writeValue(out, jval, humanFriendly, indent);
+        out.flush();
+        return os;
+    }
+
+
+    /// @brief Append the JSON value to the string.
+    /**
+    @param[in,out] str The output string.
+    @param[in] jval The JSON value.
+    @param[in] humanFriendly The human fiendly format flag.
+    @param[in] indent The first line indent. Used for human friendly format.
+    @return The output string.
+    */
+    static String& write(String &str, Value const& jval, bool humanFriendly, size_t indent = 0)
+    {
+        StringOutput out(str);
+        writeValue(out, jval, humanFriendly, indent);
+        return str;
+    }
+
+
+    /// @brief Append the JSON value to the chunked buffer.
+    /**
+    @param[in,out] buf The output buffer.
+    @param[in] jval The JSON value.
+    @param[in] humanFriendly The human fiendly format flag.
+    @param[in] indent The first line indent. Used for human friendly format.
+    @return The output buffer.
+    */
+    static OutputBuffer& write(OutputBuffer &buf, Value const& jval, bool humanFriendly, size_t indent = 0)
+    {
+        writeValue(buf, jval, humanFriendly, indent);
+        return buf;
+    }
+
+public:
+
+    /// @brief Write indent.
+    /**
+    This method writes the `2*indent` spaces to the output.
+
+    @param[in,out] os The output stream.
+    @param[in] indent The indent size.
+    @return The output stream.
+    */
+    template<typename OutT>
+    static OutT& writeIndent(OutT &os, size_t indent)
+    {
+        const size_t N = 2*indent;
+        for (size_t i = 0; i < N; ++i)
+            os.put(' ');
+        return os;
+    }
+
+
+    /// @brief Write quoted string.
+    /**
+    Only the quote, backslash and control characters are escaped.
+    The valid UTF-8 sequences are written as is. The bytes of invalid
+    UTF-8 sequences are escaped as `\u00XX` (i.e. as Latin-1 characters).
+
+    Note, such binary strings don't round-trip: the parser decodes
+    `\u00XX` to the UTF-8 sequence of U+00XX, so "\xFF" is read back
+    as "\xC3\xBF". Encode the binary data explicitly (hex, base64).
+
+    The runs of regular characters are written by blocks.
+
+    @param[in,out] os The output stream.
+    @param[in] str The string to write.
+    @return The output stream.
+    */
+    template<typename OutT>
+    static OutT& writeQuotedString(OutT &os, StringRef const& str)
+    {
+        // 0 - regular, 1 - should be escaped, 2 - non-ASCII
+        static const UInt8 ESCAPE[256] =
+        {
+            1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x00
+            1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x10
+            0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x20, quote
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x30
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x40
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, // 0x50, backslash
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x60
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x70
+            2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // 0x80
+            2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // 0x90
+            2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // 0xA0
+            2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // 0xB0
+            2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // 0xC0
+            2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // 0xD0
+            2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // 0xE0
+            2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2  // 0xF0
+        };
+
+        os.put('\"');
+
+        const char *first = str.begin();
+        const char *last = str.end();
+        while (first != last)
+        {
+            // write the whole run of regular characters
+            const char *p = first;
+            while (p != last && !ESCAPE[UInt8(*p)])
+                ++p;
+            if (p != first)
+                os.write(first, p - first);
+            if (p == last)
+                break;
+
+            const int ch = UInt8(*p);
+            first = p + 1;
+
+            if (2 == ESCAPE[ch]) // non-ASCII
+            {
+                const int len = misc::utf8_check(p, last);
+                if (0 < len)
+                {
+                    os.write(p, len);
+                    first = p + len;
+                    continue;
+                }
+            }
+
+            os.put('\\');
+            switch (ch)
+            {
+                case '\"': os.put('\"'); break;
+                case '\\': os.put('\\'); break;
+                case '\b': os.put('b'); break;
+                case '\f': os.put('f'); break;
+                case '\n': os.put('n'); break;
+                case '\r': os.put('r'); break;
+                case '\t': os.put('t'); break;
+
+                default: // control or invalid UTF-8
+                    os.put('u');
+                    os.put('0');
+                    os.put('0');
+                    os.put(misc::int2hex((ch>>4)&0x0f));
+                    os.put(misc::int2hex((ch>>0)&0x0f));
+                    break;
+            }
+        }
+
+        os.put('\"');
+        return os;
+    }
+
+public:
+
+    /// @brief Format unsigned integer.
+    /**
+    Two decimal digits are produced per division.
+
+    @param[out] buf The output buffer of at least #MAX_NUMBER_LENGTH bytes.
+    @param[in] val The integer value.
+    @return The number of characters written (no NULL-terminator).
+    */
+    static size_t formatUInteger(char *buf, UInt64 val)
+    {
+        static const char DIGITS[] =
+            "00010203040506070809101112131415161718192021222324"
+            "25262728293031323334353637383940414243444546474849"
+            "50515253545556575859606162636465666768697071727374"
+            "75767778798081828384858687888990919293949596979899";
+
+        char tmp[24];
+        char *p = tmp + sizeof(tmp);
+        while (100 <= val)
+        {
+            const size_t k = 2*size_t(val%100);
+            val /= 100;
+            *--p = DIGITS[k+1];
+            *--p = DIGITS[k];
+        }
+        if (10 <= val)
+        {
+            const size_t k = 2*size_t(val);
+            *--p = DIGITS[k+1];
+            *--p = DIGITS[k];
+        }
+        else
+            *--p = char('0' + val);
+
+        const size_t len = (tmp + sizeof(tmp)) - p;
+        memcpy(buf, p, len);
+        return len;
+    }
+
+
+    /// @brief Format signed integer.
+    /**
+    @param[out] buf The output buffer of at least #MAX_NUMBER_LENGTH bytes.
+    @param[in] val The integer value.
+    @return The number of characters written (no NULL-terminator).
+    */
+    static size_t formatInteger(char *buf, Int64 val)
+    {
+        if (val < 0)
+        {
+            buf[0] = '-';
+            return 1 + formatUInteger(buf+1, 0 - UInt64(val));
+        }
+
+        return formatUInteger(buf, UInt64(val));
+    }
+
+
+    /// @brief Format floating-point value.
+    /**
+    The result is always parsed back to exactly the same value.
+    The values with up to 15 fraction digits (the most of sensor readings)
+    are written in the shortest fixed-point notation, all other values
+    use 15, 16 or 17 significant digits, whichever is enough.
+
+    The result always contains the fraction or exponent part,
+    so it's parsed back as floating-point, not as integer.
+    The NaN and infinity values are written as `null`.
+
+    @param[out] buf The output buffer of at least #MAX_NUMBER_LENGTH bytes.
+    @param[in] val The floating-point value.
+    @return The number of characters written (no NULL-terminator).
+    */
+    static size_t formatDouble(char *buf, double val)
+    {
+        if (val != val || val - val != 0.0) // NaN or infinity
+        {
+            memcpy(buf, "null", 4);
+            return 4;
+        }
+
+        char *p = buf;
+        UInt64 bits = 0;
+        memcpy(&bits, &val, sizeof(bits));
+        if (bits >> 63) // negative or -0.0
+        {
+            *p++ = '-';
+            val = -val;
+        }
+
+        // fast path: the value is exactly representable with a few
+        // fraction digits, for example 23.5 or 0.125. Both integer and
+        // power of ten are exact doubles here, so the division result
+        // is exactly what the parser will get for the same digits.
+        static const double P10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+            1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+        const double LIMIT = 9007199254740992.0; // 2^53
+        for (size_t d = 0; d < sizeof(P10)/sizeof(P10[0]); ++d)
+        {
+            const double x = val*P10[d];
+            if (LIMIT <= x)
+                break;
+
+            const UInt64 m = UInt64(x + 0.5);
+            if (double(m)/P10[d] == val)
+            {
+                const UInt64 p10 = UInt64(P10[d]);
+                p += formatUInteger(p, m/p10);
+                *p++ = '.';
+                if (d)
+                {
+                    UInt64 f = m%p10;
+                    for (size_t i = d; 0 < i; --i, f /= 10)
+                        p[i-1] = char('0' + f%10);
+                    p += d;
+                }
+                else
+                    *p++ = '0';
+
+                return p - buf;
+            }
+        }
+
+        // generic path: the minimum precision which round-trips
+        int len = 0;
+        for (int prec = 15; prec <= 17; ++prec)
+        {
+            len = sprintf(p, "%.*g", prec, val);
+            if (strtod(p, 0) == val)
+                break;
+        }
+
+        bool floating = false;
+        for (int i = 0; i < len; ++i)
+        {
+            if (',' == p[i]) // locale specific decimal point
+                p[i] = '.';
+            if ('.' == p[i] || 'e' == p[i])
+                floating = true;
+        }
+        p += len;
+        if (!floating)
+        {
+            *p++ = '.';
+            *p++ = '0';
+        }
+
+        return p - buf;
+    }
+
+private:
+
+    /// @brief Write the JSON value.
+    /**
+    @param[in,out] os The output stream, StringOutput or OutputBuffer.
+    @param[in] jval The JSON value.
+    @param[in] humanFriendly The human fiendly format flag.
+    @param[in] indent The first line indent. Used for human friendly format.
+    */
+    template<typename OutT>
+    static void writeValue(OutT &os, Value const& jval, bool humanFriendly, size_t indent)
+    {
+        switch (jval.getType())
+        {
+            case Value::TYPE_NULL:
+                os.write("null", 4);
+                break;
+
+            case Value::TYPE_BOOLEAN:
+                if (jval.asBool())
+                    os.write("true", 4);
+                else
+                    os.write("false", 5);
+                break;
+
+            case Value::TYPE_INTEGER:
+            {
+                char buf[MAX_NUMBER_LENGTH];
+                if (jval.isUInteger())
+                    os.write(buf, formatUInteger(buf, jval.asUInt()));
+                else
+                    os.write(buf, formatInteger(buf, jval.asInt()));
+            } break;
+
+            case Value::TYPE_DOUBLE:
+            {
+                char buf[MAX_NUMBER_LENGTH];
+                os.write(buf, formatDouble(buf, jval.asDouble()));
+            } break;
+
+            case Value::TYPE_STRING:
+                writeQuotedString(os, jval.asStringRef());
+                break;
+
+            case Value::TYPE_ARRAY:
+            {
+                os.put('[');
+                if (const size_t N = jval.size())
+                {
+                    for (size_t i = 0; i < N; ++i)
+                    {
+                        if (0 < i)
+                            os.put(',');
+                        if (humanFriendly)
+                        {
+                            os.put('\n');
+                            writeIndent(os,
+                                indent+1);
+                        }
+                        writeValue(os, jval[i],
+                            humanFriendly,
+                            indent+1);
+                    }
+                    if (humanFriendly)
+                    {
+                        os.put('\n');
+                        writeIndent(os,
+                            indent);
+                    }
+                }
+                os.put(']');
+            } break;
+
+            case Value::TYPE_OBJECT:
+            {
+                os.put('{');
+                Value::MemberIterator b = jval.membersBegin();
+                const Value::MemberIterator e = jval.membersEnd();
+                if (b != e)
+                {
+                    for (Value::MemberIterator i = b; i != e; ++i)
+                    {
+                        const String &name = i->first;
+                        const Value &val = i->second;
+
+                        if (i != b)
+                            os.put(',');
+                        if (humanFriendly)
+                        {
+                            os.put('\n');
+                            writeIndent(os,
+                                indent+1);
+                        }
+                        writeQuotedString(os, name);
+                        os.put(':');
+                        if (humanFriendly)
+                            os.put(' ');
+                        writeValue(os, val,
+                            humanFriendly,
+                            indent+1);
+                    }
+                    if (humanFriendly)
+                    {
+                        os.put('\n');
+                        writeIndent(os,
+                            indent);
+                    }
+                }
+                os.put('}');
+            } break;
+        }
+    }
+
+private:
+
+    /// @brief The string output.
+    /**
+    Provides the subset of output stream interface
+    used by the formatter to append data to a string.
+    */
+    class StringOutput
+    {
+    public:
+
+        /// @brief The main constructor.
+        /**
+        @param[in,out] str The output string.
+        */
+        explicit StringOutput(String &str)
+            : m_str(str)
+        {}
+
+        /// @brief Append one character.
+        /**
+        @param[in] ch The character to append.
+        */
+        void put(char ch)
+        {
+            m_str.push_back(ch);
+        }
+
+        /// @brief Append a few characters.
+        /**
+        @param[in] data The characters to append.
+        @param[in] len The number of characters.
+        */
+        void write(const char *data, size_t len)
+        {
+            m_str.append(data, len);
+        }
+
+    private:
+        String &m_str; ///< @brief The output string.
+    };
+
+
+    /// @brief The buffered stream output.
+    /**
+    Provides the subset of output stream interface
+    used by the formatter. The characters are collected
+    in a local buffer and written to the stream by blocks,
+    so there is no virtual call per character.
+    */
+    class StreamOutput:
+        private NonCopyable
+    {
+    public:
+
+        /// @brief The main constructor.
+        /**
+        @param[in,out] os The output stream.
+        */
+        explicit StreamOutput(OStream &os)
+            : m_os(os)
+            , m_size(0)
+        {}
+
+        /// @brief Append one character.
+        /**
+        @param[in] ch The character to append.
+        */
+        void put(char ch)
+        {
+            if (m_size == sizeof(m_buf))
+                flush();
+            m_buf[m_size++] = ch;
+        }
+
+        /// @brief Append a few characters.
+        /**
+        @param[in] data The characters to append.
+        @param[in] len The number of characters.
+        */
+        void write(const char *data, size_t len)
+        {
+            if (sizeof(m_buf) < m_size + len)
+            {
+                flush();
+                if (sizeof(m_buf) < len)
+                {
+                    m_os.write(data, len);
+                    return;
+                }
+            }
+
+            memcpy(m_buf + m_size, data, len);
+            m_size += len;
+        }
+
+        /// @brief Write the buffered characters to the stream.
+        void flush()
+        {
+            if (m_size)
+                m_os.write(m_buf, m_size);
+            m_size = 0;
+        }
+
+    private:
+        OStream &m_os; ///< @brief The output stream.
+        char m_buf[512]; ///< @brief The local buffer.
+        size_t m_size; ///< @brief The number of buffered characters.
+    };
+};
+
+
+/// @brief Write JSON value to the output stream.
+/** @relates Value
+@param[in,out] os The output stream.
+@param[in] jval The JSON value.
+@return The output stream.
+*/
+inline OStream& operator<<(OStream &os, const Value &jval)
+{
+    const bool humanFriendly = false; // true;
+    return Formatter::write(os, jval, humanFriendly);
+}
+
+
+/// @brief The human friendly output.
+/**
+This wrapper writes JSON value to the output stream in human friendly
+format directly, without intermediate string (see json2hstr()).
+It's useful for the log messages:
+
+~~~{.cpp}
+HIVELOG_DEBUG(log, "got value:\n" << json::HumanFriendly(jval));
+~~~
+*/
+class HumanFriendly
+{
+public:
+
+    /// @brief The main constructor.
+    /**
+    @param[in] jval The JSON value to write. Should exist while wrapper is used.
+    */
+    explicit HumanFriendly(Value const& jval)
+        : m_jval(jval)
+    {}
+
+
+    /// @brief Get the JSON value.
+    /**
+    @return The JSON value reference.
+    */
+    Value const& getValue() const
+    {
+        return m_jval;
+    }
+
+private:
+    Value const& m_jval; ///< @brief The JSON value.
+};
+
+
+/// @brief Write JSON value to the output stream in human friendly format.
+/** @relates HumanFriendly
+@param[in,out] os The output stream.
+@param[in] hf The JSON value wrapper.
+@return The output stream.
+*/
+inline OStream& operator<<(OStream &os, HumanFriendly const& hf)
+{
+    return Formatter::write(os, hf.getValue(), true);
+}
+
+
+/// @brief Convert JSON value to string.
+/**
+@param[in] jval The JSON value.
+@return The JSON string.
+*/
+inline String json2str(Value const& jval)
+{
+    String str;
+    Formatter::write(str, jval, false);
+    return str;
+}
+
+
+/// @brief Convert JSON value to human friendly string.
+/**
+@param[in] jval The JSON value.
+@return The JSON string.
+*/
+inline String json2hstr(Value const& jval)
+{
+    String str;
+    Formatter::write(str, jval, true);
+    return str;
+}
+
+
+/// @brief The JSON patch.
+/**
+This class calculates the structural difference between two JSON values
+and applies it back. Two patch formats are supported:
+
+- JSON Patch, see RFC-6902 http://tools.ietf.org/html/rfc6902
+  The patch is an array of operations like
+  `{"op":"replace","path":"/status","value":"Online"}`,
+  see diff() and apply().
+- JSON Merge Patch, see RFC-7386 http://tools.ietf.org/html/rfc7386
+  The patch is an object of changed members only, removed members
+  are set to `null`, see mergeDiff() and merge().
+
+~~~{.cpp}
+json::Value patch = json::Patch::diff(lastSent, current);
+if (!patch.empty())
+    send(patch);
+~~~
+
+The object members are looked up by hash (see FlatObject), so
+the objects are compared in linear time. The arrays are compared
+element by element, the common head and tail are skipped first.
+So one element changed, inserted or removed in the long array
+(like device equipment) gives one operation, not the whole array.
+*/
+class Patch
+{
+public:
+
+    /// @brief Calculate the JSON Patch.
+    /**
+    @param[in] from The source value.
+    @param[in] to The target value.
+    @return The array of operations. Empty array if values are equal.
+    */
+    static Value diff(Value const& from, Value const& to)
+    {
+        Value patch(Value::TYPE_ARRAY);
+        String path;
+        diff(patch, path, from, to);
+        return patch;
+    }
+
+
+    /// @brief Apply the JSON Patch.
+    /**
+    All operations are supported: "add", "remove", "replace",
+    "move", "copy" and "test". The patch is applied to a copy,
+    so the target is not changed if any operation fails.
+
+    @param[in,out] target The value to patch.
+    @param[in] patch The array of operations.
+    @throw error::SyntaxError if patch is invalid or cannot be applied.
+    */
+    static void apply(Value &target, Value const& patch)
+    {
+        if (Value::TYPE_ARRAY != patch.getType())
+            throw error::SyntaxError("JSON patch should be an array");
+
+        Value res(target);
+        const Value::ElementIterator e = patch.elementsEnd();
+        for (Value::ElementIterator i = patch.elementsBegin(); i != e; ++i)
+            applyOne(res, *i);
+        target.swap(res);
+    }
+
+public:
+
+    /// @brief Calculate the JSON Merge Patch.
+    /**
+    If both values are objects the patch contains changed members only,
+    the nested objects are compared recursively and the empty object
+    means no changes. Otherwise the patch is the target value itself.
+
+    The `null` members of the target value cannot be expressed
+    by merge patch, they are treated as removed.
+
+    @param[in] from The source value.
+    @param[in] to The target value.
+    @return The merge patch.
+    */
+    static Value mergeDiff(Value const& from, Value const& to)
+    {
+        if (Value::TYPE_OBJECT != from.getType()
+            || Value::TYPE_OBJECT != to.getType())
+                return to;
+
+        Value patch(Value::TYPE_OBJECT);
+        mergeDiff(patch, from, to);
+        return patch;
+    }
+
+
+    /// @brief Apply the JSON Merge Patch.
+    /**
+    @param[in,out] target The value to patch.
+    @param[in] patch The merge patch.
+    */
+    static void merge(Value &target, Value const& patch)
+    {
+        if (Value::TYPE_OBJECT != patch.getType())
+        {
+            target = patch;
+            return;
+        }
+
+        if (Value::TYPE_OBJECT != target.getType())
+            target = Value(Value::TYPE_OBJECT);
+
+        const Value::MemberIterator e = patch.membersEnd();
+        for (Value::MemberIterator i = patch.membersBegin(); i != e; ++i)
+        {
+            if (i->second.isNull())
+                target.removeMember(i->first);
+            else
+                merge(target[i->first], i->second);
+        }
+    }
+
+private:
+
+    /// @brief Calculate the JSON Patch (recursive).
+    /**
+    @param[in,out] patch The array of operations.
+    @param[in,out] path The current JSON pointer, restored on return.
+    @param[in] from The source value.
+    @param[in] to The target value.
+    */
+    static void diff(Value &patch, String &path, Value const& from, Value const& to)
+    {
+        const Value::Type type = from.getType();
+        if (type == to.getType())
+        {
+            if (Value::TYPE_OBJECT == type)
+                diffObjects(patch, path, from, to);
+            else if (Value::TYPE_ARRAY == type)
+                diffArrays(patch, path, from, to);
+            else if (from != to)
+                addOp(patch, "replace", path, &to);
+            return;
+        }
+
+        addOp(patch, "replace", path, &to);
+    }
+
+
+    /// @brief Calculate the JSON Patch for two objects.
+    /**
+    @param[in,out] patch The array of operations.
+    @param[in,out] path The current JSON pointer, restored on return.
+    @param[in] from The source object.
+    @param[in] to The target object.
+    */
+    static void diffObjects(Value &patch, String &path, Value const& from, Value const& to)
+    {
+        const size_t base = path.size();
+
+        const Value::MemberIterator fe = from.membersEnd();
+        for (Value::MemberIterator i = from.membersBegin(); i != fe; ++i)
+        {
+            appendName(path, i->first);
+            if (Value const* t = to.findMember(i->first, FlatObject<Value>::hash(i->first)))
+                diff(patch, path, i->second, *t);
+            else
+                addOp(patch, "remove", path, 0);
+            path.resize(base);
+        }
+
+        const Value::MemberIterator te = to.membersEnd();
+        for (Value::MemberIterator i = to.membersBegin(); i != te; ++i)
+        {
+            if (!from.findMember(i->first, FlatObject<Value>::hash(i->first)))
+            {
+                appendName(path, i->first);
+                addOp(patch, "add", path, &i->second);
+                path.resize(base);
+            }
+        }
+    }
+
+
+    /// @brief Calculate the JSON Patch for two arrays.
+    /**
+    The common head and tail are skipped. The rest elements are
+    compared pairwise, extra elements are removed (from the end)
+    or added.
+
+    @param[in,out] patch The array of operations.
+    @param[in,out] path The current JSON pointer, restored on return.
+    @param[in] from The source array.
+    @param[in] to The target array.
+    */
+    static void diffArrays(Value &patch, String &path, Value const& from, Value const& to)
+    {
+        const size_t base = path.size();
+        const size_t N = from.size();
+        const size_t M = to.size();
+
+        size_t head = 0;
+        while (head < N && head < M && from[head] == to[head])
+            ++head;
+
+        size_t tail = 0;
+        while (head+tail < N && head+tail < M && from[N-1-tail] == to[M-1-tail])
+            ++tail;
+
+        const size_t n = N - head - tail;
+        const size_t m = M - head - tail;
+        for (size_t i = 0; i < n && i < m; ++i)
+        {
+            appendIndex(path, head+i);
+            diff(patch, path, from[head+i], to[head+i]);
+            path.resize(base);
+        }
+
+        for (size_t i = n; m < i; --i)
+        {
+            appendIndex(path, head+i-1);
+            addOp(patch, "remove", path, 0);
+            path.resize(base);
+        }
+
+        for (size_t i = n; i < m; ++i)
+        {
+            appendIndex(path, head+i);
+            addOp(patch, "add", path, &to[head+i]);
+            path.resize(base);
+        }
+    }
+
+
+    /// @brief Calculate the JSON Merge Patch for two objects.
+    /**
+    @param[in,out] patch The merge patch object.
+    @param[in] from The source object.
+    @param[in] to The target object.
+    */
+    static void mergeDiff(Value &patch, Value const& from, Value const& to)
+    {
+        const Value::MemberIterator fe = from.membersEnd();
+        for (Value::MemberIterator i = from.membersBegin(); i != fe; ++i)
+        {
+            if (!to.findMember(i->first, FlatObject<Value>::hash(i->first)))
+                patch[i->first] = Value::null();
+        }
+
+        const Value::MemberIterator te = to.membersEnd();
+        for (Value::MemberIterator i = to.membersBegin(); i != te; ++i)
+        {
+            Value const* f = from.findMember(i->first, FlatObject<Value>::hash(i->first));
+            if (f && Value::TYPE_OBJECT == f->getType()
+                  && Value::TYPE_OBJECT == i->second.getType())
+            {
+                Value sub(Value::TYPE_OBJECT);
+                mergeDiff(sub, *f, i->second);
+                if (!sub.empty())
+                    patch[i->first].swap(sub);
+            }
+            else if (!f || *f != i->second)
+                patch[i->first] = i->second;
+        }
+    }
+
+private:
+
+    /// @brief Append the member name to the JSON pointer.
+    /**
+    @param[in,out] path The JSON pointer.
+    @param[in] name The member name to escape.
+    */
+    static void appendName(String &path, String const& name)
+    {
+        path.push_back('/');
+        const size_t N = name.size();
+        for (size_t i = 0; i < N; ++i)
+        {
+            const char ch = name[i];
+            if ('~' == ch) path.append("~0", 2);
+            else if ('/' == ch) path.append("~1", 2);
+            else path.push_back(ch);
+        }
+    }
+
+
+    /// @brief Append the array index to the JSON pointer.
+    /**
+    @param[in,out] path The JSON pointer.
+    @param[in] index The array index.
+    */
+    static void appendIndex(String &path, size_t index)
+    {
+        char buf[Formatter::MAX_NUMBER_LENGTH];
+        path.push_back('/');
+        path.append(buf, Formatter::formatUInteger(buf, index));
+    }
+
+
+    /// @brief Append the patch operation.
+    /**
+    @param[in,out] patch The array of operations.
+    @param[in] op The operation name.
+    @param[in] path The JSON pointer.
+    @param[in] value The operation value. May be NULL.
+    */
+    static void addOp(Value &patch, const char *op, String const& path, Value const* value)
+    {
+        Value &jop = patch.append();
+        jop["op"] = op;
+        jop["path"] = path;
+        if (value)
+            jop["value"] = *value;
+    }
+
+private:
+
+    /// @brief Apply one patch operation.
+    /**
+    @param[in,out] root The value to patch.
+    @param[in] jop The patch operation.
+    @throw error::SyntaxError if operation is invalid or cannot be applied.
+    */
+    static void applyOne(Value &root, Value const& jop)
+    {
+        if (Value::TYPE_OBJECT != jop.getType())
+            throw error::SyntaxError("JSON patch operation should be an object");
+
+        const String op = member(jop, "op").asString();
+        const Pointer path(member(jop, "path").asString());
+
+        if ("add" == op)
+        {
+            Value jval(member(jop, "value"));
+            insert(root, path, jval);
+        }
+        else if ("remove" == op)
+            take(root, path);
+        else if ("replace" == op)
+        {
+            Value *target = const_cast<Value*>(path.find(root));
+            if (!target)
+                throw error::SyntaxError("JSON patch path not found");
+            Value jval(member(jop, "value"));
+            target->swap(jval);
+        }
+        else if ("move" == op)
+        {
+            const Pointer from(member(jop, "from").asString());
+            const String& fs = from.toString();
+            const String& ps = path.toString();
+            if (fs.size() < ps.size() && 0 == ps.compare(0, fs.size(), fs) && '/' == ps[fs.size()])
+                throw error::SyntaxError("JSON patch cannot move value into its child");
+            Value jval = take(root, from);
+            insert(root, path, jval);
+        }
+        else if ("copy" == op)
+        {
+            const Pointer from(member(jop, "from").asString());
+            Value const* src = from.find(root);
+            if (!src)
+                throw error::SyntaxError("JSON patch path not found");
+            Value jval(*src);
+            insert(root, path, jval);
+        }
+        else if ("test" == op)
+        {
+            Value const* target = path.find(root);
+            if (!target || *target != member(jop, "value"))
+                throw error::SyntaxError("JSON patch test failed");
+        }
+        else
+            throw error::SyntaxError("unknown JSON patch operation");
+    }
+
+
+    /// @brief Get the required operation member.
+    /**
+    @param[in] jop The patch operation.
+    @param[in] name The member name.
+    @return The member value.
+    @throw error::SyntaxError if no such member.
+    */
+    static Value const& member(Value const& jop, const char *name)
+    {
+        const String key(name);
+        Value const* jval = jop.findMember(key, FlatObject<Value>::hash(key));
+        if (!jval)
+            throw error::SyntaxError("JSON patch operation has no \"" + key + "\" member");
+        return *jval;
+    }
+
+
+    /// @brief Find the parent of the value referenced by JSON pointer.
+    /**
+    @param[in] root The root value.
+    @param[in] path The non-empty JSON pointer.
+    @return The parent value, object or array.
+    @throw error::SyntaxError if not found.
+    */
+    static Value& parent(Value &root, Pointer const& path)
+    {
+        Value *jval = &root;
+        const size_t N = path.m_tokens.size();
+        for (size_t i = 0; jval && i+1 < N; ++i)
+            jval = const_cast<Value*>(Pointer::step(*jval, path.m_tokens[i]));
+
+        if (!jval || (Value::TYPE_OBJECT != jval->getType()
+                   && Value::TYPE_ARRAY != jval->getType()))
+            throw error::SyntaxError("JSON patch path not found");
+        return *jval;
+    }
+
+
+    /// @brief Insert the value.
+    /**
+    The object member is added or replaced. The array element
+    is inserted, the "-" index appends element at the end.
+    The array elements are shifted by swaps, not copies.
+
+    @param[in,out] root The root value.
+    @param[in] path The JSON pointer.
+    @param[in,out] jval The value to insert. Swapped, so NULL on return.
+    @throw error::SyntaxError if path is not found.
+    */
+    static void insert(Value &root, Pointer const& path, Value &jval)
+    {
+        if (path.m_tokens.empty())
+        {
+            root.swap(jval);
+            return;
+        }
+
+        Value &p = parent(root, path);
+        Pointer::Token const& token = path.m_tokens.back();
+        if (Value::TYPE_OBJECT == p.getType())
+        {
+            p[token.name].swap(jval);
+            return;
+        }
+
+        const size_t N = p.size();
+        const size_t index = ("-" == token.name) ? N : token.index;
+        if (N < index) // also invalid index
+            throw error::SyntaxError("JSON patch array index out of range");
+
+        p.append().swap(jval);
+        for (size_t i = N; index < i; --i)
+            p[i].swap(p[i-1]);
+    }
+
+
+    /// @brief Remove the value.
+    /**
+    @param[in,out] root The root value.
+    @param[in] path The JSON pointer.
+    @return The removed value.
+    @throw error::SyntaxError if path is not found.
+    */
+    static Value take(Value &root, Pointer const& path)
+    {
+        Value res;
+        if (path.m_tokens.empty())
+        {
+            res.swap(root);
+            return res;
+        }
+
+        Value &p = parent(root, path);
+        Pointer::Token const& token = path.m_tokens.back();
+        Value *jval = const_cast<Value*>(Pointer::step(p, token));
+        if (!jval)
+            throw error::SyntaxError("JSON patch path not found");
+
+        res.swap(*jval);
+        if (Value::TYPE_OBJECT == p.getType())
+            p.removeMember(token.name);
+        else
+        {
+            const size_t N = p.size();
+            for (size_t i = token.index; i+1 < N; ++i)
+                p[i].swap(p[i+1]);
+            p.resize(N-1);
+        }
+
+        return res;
+    }
+};
+
+
+/// @brief The JSON events handler.
+/**
+This is base class for all SAX-style handlers used with Parser.
+All events are ignored by default.
+
+The Parser uses handlers as template parameter, so there are no virtual
+calls. Derived class just hides the events it's interested in:
+
+~~~{.cpp}
+class CountHandler:
+    public hive::json::Handler
+{
+public:
+    CountHandler()
+        : count(0)
+    {}
+
+    void onString(hive::String&)
+    {
+        count += 1;
+    }
+
+    size_t count;
+};
+
+void f(hive::String const& data)
+{
+    CountHandler h;
+    hive::json::Parser::parse(data.data(), data.data() + data.size(), h);
+    std::cout << h.count << " strings\n";
+}
+~~~
+
+The events are reported in document order. Each member value is
+preceded by onMemberName() event. The nested arrays and objects
+are reported between corresponding "begin" and "end" events.
+*/
+class Handler
+{
+public:
+
+    /// @brief The NULL value parsed.
+    void onNull()
+    {}
+
+
+    /// @brief The boolean value parsed.
+    /**
+    @param[in] val The boolean value.
+    */
+    void onBoolean(bool val)
+    {}
+
+
+    /// @brief The integer value parsed.
+    /**
+    @param[in] val The signed integer value.
+    */
+    void onInteger(Int64 val)
+    {}
+
+
+    /// @brief The big integer value parsed.
+    /**
+    This event is used for integers which don't fit signed 64 bits.
+
+    @param[in] val The unsigned integer value.
+    */
+    void onUInteger(UInt64 val)
+    {}
+
+
+    /// @brief The floating-point value parsed.
+    /**
+    @param[in] val The floating-point value.
+    */
+    void onDouble(double val)
+    {}
+
+
+    /// @brief The string value parsed.
+    /**
+    The string buffer is reused by parser,
+    so handler may take its content using swap().
+
+    @param[in,out] val The string value.
+    */
+    void onString(String &val)
+    {}
+
+public:
+
+    /// @brief The array started.
+    void onArrayBegin()
+    {}
+
+
+    /// @brief The array finished.
+    void onArrayEnd()
+    {}
+
+public:
+
+    /// @brief The object started.
+    void onObjectBegin()
+    {}
+
+
+    /// @brief The object member name parsed.
+    /**
+    The member value events will follow.
+
+    @param[in] name The member name.
+    */
+    void onMemberName(String const& name)
+    {}
+
+
+    /// @brief The object finished.
+    void onObjectEnd()
+    {}
+};
+
+
+/// @brief The JSON value builder.
+/**
+This events handler builds the JSON value.
+It's used by Parser to build the whole document.
+
+It's also possible to use this builder inside custom handlers
+to build any part of document, see isComplete() method.
+
+If the arena is provided all strings, arrays and objects
+are allocated from that arena (see Document).
+*/
+class ValueBuilder:
+    public Handler
+{
+public:
+
+    /// @brief The main constructor.
+    /**
+    @param[out] root The JSON value to build.
+    @param[in] arena The arena to allocate from. May be NULL.
+    */
+    explicit ValueBuilder(Value &root, Arena *arena = 0)
+        : m_slot(&root)
+        , m_arena(arena)
+        , m_complete(false)
+    {}
+
+
+    /// @brief Is the value complete?
+    /**
+    @return `true` if the whole value is built.
+    */
+    bool isComplete() const
+    {
+        return m_complete;
+    }
+
+public:
+
+    /// @copydoc Handler::onNull()
+    void onNull()
+    {
+        Value().swap(next());
+        commit();
+    }
+
+
+    /// @copydoc Handler::onBoolean()
+    void onBoolean(bool val)
+    {
+        Value(val).swap(next());
+        commit();
+    }
+
+
+    /// @copydoc Handler::onInteger()
+    void onInteger(Int64 val)
+    {
+        Value(val).swap(next());
+        commit();
+    }
+
+
+    /// @copydoc Handler::onUInteger()
+    void onUInteger(UInt64 val)
+    {
+        Value(val).swap(next());
+        commit();
+    }
+
+
+    /// @copydoc Handler::onDouble()
+    void onDouble(double val)
+    {
+        Value(val).swap(next());
+        commit();
+    }
+
+
+    /// @copydoc Handler::onString()
+    void onString(String &val)
+    {
+        Value &jval = next();
+        jval.setString(val, m_arena);
+        commit();
+    }
+
+public:
+
+    /// @copydoc Handler::onArrayBegin()
+    void onArrayBegin()
+    {
+        Value &jval = next();
+        jval.init(Value::TYPE_ARRAY, m_arena);
+        m_stack.push_back(&jval);
+    }
+
+
+    /// @copydoc Handler::onArrayEnd()
+    void onArrayEnd()
+    {
+        m_stack.pop_back();
+        commit();
+    }
+
+public:
+
+    /// @copydoc Handler::onObjectBegin()
+    void onObjectBegin()
+    {
+        Value &jval = next();
+        jval.init(Value::TYPE_OBJECT, m_arena);
+        m_stack.push_back(&jval);
+    }
+
+
+    /// @copydoc Handler::onMemberName()
+    /**
+    The member name is interned if #HIVE_JSON_INTERNED_KEYS macro is defined
+    and the global table limits allow (see KeyTable::tryIntern()).
+    */
+    void onMemberName(String const& name)
+    {
+#if defined(HIVE_JSON_INTERNED_KEYS)
+        if (String const* key = KeyTable::global().tryIntern(name.data(), name.size()))
+            m_slot = &(*m_stack.back())[*key];
+        else
+            m_slot = &(*m_stack.back())[name];
+#else
+        m_slot = &(*m_stack.back())[name];
+#endif // HIVE_JSON_INTERNED_KEYS
+    }
+
+
+    /// @copydoc Handler::onObjectEnd()
+    void onObjectEnd()
+    {
+        m_stack.pop_back();
+        commit();
+    }
+
+private:
+
+    /// @brief Get the next value to build.
+    /**
+    @return The new array element, the member value or the root value.
+    */
+    Value& next()
+    {
+        assert(!m_complete && "value is already complete");
+
+        if (!m_stack.empty() && m_stack.back()->getType() == Value::TYPE_ARRAY)
+        {
+            return m_stack.back()->append();
+        }
+
+        return *m_slot;
+    }
+
+
+    /// @brief The value is finished.
+    void commit()
+    {
+        if (m_stack.empty())
+            m_complete = true;
+    }
+
+private:
+    Value *m_slot; ///< @brief The current member value or root value.
+    Arena *m_arena; ///< @brief The arena or NULL.
+    std::vector<Value*> m_stack; ///< @brief The array and object stack.
+    bool m_complete; ///< @brief The "complete" flag.
+};
+
+
+/// @brief The JSON parser.
+/**
+description is under construction.
+*/
+class Parser
+{
+    /// @brief The string traits type.
+    typedef String::traits_type Traits;
+public:
+
+    /// @brief Parse the JSON value from the input stream.
+    /**
+    @param[in,out] is The input stream.
+    @param[out] jval The parsed JSON value.
+    @return The input stream.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    static IStream& parse(IStream &is, Value &jval)
+    {
+        skipCommentsAndWS(is);
+        Traits::int_type meta = is.peek();
+        if (Traits::eq_int_type(meta, Traits::eof()))
+            throw error::SyntaxError("no JSON value"); // not enough data
+
+        Traits::char_type cx = Traits::to_char_type(meta);
+
+        // object
+        if (Traits::eq(cx, '{'))
+        {
+            is.ignore(1); // ignore '{'
+            Value(Value::TYPE_OBJECT).swap(jval);
+            bool firstMember = true;
+
+            while (is)
+            {
+                skipCommentsAndWS(is);
+
+                cx = Traits::to_char_type(is.peek());
+                if (Traits::eq(cx, '}'))
+                {
+                    is.ignore(1); // ignore '}'
+                    break; // end of object
+                }
+
+                if (!firstMember) // check member separator
+                {
+                    if (Traits::eq(cx, ','))
+                    {
+                        is.ignore(1); // ingore ','
+                        skipCommentsAndWS(is);
+                    }
+                    else
+                        throw error::SyntaxError("no member separator");
+                }
+                else
+                    firstMember = false;
+
+                String memberName;
+                if (parseQuotedString(is, memberName))
+                {
+                    skipCommentsAndWS(is);
+
+                    cx = Traits::to_char_type(is.peek());
+                    if (Traits::eq(cx, ':'))
+                        is.ignore(1);
+                    else
+                        throw error::SyntaxError("no member value separator");
+
+                    Value memberValue;
+                    if (parse(is, memberValue))
+                        jval[memberName].swap(memberValue);
+                    else
+                        throw error::SyntaxError("no member value");
+                }
+                else
+                    throw error::SyntaxError("no member name");
+            }
+        }
+
+        // array
+        else if (Traits::eq(cx, '['))
+        {
+            is.ignore(1); // ignore '['
+            Value(Value::TYPE_ARRAY).swap(jval);
+            bool firstElement = true;
+
+            while (1)
+            {
+                skipCommentsAndWS(is);
+
+                cx = Traits::to_char_type(is.peek());
+                if (Traits::eq(cx, ']'))
+                {
+                    is.ignore(1); // ignore ']'
+                    break; // end of array
+                }
+
+                if (!firstElement)
+                {
+                    if (Traits::eq(cx, ','))
+                    {
+                        is.ignore(1); // ingore ','
+                        skipCommentsAndWS(is);
+                    }
+                    else
+                        throw error::SyntaxError("no element separator");
+                }
+                else
+                    firstElement = false;
+
+                Value elem;
+                if (parse(is, elem))
+                    jval.append().swap(elem);
+                else
+                    throw error::SyntaxError("no element value");
+            }
+        }
+
+        // number: integer or double
+        else if (misc::is_digit(cx) || Traits::eq(cx, '+') || Traits::eq(cx, '-'))
+        {
+            // collect all number characters
+            // long numbers are spilled to the string
+            char buf[64];
+            String tmp;
+            size_t len = 0;
+            while (1)
+            {
+                const Traits::int_type meta = is.peek();
+                if (Traits::eq_int_type(meta, Traits::eof()))
+                    break;
+
+                cx = Traits::to_char_type(meta);
+                if (!isNumberChar(cx))
+                    break;
+
+                if (len == sizeof(buf))
+                {
+                    tmp.append(buf, len);
+                    len = 0;
+                }
+
+                buf[len++] = cx;
+                is.ignore(1);
+            }
+
+            const char *first = buf;
+            const char *last = buf + len;
+            if (!tmp.empty())
+            {
+                tmp.append(buf, len);
+                first = tmp.data();
+                last = first + tmp.size();
+            }
+
+            if (!parseNumber(first, last, jval) || first != last)
+                throw error::SyntaxError("cannot parse number");
+        }
+
+        // string
+        else if (Traits::eq(cx, '\"'))
+        {
+            String val;
+            if (parseQuotedString(is, val))
+                Value(val).swap(jval);
+            else
+                throw error::SyntaxError("cannot parse string");
+        }
+
+        else if (Traits::eq(cx, 't') && match(is, "true"))
+        {
+            Value(true).swap(jval);
+        }
+
+        else if (Traits::eq(cx, 'f') && match(is, "false"))
+        {
+            Value(false).swap(jval);
+        }
+
+        else if (Traits::eq(cx, 'n') && match(is, "null"))
+        {
+            Value().swap(jval);
+        }
+
+        else
+        {
+            throw error::SyntaxError("no valid JSON value");
+        }
+
+        return is;
+    }
+
+
+    /// @brief Parse the JSON value from the memory buffer.
+    /**
+    The input is scanned in place using raw pointers,
+    no any stream is used. The input may be not NULL-terminated.
+
+    This method is useful to parse data which is already in memory,
+    for example the content of HTTP response.
+
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[out] jval The parsed JSON value.
+    @return The end of parsed data.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    static const char* parse(const char *first, const char *last, Value &jval)
+    {
+        ValueBuilder builder(jval);
+        return parse(first, last, builder);
+    }
+
+
+    /// @brief Parse the JSON value from the memory buffer using arena.
+    /**
+    All strings, arrays and objects are allocated from the @a arena,
+    so the @a arena should live longer than the parsed value.
+
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[out] jval The parsed JSON value.
+    @param[in] arena The arena to allocate from.
+    @return The end of parsed data.
+    @throw error::SyntaxError in case of parsing error.
+    @see Document
+    */
+    static const char* parse(const char *first, const char *last, Value &jval, Arena &arena)
+    {
+        ValueBuilder builder(jval, &arena);
+        return parse(first, last, builder);
+    }
+
+
+    /// @brief Parse the JSON events from the memory buffer.
+    /**
+    This is SAX-style parser: no any JSON value is created,
+    the @a handler is notified about each parsed token instead.
+    See Handler class for the list of events.
+
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[in,out] handler The events handler.
+    @return The end of parsed data.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    template<typename HandlerT>
+    static const char* parse(const char *first, const char *last, HandlerT &handler)
+    {
+        String buf; // shared by all strings
+        return parseEvents(first, last, handler, buf);
+    }
+
+private:
+
+    /// @brief Parse the JSON events from the memory buffer.
+    /**
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[in,out] handler The events handler.
+    @param[in,out] buf The auxiliary string buffer.
+    @return The end of parsed data.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    template<typename HandlerT>
+    static const char* parseEvents(const char *first, const char *last, HandlerT &handler, String &buf)
+    {
+        if (!skipCommentsAndWS(first, last))
+            throw error::SyntaxError("no JSON value"); // not enough data
+
+        char cx = *first;
+
+        // object
+        if ('{' == cx)
+        {
+            ++first; // ignore '{'
+            handler.onObjectBegin();
+            bool firstMember = true;
+
+            while (1)
+            {
+                if (!skipCommentsAndWS(first, last))
+                    throw error::SyntaxError("no end of object");
+
+                cx = *first;
+                if ('}' == cx)
+                {
+                    ++first; // ignore '}'
+                    break; // end of object
+                }
+
+                if (!firstMember) // check member separator
+                {
+                    if (',' == cx)
+                    {
+                        ++first; // ignore ','
+                        skipCommentsAndWS(first, last);
+                    }
+                    else
+                        throw error::SyntaxError("no member separator");
+                }
+                else
+                    firstMember = false;
+
+                if (first != last && ('\"' == *first || '\'' == *first)
+                    && parseQuotedString(first, last, buf))
+                {
+                    if (!skipCommentsAndWS(first, last) || ':' != *first)
+                        throw error::SyntaxError("no member value separator");
+                    ++first; // ignore ':'
+
+                    handler.onMemberName(buf);
+                    first = parseEvents(first, last, handler, buf);
+                }
+                else
+                    throw error::SyntaxError("no member name");
+            }
+
+            handler.onObjectEnd();
+        }
+
+        // array
+        else if ('[' == cx)
+        {
+            ++first; // ignore '['
+            handler.onArrayBegin();
+            bool firstElement = true;
+
+            while (1)
+            {
+                if (!skipCommentsAndWS(first, last))
+                    throw error::SyntaxError("no end of array");
+
+                cx = *first;
+                if (']' == cx)
+                {
+                    ++first; // ignore ']'
+                    break; // end of array
+                }
+
+                if (!firstElement)
+                {
+                    if (',' == cx)
+                    {
+                        ++first; // ignore ','
+                        skipCommentsAndWS(first, last);
+                    }
+                    else
+                        throw error::SyntaxError("no element separator");
+                }
+                else
+                    firstElement = false;
+
+                first = parseEvents(first, last, handler, buf);
+            }
+
+            handler.onArrayEnd();
+        }
+
+        // number: integer or double
+        else if (misc::is_digit(cx) || '+' == cx || '-' == cx)
+        {
+            Value num;
+            if (!parseNumber(first, last, num))
+                throw error::SyntaxError("cannot parse number");
+
+            if (num.isDouble())
+                handler.onDouble(num.asDouble());
+            else if (num.isUInteger()) // greater than Int64 maximum
+                handler.onUInteger(num.asUInt());
+            else
+                handler.onInteger(num.asInt());
+        }
+
+        // string
+        else if ('\"' == cx)
+        {
+            if (parseQuotedString(first, last, buf))
+                handler.onString(buf);
+            else
+                throw error::SyntaxError("cannot parse string");
+        }
+
+        else if ('t' == cx && match(first, last, "true"))
+        {
+            handler.onBoolean(true);
+        }
+
+        else if ('f' == cx && match(first, last, "false"))
+        {
+            handler.onBoolean(false);
+        }
+
+        else if ('n' == cx && match(first, last, "null"))
+        {
+            handler.onNull();
+        }
+
+        else
+        {
+            throw error::SyntaxError("no valid JSON value");
+        }
+
+        return first;
+    }
+
+public:
+
+    /// @brief Skip whitespaces and comments
+    /**
+    @param[in,out] is The input stream.
+    @return `false` if end of stream.
+    @throw error::SyntaxError in case of invalid comment style
+    */
+    static bool skipCommentsAndWS(IStream &is)
+    {
+        // the maximum stream size
+        const std::streamsize UP_TO_END = std::numeric_limits<std::streamsize>::max();
+
+        while (is)
+        {
+            Traits::int_type meta = (is >> std::ws).peek();
+            if (Traits::eq_int_type(meta, Traits::eof()))
+                return false; // end of stream
+
+            Traits::char_type cx = Traits::to_char_type(meta);
+
+            // '#' comment
+            if (Traits::eq(cx, '#'))
+            {
+                // ignore all the line
+                is.ignore(UP_TO_END, '\n');
+            }
+
+            // C/C++ comments
+            else if (Traits::eq(cx, '/'))
+            {
+                is.ignore(1); // ignore first '/'
+
+                meta = is.peek();
+                if (Traits::eq_int_type(meta, Traits::eof()))
+                    return false; // end of stream
+
+                cx = Traits::to_char_type(meta);
+                if (Traits::eq(cx, '/')) // C++ style: one line
+                {
+                    // ignore all the line
+                    is.ignore(UP_TO_END, '\n');
+                }
+                else if (Traits::eq(cx, '*')) // C style: /* ... */
+                {
+                    is.ignore(1); // ignore '*'
+                    while (1) // search for "*/"
+                    {
+                        // skip all until '*'
+                        is.ignore(UP_TO_END, '*');
+
+                        meta = is.peek();
+                        if (Traits::eq_int_type(meta, Traits::eof()))
+                            return false; // end of stream
+
+                        cx = Traits::to_char_type(meta);
+                        if (Traits::eq(cx, '/'))
+                        {
+                            is.ignore(1); // ignore '/'
+                            break;
+                        }
+                    }
+                }
+                else
+                    throw error::SyntaxError("unknown comment style");
+            }
+
+            else
+                return true; // OK
+        }
+
+        return false;
+    }
+
+
+    /// @brief Parse quoted string from the input stream.
+    /**
+    @param[in,out] is The input stream.
+    @param[out] str The parsed string.
+    @return `true` if string successfully parsed.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    static bool parseQuotedString(IStream &is, String &str)
+    {
+        // remember the "quote" character
+        const Traits::char_type QUOTE = Traits::to_char_type(is.get());
+
+        OStringStream oss;
+        while (is)
+        {
+            Traits::int_type meta = is.get();
+            if (Traits::eq_int_type(meta, Traits::eof()))
+                return false; // end of stream
+
+            Traits::char_type ch = Traits::to_char_type(meta);
+            if (ch == QUOTE)
+            {
+                str = oss.str();
+
+                // validate UTF-8
+                const char *p = str.data();
+                const char *p_end = p + str.size();
+                for (; p != p_end; ++p)
+                {
+                    if (0x80 <= UInt8(*p))
+                    {
+                        const int len = misc::utf8_check(p, p_end);
+                        if (len <= 0)
+                            throw error::SyntaxError("invalid UTF-8 sequence in a string");
+                        p += len-1;
+                    }
+                }
+
+                return true; // OK
+            }
+
+            else if (ch == '\\') // escape
+            {
+                meta = is.get();
+                if (Traits::eq_int_type(meta, Traits::eof()))
+                    return false; // end of stream
+
+                ch = Traits::to_char_type(meta);
+                switch (ch)
+                {
+                    case '"':  oss.put('"');  break;
+                    case '\'': oss.put('\''); break;
+                    case '/':  oss.put('/');  break;
+                    case '\\': oss.put('\\'); break;
+                    case 'b':  oss.put('\b'); break;
+                    case 'f':  oss.put('\f'); break;
+                    case 'n':  oss.put('\n'); break;
+                    case 'r':  oss.put('\r'); break;
+                    case 't':  oss.put('\t'); break;
+
+                    case 'u':
+                    {
+                        // "XXXX" or "XXXX\uXXXX" for surrogate pair
+                        char buf[10];
+                        size_t n = readChars(is, buf, 4);
+                        if (4 == n && 0xD == misc::hex2int(buf[0]))
+                        {
+                            const int x = misc::hex2int(buf[1]);
+                            if (0x8 <= x && x <= 0xB) // high surrogate
+                                n += readChars(is, buf+n, 6);
+                        }
+
+                        const char *p = buf;
+                        String cp;
+                        if (!parseUnicodeEscape(p, buf+n, cp))
+                            return false; // end of stream
+                        oss.write(cp.data(), cp.size());
+                    } break;
+
+                    default:
+                        throw error::SyntaxError("bad escape sequence in a string");
+                }
+            }
+
+            else
+                oss.put(ch); // just save
+        }
+
+        return false;
+    }
+
+
+    /// @brief Read a few characters from the input stream.
+    /**
+    @param[in,out] is The input stream.
+    @param[out] buf The output buffer.
+    @param[in] len The maximum number of characters to read.
+    @return The number of characters read.
+    */
+    static size_t readChars(IStream &is, char *buf, size_t len)
+    {
+        size_t n = 0;
+        for (; n < len; ++n)
+        {
+            const Traits::int_type meta = is.get();
+            if (Traits::eq_int_type(meta, Traits::eof()))
+                break; // end of stream
+            buf[n] = Traits::to_char_type(meta);
+        }
+
+        return n;
+    }
+
+
+    /// @brief Match the input with the pattern.
+    /**
+    @param[in,out] is The input stream.
+    @param[in] pattern The pattern to match.
+    @return `true` if matched, `false` if not match or end of stream.
+    */
+    static bool match(IStream &is, const char *pattern)
+    {
+        for (size_t i = 0; pattern[i]; ++i)
+        {
+            const Traits::int_type meta = is.peek();
+            if (Traits::eq_int_type(meta, Traits::eof()))
+                return false; // end of stream
+
+            const Traits::char_type ch = Traits::to_char_type(meta);
+            if (!Traits::eq(ch, pattern[i]))
+            {
+                //for (; 0 < i; --i) // rollback
+                //    is.putback(pattern[i-1]);
+
+                return false; // doesn't match
+            }
+            else
+                is.ignore(1);
+        }
+
+        return true; // match
+    }
+
+public:
+
+    /// @brief Skip whitespaces and comments (memory buffer).
+    /**
+    @param[in,out] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @return `false` if end of buffer.
+    @throw error::SyntaxError in case of invalid comment style
+    */
+    static bool skipCommentsAndWS(const char *&first, const char *last)
+    {
+        while (first != last)
+        {
+            const char cx = *first;
+
+            // whitespaces
+            if (' ' == cx || '\t' == cx || '\n' == cx || '\r' == cx
+                || '\f' == cx || '\v' == cx)
+            {
+                first = scanWhitespaces(first + 1, last);
+            }
+
+            // '#' comment
+            else if ('#' == cx)
+            {
+                // ignore all the line
+                first = std::find(first, last, '\n');
+            }
+
+            // C/C++ comments
+            else if ('/' == cx)
+            {
+                if (++first == last) // ignore first '/'
+                    return false; // end of buffer
+
+                if ('/' == *first) // C++ style: one line
+                {
+                    // ignore all the line
+                    first = std::find(first, last, '\n');
+                }
+                else if ('*' == *first) // C style: /* ... */
+                {
+                    ++first; // ignore '*'
+                    while (1) // search for "*/"
+                    {
+                        // skip all until '*'
+                        first = std::find(first, last, '*');
+                        if (first == last || ++first == last)
+                            return false; // end of buffer
+
+                        if ('/' == *first)
+                        {
+                            ++first; // ignore '/'
+                            break;
+                        }
+                    }
+                }
+                else
+                    throw error::SyntaxError("unknown comment style");
+            }
+
+            else
+                return true; // OK
+        }
+
+        return false; // end of buffer
+    }
+
+
+    /// @brief Parse quoted string from the memory buffer.
+    /**
+    The string content is copied directly from the input buffer.
+    Only escaped parts and non-ASCII characters are processed
+    character by character. The `\uXXXX` escape sequences
+    (including surrogate pairs) are decoded to UTF-8.
+    The UTF-8 sequences are validated.
+
+    @param[in,out] first The begin of input buffer.
+        Should point to the opening quote.
+    @param[in] last The end of input buffer.
+    @param[out] str The parsed string.
+    @return `true` if string successfully parsed.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    static bool parseQuotedString(const char *&first, const char *last, String &str)
+    {
+        if (first == last)
+            return false; // end of buffer
+
+        // remember the "quote" character
+        const char QUOTE = *first++;
+
+        // fast path: no escape sequences
+        const char *p = scanString(first, last, QUOTE);
+        if (p == last)
+            return false; // end of buffer
+
+        str.assign(first, p);
+        first = p;
+
+        // slow path: decode escape sequences
+        while (first != last)
+        {
+            char ch = *first++;
+            if (ch == QUOTE)
+                return true; // OK
+
+            else if (ch == '\\') // escape
+            {
+                if (first == last)
+                    return false; // end of buffer
+
+                ch = *first++;
+                switch (ch)
+                {
+                    case '"':  str.push_back('"');  break;
+                    case '\'': str.push_back('\''); break;
+                    case '/':  str.push_back('/');  break;
+                    case '\\': str.push_back('\\'); break;
+                    case 'b':  str.push_back('\b'); break;
+                    case 'f':  str.push_back('\f'); break;
+                    case 'n':  str.push_back('\n'); break;
+                    case 'r':  str.push_back('\r'); break;
+                    case 't':  str.push_back('\t'); break;
+
+                    case 'u':
+                        if (!parseUnicodeEscape(first, last, str))
+                            return false; // end of buffer
+                        break;
+
+                    default:
+                        throw error::SyntaxError("bad escape sequence in a string");
+                }
+            }
+
+            else
+            {
+                // copy the whole run of regular, control
+                // and non-ASCII characters at once
+                const char *p = --first;
+                while (p != last && QUOTE != *p && '\\' != *p)
+                {
+                    if (0x80 <= UInt8(*p)) // UTF-8 sequence
+                    {
+                        const int len = misc::utf8_check(p, last);
+                        if (len < 0)
+                            throw error::SyntaxError("invalid UTF-8 sequence in a string");
+                        else if (0 == len)
+                            return false; // end of buffer
+                        p += len;
+                    }
+                    else if (UInt8(*p) < 0x20) // control character
+                        ++p;
+                    else
+                        p = scanString(p, last, QUOTE);
+                }
+
+                str.append(first, p);
+                first = p;
+            }
+        }
+
+        return false; // end of buffer
+    }
+
+
+    /// @brief Decode the unicode escape sequence.
+    /**
+    The surrogate pair `\uD83D\uDE00` is decoded as one code point.
+
+    @param[in,out] first The begin of input buffer, just after the `\u` prefix.
+    @param[in] last The end of input buffer.
+    @param[in,out] str The output string. The UTF-8 sequence is appended.
+    @return `true` if decoded, `false` if the end of buffer is reached.
+    @throw error::SyntaxError in case of invalid escape sequence.
+    */
+    static bool parseUnicodeEscape(const char *&first, const char *last, String &str)
+    {
+        const char *p = first;
+
+        UInt32 cp = 0;
+        if (!parseHex4(p, last, cp))
+            return false; // end of buffer
+
+        if (0xD800 <= cp && cp <= 0xDBFF) // high surrogate
+        {
+            if (last - p < 2)
+                return false; // end of buffer
+            if ('\\' != p[0] || 'u' != p[1])
+                throw error::SyntaxError("invalid surrogate pair in a string");
+            p += 2;
+
+            UInt32 low = 0;
+            if (!parseHex4(p, last, low))
+                return false; // end of buffer
+            if (low < 0xDC00 || 0xDFFF < low)
+                throw error::SyntaxError("invalid surrogate pair in a string");
+
+            cp = 0x10000 + ((cp - 0xD800)<<10) + (low - 0xDC00);
+        }
+        else if (0xDC00 <= cp && cp <= 0xDFFF) // low surrogate
+            throw error::SyntaxError("invalid surrogate pair in a string");
+
+        misc::utf8_append(str, cp);
+        first = p;
+        return true;
+    }
+
+
+    /// @brief Parse four hexadecimal digits.
+    /**
+    @param[in,out] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[out] val The parsed value.
+    @return `true` if parsed, `false` if the end of buffer is reached.
+    @throw error::SyntaxError in case of non-hexadecimal digit.
+    */
+    static bool parseHex4(const char *&first, const char *last, UInt32 &val)
+    {
+        if (last - first < 4)
+            return false; // end of buffer
+
+        val = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            const int x = misc::hex2int(first[i]);
+            if (x < 0)
+                throw error::SyntaxError("bad unicode escape sequence in a string");
+            val = (val<<4) | UInt32(x);
+        }
+
+        first += 4;
+        return true;
+    }
+
+
+    /// @brief Parse number from the memory buffer.
+    /**
+    The integer values are parsed as Int64 or UInt64.
+    The values with fraction or exponent part and
+    too big integers are parsed as floating-point.
+
+    @param[in,out] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[out] jval The parsed JSON value.
+    @return `true` if number successfully parsed.
+    */
+    static bool parseNumber(const char *&first, const char *last, Value &jval)
+    {
+        const char *p = first;
+
+        // optional sign
+        bool negative = false;
+        if (p != last && ('+' == *p || '-' == *p))
+            negative = ('-' == *p++);
+
+        // integer part
+        const char *digits = p;
+        const UInt64 UMAX = std::numeric_limits<UInt64>::max();
+        bool overflow = false;
+        UInt64 u = 0;
+
+        // up to 16 digits are converted 8 at a time - no overflow possible
+        for (int i = 0; i < 2 && 8 <= (last-p) && parseDigits8(p, u); ++i)
+            p += 8;
+
+        for (; p != last && misc::is_digit(*p); ++p)
+        {
+            const UInt64 d = (*p - '0');
+            if (u <= (UMAX - d)/10)
+                u = 10*u + d;
+            else
+                overflow = true;
+        }
+        if (p == digits)
+            return false; // no digits
+
+        bool floating = overflow;
+
+        // fraction part
+        if (p != last && '.' == *p)
+        {
+            const char *fraction = ++p;
+            while (p != last && misc::is_digit(*p))
+                ++p;
+            if (p == fraction)
+                return false; // no digits
+            floating = true;
+        }
+
+        // exponent part
+        if (p != last && ('e' == *p || 'E' == *p))
+        {
+            if (++p != last && ('+' == *p || '-' == *p))
+                ++p;
+            const char *exponent = p;
+            while (p != last && misc::is_digit(*p))
+                ++p;
+            if (p == exponent)
+                return false; // no digits
+            floating = true;
+        }
+
+        const UInt64 IMIN = UInt64(std::numeric_limits<Int64>::max()) + 1;
+        if (!floating && negative && IMIN < u)
+            floating = true; // too big negative integer
+
+        if (floating)
+        {
+            // strtod() needs NULL-terminated string
+            char buf[64];
+            String tmp;
+            const size_t len = p - first;
+            const char *str = buf;
+            if (len < sizeof(buf))
+            {
+                std::copy(first, p, buf);
+                buf[len] = 0;
+            }
+            else
+            {
+                tmp.assign(first, p);
+                str = tmp.c_str();
+            }
+
+            double val = 0.0;
+            const char *dp = localeconv()->decimal_point;
+            if ('.' == dp[0] && 0 == dp[1])
+            {
+                char *end = 0;
+                val = strtod(str, &end);
+                if (end != str + len)
+                    return false; // cannot parse
+            }
+            else // locale specific decimal point, strtod() doesn't work
+            {
+                IStringStream iss(str);
+                iss.imbue(std::locale::classic());
+                if (!(iss >> val) || iss.peek() != IStringStream::traits_type::eof())
+                    return false; // cannot parse
+            }
+            Value(val).swap(jval);
+        }
+        else if (negative)
+            Value(Int64(0 - u)).swap(jval);
+        else
+            Value(u).swap(jval);
+
+        first = p;
+        return true;
+    }
+
+
+    /// @brief Match the memory buffer with the pattern.
+    /**
+    @param[in,out] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[in] pattern The pattern to match.
+    @return `true` if matched, `false` if not match or end of buffer.
+    */
+    static bool match(const char *&first, const char *last, const char *pattern)
+    {
+        const char *p = first;
+        for (size_t i = 0; pattern[i]; ++i, ++p)
+        {
+            if (p == last || *p != pattern[i])
+                return false; // doesn't match
+        }
+
+        first = p;
+        return true; // match
+    }
+
+private:
+    template<typename> friend class IncrementalParser;
+    friend class ArrayParser;
+
+    /// @brief Skip all whitespaces.
+    /**
+    Only whitespaces are skipped, comments are handled by the caller.
+
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @return The first non-whitespace character or @a last.
+    */
+    static const char* scanWhitespaces(const char *first, const char *last)
+    {
+#if defined(IMPL_HIVE_JSON_SSE2)
+        // most whitespace runs are short, so check the next byte first
+        if (first != last && !isWhitespace(*first))
+            return first;
+
+        const __m128i SP = _mm_set1_epi8(' ');
+        const __m128i TAB = _mm_set1_epi8('\t');
+        const __m128i CR_TAB = _mm_set1_epi8('\r' - '\t'); // [\t..\r]
+        for (; 16 <= (last-first); first += 16)
+        {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const __m128i t = _mm_sub_epi8(x, TAB);
+            const __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(x, SP),
+                _mm_cmpeq_epi8(_mm_min_epu8(t, CR_TAB), t));
+            const unsigned int mask = ~_mm_movemask_epi8(ws) & 0xFFFF;
+            if (mask)
+                return first + ctz(mask);
+        }
+#endif // IMPL_HIVE_JSON_SSE2
+
+        while (first != last && isWhitespace(*first))
+            ++first;
+        return first;
+    }
+
+
+    /// @brief Find the end of regular string characters.
+    /**
+    Searches for the @a quote, backslash, control or non-ASCII character.
+    Control characters are reported to be checked by the caller
+    and may be treated as regular characters. Non-ASCII characters
+    are reported to be validated as UTF-8 sequences.
+
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[in] quote The quote character.
+    @return The first special character or @a last.
+    */
+    static const char* scanString(const char *first, const char *last, char quote)
+    {
+#if defined(IMPL_HIVE_JSON_SSE2)
+        const __m128i Q = _mm_set1_epi8(quote);
+        const __m128i BS = _mm_set1_epi8('\\');
+        const __m128i CTL = _mm_set1_epi8(0x1F);
+        for (; 16 <= (last-first); first += 16)
+        {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const __m128i m = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(x, Q), _mm_cmpeq_epi8(x, BS)),
+                _mm_cmpeq_epi8(_mm_min_epu8(x, CTL), x)); // x <= 0x1F
+            const unsigned int mask = _mm_movemask_epi8(m)
+                | _mm_movemask_epi8(x); // x >= 0x80
+            if (mask)
+                return first + ctz(mask);
+        }
+#else
+        // SWAR: check 8 bytes at a time
+        const UInt64 ONES = 0x0101010101010101ULL;
+        const UInt64 HIGH = 0x8080808080808080ULL;
+        const UInt64 Q = ONES*UInt8(quote);
+        const UInt64 BS = ONES*UInt8('\\');
+        for (; 8 <= (last-first); first += 8)
+        {
+            UInt64 x;
+            memcpy(&x, first, sizeof(x));
+            const UInt64 xq = x^Q;
+            const UInt64 xb = x^BS;
+            const UInt64 m = ((xq - ONES) & ~xq)
+                | ((xb - ONES) & ~xb)
+                | ((x - ONES*0x20) & ~x)
+                | x; // x >= 0x80
+            if (m & HIGH)
+                break; // exact position is found below
+        }
+#endif // IMPL_HIVE_JSON_SSE2
+
+        for (; first != last; ++first)
+        {
+            const char ch = *first;
+            if (ch == quote || '\\' == ch || UInt8(ch) < 0x20 || 0x80 <= UInt8(ch))
+                break;
+        }
+        return first;
+    }
+
+
+    /// @brief Convert eight decimal digits at once.
+    /**
+    @param[in] p The input buffer, at least 8 bytes are available.
+    @param[in,out] val The accumulated integer value.
+    @return `true` if all 8 characters are digits, `false` otherwise
+        (in that case @a val is untouched).
+    */
+    static bool parseDigits8(const char *p, UInt64 &val)
+    {
+        const UInt16 ENDIAN_TEST = 1;
+        if (1 != *reinterpret_cast<const UInt8*>(&ENDIAN_TEST))
+            return false; // little-endian only, use the slow path
+
+        UInt64 x;
+        memcpy(&x, p, sizeof(x));
+
+        // all bytes should be in ['0'..'9'] range
+        if (((x & 0xF0F0F0F0F0F0F0F0ULL)
+            | (((x + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+                != 0x3333333333333333ULL)
+        {
+            return false;
+        }
+
+        // combine digits pairwise: 1-digit -> 2-digit -> 4-digit -> 8-digit
+        x -= 0x3030303030303030ULL;
+        x = (x*10 + (x >> 8)) & 0x00FF00FF00FF00FFULL;
+        x = (x*100 + (x >> 16)) & 0x0000FFFF0000FFFFULL;
+        x = (x*10000 + (x >> 32)) & 0x00000000FFFFFFFFULL;
+
+        val = val*100000000ULL + x;
+        return true;
+    }
+
+
+    /// @brief Check for the whitespace character.
+    /**
+    @param[in] ch The character to test.
+    @return `true` if character is whitespace.
+    */
+    static bool isWhitespace(char ch)
+    {
+        return ' ' == ch || '\t' == ch || '\n' == ch
+            || '\r' == ch || '\f' == ch || '\v' == ch;
+    }
+
+
+#if defined(IMPL_HIVE_JSON_SSE2)
+    /// @brief Count trailing zero bits.
+    /**
+    @param[in] mask The non-zero bit mask.
+    @return The index of the lowest bit set.
+    */
+    static unsigned int ctz(unsigned int mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return __builtin_ctz(mask);
+#endif // _MSC_VER
+    }
+#endif // IMPL_HIVE_JSON_SSE2
+
+
+    /// @brief Check for the number character.
+    /**
+    @param[in] ch The character to test.
+    @return `true` if character might be a part of number.
+    */
+    static bool isNumberChar(int ch)
+    {
+        return misc::is_digit(ch)
+            || '+' == ch || '-' == ch || '.' == ch
+            || 'e' == ch || 'E' == ch;
+    }
+};
+
+
+/// @brief Parse JSON value from the input stream.
+/** @relates Value
+@param[in,out] is The input stream.
+@param[in,out] jval The JSON value.
+@return The input stream.
+@throw error::SyntaxError in case of parsing error.
 */
-inline bool operator==(Value const& a, Value const& b)
+inline IStream& operator>>(IStream &is, Value &jval)
 {
-    return a.equal(b);
+    return Parser::parse(is, jval);
+}
+
+
+/// @brief Convert memory buffer to JSON value.
+/**
+The buffer is parsed in place, no any copy is made.
+
+@param[in] data The JSON data.
+@param[in] len The JSON data length in bytes.
+@return The parsed JSON value.
+@throw error::SyntaxError in case of parsing error.
+*/
+inline Value str2json(const char *data, size_t len)
+{
+    const char *last = data + len;
+
+    Value jval;
+    const char *end = Parser::parse(data, last, jval);
+    if (Parser::skipCommentsAndWS(end, last)) // check is 'data' fully parsed
+        throw error::SyntaxError("partially parsed");
+    return jval;
+}
+
+
+/// @brief Convert string to JSON value.
+/**
+@param[in] str The JSON string.
+@return The parsed JSON value.
+@throw error::SyntaxError in case of parsing error.
+*/
+inline Value str2json(String const& str)
+{
+    return str2json(str.data(), str.size());
+}
+
+
+/// @brief Parse memory buffer with events handler.
+/**
+@param[in] data The JSON data.
+@param[in] len The JSON data length in bytes.
+@param[in,out] handler The events handler.
+@throw error::SyntaxError in case of parsing error.
+@see Handler
+*/
+template<typename HandlerT>
+inline void str2json(const char *data, size_t len, HandlerT &handler)
+{
+    const char *last = data + len;
+
+    const char *end = Parser::parse(data, last, handler);
+    if (Parser::skipCommentsAndWS(end, last)) // check is 'data' fully parsed
+        throw error::SyntaxError("partially parsed");
 }
 
 
-/// @brief Are two JSON values different?
-/** @relates Value
-@param[in] a The first JSON value.
-@param[in] b The second JSON value.
-@return `true` if two JSON values are different.
-@see Value::equal()
-*/
-inline bool operator!=(Value const& a, Value const& b)
-{
-    return !(a == b);
-}
+/// @brief The incremental JSON parser.
+/**
+This parser is fed by arbitrary chunks of data as they arrive,
+for example from network. The handler is notified about each
+parsed token as soon as it's complete (see Handler).
+
+The parser is a state machine with an explicit stack of open arrays
+and objects, so no data is parsed twice. Only a token (string or number)
+split between two chunks is buffered until its end is received.
+Tokens entirely inside one chunk are parsed in-place.
+
+~~~{.cpp}
+json::Value jval;
+json::ValueBuilder builder(jval);
+json::IncrementalParser<json::ValueBuilder> parser(builder);
+
+while (read(chunk))
+    parser.feed(chunk.data(), chunk.size());
+parser.finish(); // all data received
+~~~
+
+The top-level number is complete only when finish() is called,
+since the next chunk might contain more digits.
+*/
+template<typename HandlerT>
+class IncrementalParser:
+    private NonCopyable
+{
+public:
+
+    /// @brief The main constructor.
+    /**
+    @param[in,out] handler The events handler.
+    */
+    explicit IncrementalParser(HandlerT &handler)
+        : m_handler(handler)
+    {
+        reset();
+    }
+
+
+    /// @brief Reset the parser to parse new document.
+    /**
+    The handler is not reset.
+    */
+    void reset()
+    {
+        m_state = STATE_VALUE;
+        m_comment = COMMENT_NONE;
+        m_stack.clear();
+        m_token.clear();
+        m_quote = 0;
+        m_escape = false;
+        m_literal = 0;
+        m_literalType = 0;
+    }
+
+
+    /// @brief Is the document complete?
+    /**
+    @return `true` if the whole document is parsed.
+    */
+    bool isComplete() const
+    {
+        return STATE_DONE == m_state;
+    }
+
+public:
+
+    /// @brief Parse the next chunk of data.
+    /**
+    Only whitespaces and comments are accepted after the document is complete.
+
+    @param[in] data The chunk data.
+    @param[in] len The chunk length in bytes.
+    @return `true` if the whole document is parsed.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    bool feed(const char *data, size_t len)
+    {
+        const char *first = data;
+        const char *last = data + len;
+
+        while (first != last)
+        {
+            if (COMMENT_NONE != m_comment)
+                first = parseComment(first, last);
+            else switch (m_state)
+            {
+                case STATE_STRING:
+                case STATE_NAME:
+                    first = parseString(first, last);
+                    break;
+
+                case STATE_NUMBER:
+                    first = parseNumber(first, last);
+                    break;
+
+                case STATE_LITERAL:
+                    first = parseLiteral(first, last);
+                    break;
+
+                default:
+                    first = parseToken(first, last);
+                    break;
+            }
+        }
+
+        return isComplete();
+    }
+
+
+    /// @brief No more data.
+    /**
+    Completes the top-level number if any.
+
+    @throw error::SyntaxError if document is not complete.
+    */
+    void finish()
+    {
+        if (STATE_NUMBER == m_state && m_stack.empty())
+            numberDone(m_token.data(), m_token.data() + m_token.size());
+
+        if (!isComplete())
+            throw error::SyntaxError("unexpected end of JSON data");
+    }
+
+private:
+
+    /// @brief Parse the structural token or start new value.
+    /**
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @return The end of parsed data.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    const char* parseToken(const char *first, const char *last)
+    {
+        const char cx = *first;
+
+        if (' ' == cx || '\t' == cx || '\n' == cx || '\r' == cx
+            || '\f' == cx || '\v' == cx)
+        {
+            return Parser::scanWhitespaces(first + 1, last);
+        }
+        else if ('#' == cx)
+        {
+            m_comment = COMMENT_LINE;
+            return first + 1;
+        }
+        else if ('/' == cx)
+        {
+            m_comment = COMMENT_SLASH;
+            return first + 1;
+        }
+
+        switch (m_state)
+        {
+            case STATE_VALUE:
+                return beginValue(first, last);
+
+            case STATE_ARRAY_FIRST:
+                if (']' == cx)
+                {
+                    containerDone();
+                    return first + 1;
+                }
+                return beginValue(first, last);
+
+            case STATE_OBJECT_FIRST:
+                if ('}' == cx)
+                {
+                    containerDone();
+                    return first + 1;
+                }
+                return beginName(first, last);
+
+            case STATE_MEMBER:
+                return beginName(first, last);
+
+            case STATE_COLON:
+                if (':' != cx)
+                    throw error::SyntaxError("no member value separator");
+                m_state = STATE_VALUE;
+                return first + 1;
+
+            case STATE_NEXT:
+            {
+                const bool inArray = ('[' == m_stack.back());
+                if (',' == cx)
+                {
+                    m_state = inArray ? STATE_VALUE : STATE_MEMBER;
+                    return first + 1;
+                }
+                if ((inArray ? ']' : '}') == cx)
+                {
+                    containerDone();
+                    return first + 1;
+                }
+                throw error::SyntaxError(inArray
+                    ? "no element separator"
+                    : "no member separator");
+            }
+
+            default: // STATE_DONE
+                throw error::SyntaxError("partially parsed");
+        }
+    }
+
+
+    /// @brief Start new value.
+    /**
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @return The end of parsed data.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    const char* beginValue(const char *first, const char *last)
+    {
+        const char cx = *first;
+
+        if ('{' == cx)
+        {
+            m_handler.onObjectBegin();
+            m_stack.push_back(cx);
+            m_state = STATE_OBJECT_FIRST;
+            return first + 1;
+        }
+        else if ('[' == cx)
+        {
+            m_handler.onArrayBegin();
+            m_stack.push_back(cx);
+            m_state = STATE_ARRAY_FIRST;
+            return first + 1;
+        }
+        else if (misc::is_digit(cx) || '+' == cx || '-' == cx)
+        {
+            m_token.clear();
+            m_state = STATE_NUMBER;
+            return parseNumber(first, last);
+        }
+        else if ('\"' == cx)
+            return beginString(first, last, STATE_STRING);
+        else if ('t' == cx)
+            m_literal = "true";
+        else if ('f' == cx)
+            m_literal = "false";
+        else if ('n' == cx)
+            m_literal = "null";
+        else
+            throw error::SyntaxError("no valid JSON value");
 
+        m_literalType = cx;
+        m_state = STATE_LITERAL;
+        return parseLiteral(first, last);
+    }
 
 
-/// @brief The basic JSON formatter.
-/**
-description is under construction.
+    /// @brief Start new member name.
+    /**
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @return The end of parsed data.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    const char* beginName(const char *first, const char *last)
+    {
+        if ('\"' != *first && '\'' != *first)
+            throw error::SyntaxError("no member name");
+        return beginString(first, last, STATE_NAME);
+    }
 
-Writes JSON value in compact format without spaces and new lines.
-*/
-class Formatter
-{
-public:
 
-    /// @brief Write the JSON value to the output stream.
+    /// @brief Start new string.
     /**
-    In "human friendly" format there also the line feeds and indents in the output.
-    Otherwise no any indents or spaces are used.
+    The string is parsed in-place if it's complete.
+    Otherwise it's buffered.
 
-    @param[in,out] os The output stream.
-    @param[in] jval The JSON value.
-    @param[in] humanFriendly The human fiendly format flag.
-    @param[in] indent The first line indent. Used for human friendly format.
-    @return The output stream.
+    @param[in] first The begin of input buffer, points to the opening quote.
+    @param[in] last The end of input buffer.
+    @param[in] state The string state: STATE_STRING or STATE_NAME.
+    @return The end of parsed data.
+    @throw error::SyntaxError in case of parsing error.
     */
-    static OStream& write(OStream &os, Value const& jval, bool humanFriendly, size_t indent = 0)
+    const char* beginString(const char *first, const char *last, int state)
     {
-        switch (jval.getType())
+        m_state = state;
+
+        const char *p = first;
+        if (Parser::parseQuotedString(p, last, m_buf))
         {
-            case Value::TYPE_NULL:
-                os << "null";
-                break;
+            stringDone();
+            return p;
+        }
 
-            case Value::TYPE_BOOLEAN:
-                os << (jval.asBool() ? "true" : "false");
-                break;
+        // not complete, save the tail
+        m_token.assign(first, last);
+        m_quote = *first;
 
-            case Value::TYPE_INTEGER:
-                os << jval.asInt();
-                break;
+        // odd number of trailing backslashes means escape
+        size_t n = 0;
+        for (size_t i = m_token.size(); 1 < i && '\\' == m_token[i-1]; --i)
+            ++n;
+        m_escape = (n%2) != 0;
 
-            case Value::TYPE_DOUBLE:
-                os << jval.asDouble();
-                break;
+        return last;
+    }
 
-            case Value::TYPE_STRING:
-                writeQuotedString(os, jval.asString());
+
+    /// @brief Continue the buffered string.
+    /**
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @return The end of parsed data.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    const char* parseString(const char *first, const char *last)
+    {
+        const char *p = first;
+        while (p != last)
+        {
+            if (m_escape)
+            {
+                m_escape = false;
+                ++p;
+                continue;
+            }
+
+            p = Parser::scanString(p, last, m_quote);
+            if (p == last)
                 break;
 
-            case Value::TYPE_ARRAY:
+            if ('\\' == *p)
+                m_escape = true;
+            else if (m_quote == *p)
             {
-                os << '[';
-                if (const size_t N = jval.size())
+                m_token.append(first, ++p);
+
+                const char *t = m_token.data();
+                const char *t_end = t + m_token.size();
+                if (!Parser::parseQuotedString(t, t_end, m_buf) || t != t_end)
+                    throw error::SyntaxError("cannot parse string");
+
+                stringDone();
+                return p;
+            }
+            ++p; // escape, control or non-ASCII character
+        }
+
+        m_token.append(first, last);
+        return last;
+    }
+
+
+    /// @brief The string is parsed.
+    void stringDone()
+    {
+        m_token.clear();
+        if (STATE_NAME == m_state)
+        {
+            m_handler.onMemberName(m_buf);
+            m_state = STATE_COLON;
+        }
+        else
+        {
+            m_handler.onString(m_buf);
+            valueDone();
+        }
+    }
+
+
+    /// @brief Parse the number.
+    /**
+    The number is parsed in-place if it's complete.
+    Otherwise it's buffered.
+
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @return The end of parsed data.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    const char* parseNumber(const char *first, const char *last)
+    {
+        const char *p = first;
+        while (p != last && (misc::is_digit(*p) || '+' == *p || '-' == *p
+            || '.' == *p || 'e' == *p || 'E' == *p))
+        {
+            ++p;
+        }
+
+        if (p == last) // might be continued
+            m_token.append(first, last);
+        else if (m_token.empty())
+            numberDone(first, p);
+        else
+        {
+            m_token.append(first, p);
+            numberDone(m_token.data(), m_token.data() + m_token.size());
+        }
+
+        return p;
+    }
+
+
+    /// @brief The number is complete.
+    /**
+    @param[in] first The begin of number.
+    @param[in] last The end of number.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    void numberDone(const char *first, const char *last)
+    {
+        Value num;
+        if (!Parser::parseNumber(first, last, num) || first != last)
+            throw error::SyntaxError("cannot parse number");
+
+        if (num.isDouble())
+            m_handler.onDouble(num.asDouble());
+        else if (num.isUInteger()) // greater than Int64 maximum
+            m_handler.onUInteger(num.asUInt());
+        else
+            m_handler.onInteger(num.asInt());
+
+        m_token.clear();
+        valueDone();
+    }
+
+
+    /// @brief Parse the literal: `true`, `false` or `null`.
+    /**
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @return The end of parsed data.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    const char* parseLiteral(const char *first, const char *last)
+    {
+        for (; first != last && *m_literal; ++first, ++m_literal)
+        {
+            if (*first != *m_literal)
+                throw error::SyntaxError("no valid JSON value");
+        }
+
+        if (!*m_literal) // complete
+        {
+            if ('n' == m_literalType)
+                m_handler.onNull();
+            else
+                m_handler.onBoolean('t' == m_literalType);
+
+            valueDone();
+        }
+
+        return first;
+    }
+
+
+    /// @brief Skip the comment.
+    /**
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @return The end of parsed data.
+    @throw error::SyntaxError in case of invalid comment style
+    */
+    const char* parseComment(const char *first, const char *last)
+    {
+        switch (m_comment)
+        {
+            case COMMENT_SLASH:
+                if ('/' == *first)
+                    m_comment = COMMENT_LINE;
+                else if ('*' == *first)
+                    m_comment = COMMENT_BLOCK;
+                else
+                    throw error::SyntaxError("unknown comment style");
+                return first + 1;
+
+            case COMMENT_LINE:
+                first = std::find(first, last, '\n');
+                if (first != last)
+                    m_comment = COMMENT_NONE;
+                return first;
+
+            case COMMENT_BLOCK:
+                first = std::find(first, last, '*');
+                if (first != last)
                 {
-                    for (size_t i = 0; i < N; ++i)
-                    {
-                        if (0 < i)
-                            os.put(',');
-                        if (humanFriendly)
-                        {
-                            os.put('\n');
-                            writeIndent(os,
-                                indent+1);
-                        }
-                        write(os, jval[i],
-                            humanFriendly,
-                            indent+1);
-                    }
-                    if (humanFriendly)
-                    {
-                        os.put('\n');
-                        writeIndent(os,
-                            indent);
-                    }
+                    m_comment = COMMENT_BLOCK_STAR;
+                    ++first;
                 }
-                os << ']';
-            } break;
+                return first;
+
+            default: // COMMENT_BLOCK_STAR
+                if ('/' == *first)
+                    m_comment = COMMENT_NONE;
+                else if ('*' != *first)
+                    m_comment = COMMENT_BLOCK;
+                return first + 1;
+        }
+    }
 
-            case Value::TYPE_OBJECT:
+
+    /// @brief The array or object is complete.
+    void containerDone()
+    {
+        if ('[' == m_stack.back())
+            m_handler.onArrayEnd();
+        else
+            m_handler.onObjectEnd();
+
+        m_stack.pop_back();
+        valueDone();
+    }
+
+
+    /// @brief The value is complete.
+    void valueDone()
+    {
+        m_state = m_stack.empty() ? STATE_DONE : STATE_NEXT;
+    }
+
+private:
+
+    /// @brief The parser states.
+    enum State
+    {
+        STATE_VALUE,        ///< @brief Expect a value.
+        STATE_ARRAY_FIRST,  ///< @brief Expect the first element or the end of array.
+        STATE_OBJECT_FIRST, ///< @brief Expect the first member or the end of object.
+        STATE_MEMBER,       ///< @brief Expect a member name.
+        STATE_COLON,        ///< @brief Expect a member value separator.
+        STATE_NEXT,         ///< @brief Expect a separator or the end of array or object.
+        STATE_STRING,       ///< @brief Inside a string value.
+        STATE_NAME,         ///< @brief Inside a member name.
+        STATE_NUMBER,       ///< @brief Inside a number.
+        STATE_LITERAL,      ///< @brief Inside a literal.
+        STATE_DONE          ///< @brief The document is complete.
+    };
+
+    /// @brief The comment states.
+    enum Comment
+    {
+        COMMENT_NONE,      ///< @brief Not a comment.
+        COMMENT_SLASH,     ///< @brief The first '/' found.
+        COMMENT_LINE,      ///< @brief Inside one line comment.
+        COMMENT_BLOCK,     ///< @brief Inside C style comment.
+        COMMENT_BLOCK_STAR ///< @brief The '*' found inside C style comment.
+    };
+
+private:
+    HandlerT &m_handler; ///< @brief The events handler.
+    int m_state; ///< @brief The parser state.
+    int m_comment; ///< @brief The comment state.
+    std::vector<char> m_stack; ///< @brief The open arrays '[' and objects '{'.
+    String m_token; ///< @brief The incomplete token.
+    String m_buf; ///< @brief The string buffer.
+    char m_quote; ///< @brief The quote of incomplete string.
+    bool m_escape; ///< @brief The escape character found at the end of incomplete string.
+    const char *m_literal; ///< @brief The rest of expected literal.
+    char m_literalType; ///< @brief The first character of expected literal.
+};
+
+
+/// @brief The JSON array parser.
+/**
+This parser splits the top-level JSON array into elements by a fast
+structural pre-scan (only strings and nesting are tracked). Then the
+elements might be parsed independently, for example by several
+threads, directly into the pre-sized array.
+
+If #HIVE_JSON_PARALLEL macro is defined, the parse() method is
+provided, which uses a few `boost::thread` workers:
+
+~~~{.cpp}
+json::Value jval;
+json::ArrayParser::parse(data.data(), data.data() + data.size(), jval, 8);
+~~~
+
+The result is exactly the same as Parser produces.
+*/
+class ArrayParser
+{
+public:
+
+    /// @brief The element range: begin and end.
+    typedef std::pair<const char*, const char*> Range;
+
+    /// @brief The list of element ranges.
+    typedef std::vector<Range> RangeList;
+
+public:
+
+    /// @brief Split the top-level JSON array into elements.
+    /**
+    The element ranges are not validated, use parseElements() for that.
+    The documents with comments are not split.
+
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[out] elements The element ranges.
+    @return The end of array or `0` if cannot split.
+    @throw error::SyntaxError in case of invalid comment style.
+    */
+    static const char* split(const char *first, const char *last, RangeList &elements)
+    {
+        elements.clear();
+        if (!Parser::skipCommentsAndWS(first, last) || '[' != *first)
+            return 0; // not an array
+
+        const char *elem = ++first;
+        size_t depth = 0;
+        while (first != last)
+        {
+            const char cx = *first;
+            switch (cx)
             {
-                os << '{';
-                Value::MemberIterator b = jval.membersBegin();
-                const Value::MemberIterator e = jval.membersEnd();
-                if (b != e)
-                {
-                    for (Value::MemberIterator i = b; i != e; ++i)
+                case '\"':
+                case '\'':
+                    first = skipString(first + 1, last, cx);
+                    if (!first)
+                        return 0; // no end of string
+                    continue;
+
+                case '/':
+                case '#':
+                    return 0; // comments are not supported
+
+                case '[':
+                case '{':
+                    depth += 1;
+                    break;
+
+                case ']':
+                case '}':
+                    if (0 == depth)
                     {
-                        const String &name = i->first;
-                        const Value &val = i->second;
+                        if (']' != cx)
+                            return 0; // bad array
 
-                        if (i != b)
-                            os.put(',');
-                        if (humanFriendly)
-                        {
-                            os.put('\n');
-                            writeIndent(os,
-                                indent+1);
-                        }
-                        writeQuotedString(os, name);
-                        os.put(':');
-                        if (humanFriendly)
-                            os.put(' ');
-                        write(os, val,
-                            humanFriendly,
-                            indent+1);
+                        if (!elements.empty() || Parser::scanWhitespaces(elem, first) != first)
+                            elements.push_back(Range(elem, first));
+                        return first + 1;
                     }
-                    if (humanFriendly)
+                    depth -= 1;
+                    break;
+
+                case ',':
+                    if (0 == depth)
                     {
-                        os.put('\n');
-                        writeIndent(os,
-                            indent);
+                        elements.push_back(Range(elem, first));
+                        elem = first + 1;
                     }
-                }
-                os << '}';
-            } break;
+                    break;
+            }
+
+            ++first;
         }
 
-        return os;
+        return 0; // no end of array
+    }
+
+
+    /// @brief Parse the elements.
+    /**
+    The elements are parsed into corresponding elements of @a jval array
+    which should be already resized.
+
+    @param[in] elements The element ranges.
+    @param[in] from The first element index.
+    @param[in] to The last element index (exclusive).
+    @param[in,out] jval The JSON array.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    static void parseElements(RangeList const& elements, size_t from, size_t to, Value &jval)
+    {
+        for (size_t i = from; i < to; ++i)
+        {
+            const char *last = elements[i].second;
+            const char *end = Parser::parse(elements[i].first, last, jval[i]);
+            if (Parser::skipCommentsAndWS(end, last))
+                throw error::SyntaxError("no element separator");
+        }
     }
 
+#if defined(HIVE_JSON_PARALLEL)
 public:
 
-    /// @brief Write indent.
+    /// @brief Parse the JSON value using a few threads.
+    /**
+    If the input is not a JSON array or it contains comments
+    or it's too small, the Parser is used in the current thread.
+
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    @param[out] jval The parsed JSON value.
+    @param[in] threads The maximum number of threads, including the current one.
+    @return The end of parsed data.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    static const char* parse(const char *first, const char *last, Value &jval, size_t threads)
+    {
+        RangeList elements;
+        const char *end = (1 < threads) ? split(first, last, elements) : 0;
+        const size_t N = elements.size();
+        if (!end || N < 2*threads)
+            return Parser::parse(first, last, jval);
+
+        Value res(Value::TYPE_ARRAY);
+        res.resize(N);
+
+        // each thread gets about the same number of bytes
+        const char *base = elements.front().first;
+        const size_t total = elements.back().second - base;
+        std::vector<String> errors(threads);
+        std::vector<int> failures(threads, 0);
+        boost::thread_group workers;
+
+        size_t from = 0;
+        for (size_t k = 0; k+1 < threads && from < N; ++k)
+        {
+            const char *target = base + total/threads*(k+1);
+            size_t to = from + 1;
+            while (to < N && elements[to].first < target)
+                ++to;
+
+            workers.create_thread(boost::bind(&ArrayParser::work,
+                boost::cref(elements), from, to, boost::ref(res),
+                boost::ref(errors[k]), boost::ref(failures[k])));
+            from = to;
+        }
+        work(elements, from, N, res, errors[threads-1], failures[threads-1]);
+        workers.join_all();
+
+        for (size_t k = 0; k < threads; ++k)
+        {
+            if (2 == failures[k])
+                throw error::SyntaxError(errors[k]);
+            else if (1 == failures[k])
+                throw error::Failure(errors[k]);
+        }
+
+        res.swap(jval);
+        return end;
+    }
+
+private:
+
+    /// @brief The worker thread.
     /**
-    This method writes the `2*indent` spaces to the output stream.
-
-    @param[in,out] os The output stream.
-    @param[in] indent The indent size.
-    @return The output stream.
+    All exceptions are caught and reported to the caller thread.
+
+    @param[in] elements The element ranges.
+    @param[in] from The first element index.
+    @param[in] to The last element index (exclusive).
+    @param[in,out] jval The JSON array.
+    @param[out] error The error message.
+    @param[out] failure The failure type: `1` for any error, `2` for syntax error.
     */
-    static OStream& writeIndent(OStream &os, size_t indent)
+    static void work(RangeList const& elements, size_t from, size_t to,
+        Value &jval, String &error, int &failure)
     {
-        const size_t N = 2*indent;
-        for (size_t i = 0; i < N; ++i)
-            os.put(' ');
-        return os;
+        try
+        {
+            parseElements(elements, from, to, jval);
+        }
+        catch (error::SyntaxError const& ex)
+        {
+            error = ex.what();
+            failure = 2;
+        }
+        catch (std::exception const& ex)
+        {
+            error = ex.what();
+            failure = 1;
+        }
     }
+#endif // HIVE_JSON_PARALLEL
 
+private:
+    friend class LazyValue;
 
-    /// @brief Write quoted string.
+    /// @brief Skip the string.
     /**
-    @param[in,out] os The output stream.
-    @param[in] str The string to write.
-    @return The output stream.
+    @param[in] first The begin of input buffer, just after the opening quote.
+    @param[in] last The end of input buffer.
+    @param[in] quote The quote character.
+    @return The end of string or `0` if no end found.
     */
-    static OStream& writeQuotedString(OStream &os, String const& str)
+    static const char* skipString(const char *first, const char *last, char quote)
     {
-        os.put('\"');
-
-        const size_t N = str.size();
-        for (size_t i = 0; i < N; ++i)
+        while (first != last)
         {
-            const int ch = (unsigned char)(str[i]);
-            // TODO: handle utf-8 strings!!!
+            first = Parser::scanString(first, last, quote);
+            if (first == last)
+                break;
 
-            switch (ch)
+            const char cx = *first++;
+            if (quote == cx)
+                return first;
+            else if ('\\' == cx)
             {
-                case '\"': case '\'':
-                case '\\': case '/':
-                    os.put('\\');
-                    os.put(ch);
-                    break;
-
-                case '\b':
-                    os.put('\\');
-                    os.put('b');
-                    break;
-
-                case '\f':
-                    os.put('\\');
-                    os.put('f');
-                    break;
-
-                case '\n':
-                    os.put('\\');
-                    os.put('n');
-                    break;
-
-                case '\r':
-                    os.put('\\');
-                    os.put('r');
-                    break;
-
-                case '\t':
-                    os.put('\\');
-                    os.put('t');
-                    break;
-
-                default:
-                    if (!(misc::is_char(ch) && !misc::is_ctl(ch)))
-                    {
-                        os.put('\\');
-                        os.put('u');
-                        os.put(misc::int2hex((ch>>12)&0x0f));
-                        os.put(misc::int2hex((ch>>8)&0x0f));
-                        os.put(misc::int2hex((ch>>4)&0x0f));
-                        os.put(misc::int2hex((ch>>0)&0x0f));
-                    }
-                    else
-                        os.put(ch);
+                if (first == last)
                     break;
+                ++first; // skip escaped character
             }
         }
 
-        os.put('\"');
-        return os;
+        return 0; // no end of string
     }
 };
 
 
-/// @brief Write JSON value to the output stream.
-/** @relates Value
-@param[in,out] os The output stream.
-@param[in] jval The JSON value.
-@return The output stream.
+/// @brief The lazy JSON value.
+/**
+This class refers to the JSON text in memory and decodes it on demand.
+The object members and array elements are found by a fast structural
+scan on the first access, only the accessed members are decoded:
+
+~~~{.cpp}
+const String &content = response->getContent();
+json::LazyValue jval(content.data(), content.data() + content.size());
+const UInt64 id = jval["id"].asUInt(); // "timestamp", "userId" are skipped
+json::Value const& params = jval["parameters"]; // materialized
+~~~
+
+The elements and members are returned by reference and
+live as long as the parent lazy value.
+
+The lazy value is converted to `json::Value const&` implicitly,
+in this case the whole (sub)value is parsed once and cached.
+So it might be passed to any function accepting `json::Value const&`.
+
+The input buffer should exist while the lazy value is used.
+The text is validated only when it's decoded, the structural scan
+reports only the structure errors.
+
+The lazy value caches the decoded data, so it's not thread-safe,
+even if it's used as constant.
 */
-inline OStream& operator<<(OStream &os, const Value &jval)
+class LazyValue:
+    private NonCopyable
 {
-    const bool humanFriendly = false; // true;
-    return Formatter::write(os, jval, humanFriendly);
-}
+public:
 
+    /// @brief The default constructor.
+    /**
+    Creates the NULL value.
+    */
+    LazyValue()
+        : m_first(0)
+        , m_last(0)
+        , m_indexed(false)
+        , m_parsed(false)
+        , m_object(false)
+    {}
 
-/// @brief Convert JSON value to string.
-/**
-@param[in] jval The JSON value.
-@return The JSON string.
-*/
-inline String json2str(Value const& jval)
-{
-    OStringStream oss;
-    Formatter::write(oss, jval, false);
-    return oss.str();
-}
 
+    /// @brief Refer to the JSON text.
+    /**
+    @param[in] first The begin of input buffer.
+    @param[in] last The end of input buffer.
+    */
+    LazyValue(const char *first, const char *last)
+        : m_first(first)
+        , m_last(last)
+        , m_indexed(false)
+        , m_parsed(false)
+        , m_object(false)
+    {
+        if (Parser::skipCommentsAndWS(m_first, m_last))
+            m_last = skipValue(m_first, m_last);
+    }
 
-/// @brief Convert JSON value to human friendly string.
-/**
-@param[in] jval The JSON value.
-@return The JSON string.
-*/
-inline String json2hstr(Value const& jval)
-{
-    OStringStream oss;
-    Formatter::write(oss, jval, true);
-    return oss.str();
-}
 
+    /// @brief The destructor.
+    /**
+    Releases the accessed elements and members.
+    */
+    ~LazyValue()
+    {
+        for (size_t i = 0; i < m_items.size(); ++i)
+            delete m_items[i].value;
+    }
 
-/// @brief The JSON parser.
-/**
-description is under construction.
-*/
-class Parser
-{
-    /// @brief The string traits type.
-    typedef String::traits_type Traits;
 public:
 
-    /// @brief Parse the JSON value from the input stream.
+    /// @brief Get the JSON text.
     /**
-    @param[in,out] is The input stream.
-    @param[out] jval The parsed JSON value.
-    @return The input stream.
-    @throw error::SyntaxError in case of parsing error.
+    @return The JSON text of this value.
     */
-    static IStream& parse(IStream &is, Value &jval)
+    StringRef getText() const
     {
-        skipCommentsAndWS(is);
-        Traits::int_type meta = is.peek();
-        if (Traits::eq_int_type(meta, Traits::eof()))
-            throw error::SyntaxError("no JSON value"); // not enough data
+        return m_first ? StringRef(m_first, m_last - m_first) : StringRef();
+    }
 
-        Traits::char_type cx = Traits::to_char_type(meta);
 
-        // object
-        if (Traits::eq(cx, '{'))
-        {
-            is.ignore(1); // ignore '{'
-            Value(Value::TYPE_OBJECT).swap(jval);
-            bool firstMember = true;
+    /// @brief Get the value type.
+    /**
+    The objects, arrays and strings are not decoded.
 
-            while (is)
-            {
-                skipCommentsAndWS(is);
+    @return The value type.
+    */
+    Value::Type getType() const
+    {
+        if (m_first == m_last)
+            return Value::TYPE_NULL;
 
-                cx = Traits::to_char_type(is.peek());
-                if (Traits::eq(cx, '}'))
-                {
-                    is.ignore(1); // ignore '}'
-                    break; // end of object
-                }
+        switch (*m_first)
+        {
+            case '{': return Value::TYPE_OBJECT;
+            case '[': return Value::TYPE_ARRAY;
+            case '\"': return Value::TYPE_STRING;
+            default: return get().getType(); // scalar
+        }
+    }
 
-                if (!firstMember) // check member separator
-                {
-                    if (Traits::eq(cx, ','))
-                    {
-                        is.ignore(1); // ingore ','
-                        skipCommentsAndWS(is);
-                    }
-                    else
-                        throw error::SyntaxError("no member separator");
-                }
-                else
-                    firstMember = false;
 
-                String memberName;
-                if (parseQuotedString(is, memberName))
-                {
-                    skipCommentsAndWS(is);
+    /// @brief Is the value NULL?
+    /**
+    @return `true` if the value is NULL or missing.
+    */
+    bool isNull() const
+    {
+        return Value::TYPE_NULL == getType();
+    }
 
-                    cx = Traits::to_char_type(is.peek());
-                    if (Traits::eq(cx, ':'))
-                        is.ignore(1);
-                    else
-                        throw error::SyntaxError("no member value separator");
 
-                    Value memberValue;
-                    if (parse(is, memberValue))
-                        jval[memberName].swap(memberValue);
-                    else
-                        throw error::SyntaxError("no member value");
-                }
-                else
-                    throw error::SyntaxError("no member name");
-            }
-        }
+    /// @brief Is the value object?
+    /**
+    @return `true` if the value is object.
+    */
+    bool isObject() const
+    {
+        return Value::TYPE_OBJECT == getType();
+    }
 
-        // array
-        else if (Traits::eq(cx, '['))
-        {
-            is.ignore(1); // ignore '['
-            Value(Value::TYPE_ARRAY).swap(jval);
-            bool firstElement = true;
 
-            while (1)
-            {
-                skipCommentsAndWS(is);
+    /// @brief Is the value array?
+    /**
+    @return `true` if the value is array.
+    */
+    bool isArray() const
+    {
+        return Value::TYPE_ARRAY == getType();
+    }
 
-                cx = Traits::to_char_type(is.peek());
-                if (Traits::eq(cx, ']'))
-                {
-                    is.ignore(1); // ignore ']'
-                    break; // end of array
-                }
+public:
 
-                if (!firstElement)
-                {
-                    if (Traits::eq(cx, ','))
-                    {
-                        is.ignore(1); // ingore ','
-                        skipCommentsAndWS(is);
-                    }
-                    else
-                        throw error::SyntaxError("no element separator");
-                }
-                else
-                    firstElement = false;
+    /// @brief Get the number of elements or members.
+    /**
+    @return The number of array elements or object members. Zero for scalars.
+    @throw error::SyntaxError in case of structure error.
+    */
+    size_t size() const
+    {
+        buildIndex();
+        return m_items.size();
+    }
 
-                Value elem;
-                if (parse(is, elem))
-                    jval.append(elem);
-                else
-                    throw error::SyntaxError("no element value");
-            }
-        }
 
-        // number: integer or double
-        else if (misc::is_digit(cx) || Traits::eq(cx, '+') || Traits::eq(cx, '-'))
-        {
-            Int64 ival = 0;
-            if (is >> ival) // assume integer first
-            {
-                cx = Traits::to_char_type(is.peek()); // check for float-point
-                if (Traits::eq(cx, '.') || Traits::eq(cx, 'e') || Traits::eq(cx, 'E'))
-                {
-                    double fval = 0.0;
-                    if (is >> fval) // floating-point
-                        Value(double(ival) + fval).swap(jval);
-                    else
-                        throw error::SyntaxError("cannot parse floating-point value");
-                }
-                else // integer
-                    Value(ival).swap(jval);
-            }
-            else
-                throw error::SyntaxError("cannot parse integer value");
-        }
+    /// @brief Get the element or member by index.
+    /**
+    @param[in] index The element or member index.
+    @return The element or member or NULL if index is out of range.
+    @throw error::SyntaxError in case of structure error.
+    */
+    LazyValue const& operator[](size_t index) const
+    {
+        buildIndex();
+        return (index < m_items.size()) ? item(index) : null();
+    }
 
-        // string
-        else if (Traits::eq(cx, '\"'))
-        {
-            String val;
-            if (parseQuotedString(is, val))
-                Value(val).swap(jval);
-            else
-                throw error::SyntaxError("cannot parse string");
-        }
 
-        else if (Traits::eq(cx, 't') && match(is, "true"))
-        {
-            Value(true).swap(jval);
-        }
+    /// @brief Get the member name by index.
+    /**
+    @param[in] index The member index.
+    @return The member name. Empty for array elements.
+    @throw error::SyntaxError in case of structure error.
+    */
+    String const& getMemberName(size_t index) const
+    {
+        buildIndex();
+        assert(index < m_items.size() && "index out of range");
+        return m_items[index].name;
+    }
 
-        else if (Traits::eq(cx, 'f') && match(is, "false"))
-        {
-            Value(false).swap(jval);
-        }
 
-        else if (Traits::eq(cx, 'n') && match(is, "null"))
+    /// @brief Get the member by name.
+    /**
+    @param[in] name The member name.
+    @return The member or NULL if there is no such member.
+    @throw error::SyntaxError in case of structure error.
+    */
+    LazyValue const& operator[](String const& name) const
+    {
+        buildIndex();
+        if (m_object)
         {
-            Value().swap(jval);
+            // the last member wins, as in Value
+            for (size_t i = m_items.size(); 0 < i; --i)
+                if (m_items[i-1].name == name)
+                    return item(i-1);
         }
 
-        else
+        return null();
+    }
+
+public:
+
+    /// @brief Get the decoded value.
+    /**
+    The whole value is parsed on the first call.
+
+    @return The decoded value.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    Value const& get() const
+    {
+        if (!m_parsed)
         {
-            throw error::SyntaxError("no valid JSON value");
+            if (m_first != m_last)
+                Parser::parse(m_first, m_last, m_value);
+            m_parsed = true;
         }
 
-        return is;
+        return m_value;
     }
 
-public:
 
-    /// @brief Skip whitespaces and comments
+    /// @brief Get the decoded value.
     /**
-    @param[in,out] is The input stream.
-    @return `false` if end of stream.
-    @throw error::SyntaxError in case of invalid comment style
+    @return The decoded value.
+    @throw error::SyntaxError in case of parsing error.
+    @see get()
     */
-    static bool skipCommentsAndWS(IStream &is)
+    operator Value const&() const
     {
-        // the maximum stream size
-        const std::streamsize UP_TO_END = std::numeric_limits<std::streamsize>::max();
+        return get();
+    }
 
-        while (is)
-        {
-            Traits::int_type meta = (is >> std::ws).peek();
-            if (Traits::eq_int_type(meta, Traits::eof()))
-                return false; // end of stream
 
-            Traits::char_type cx = Traits::to_char_type(meta);
+    /// @copydoc Value::asBool()
+    bool asBool() const
+    {
+        return get().asBool();
+    }
 
-            // '#' comment
-            if (Traits::eq(cx, '#'))
-            {
-                // ignore all the line
-                is.ignore(UP_TO_END, '\n');
-            }
 
-            // C/C++ comments
-            else if (Traits::eq(cx, '/'))
-            {
-                is.ignore(1); // ignore first '/'
+    /// @copydoc Value::asInt()
+    Int64 asInt() const
+    {
+        return get().asInt();
+    }
 
-                meta = is.peek();
-                if (Traits::eq_int_type(meta, Traits::eof()))
-                    return false; // end of stream
 
-                cx = Traits::to_char_type(meta);
-                if (Traits::eq(cx, '/')) // C++ style: one line
-                {
-                    // ignore all the line
-                    is.ignore(UP_TO_END, '\n');
-                }
-                else if (Traits::eq(cx, '*')) // C style: /* ... */
-                {
-                    is.ignore(1); // ignore '*'
-                    while (1) // search for "*/"
-                    {
-                        // skip all until '*'
-                        is.ignore(UP_TO_END, '*');
+    /// @copydoc Value::asUInt()
+    UInt64 asUInt() const
+    {
+        return get().asUInt();
+    }
 
-                        meta = is.peek();
-                        if (Traits::eq_int_type(meta, Traits::eof()))
-                            return false; // end of stream
 
-                        cx = Traits::to_char_type(meta);
-                        if (Traits::eq(cx, '/'))
-                        {
-                            is.ignore(1); // ignore '/'
-                            break;
-                        }
-                    }
-                }
-                else
-                    throw error::SyntaxError("unknown comment style");
-            }
+    /// @copydoc Value::asDouble()
+    double asDouble() const
+    {
+        return get().asDouble();
+    }
 
-            else
-                return true; // OK
-        }
 
-        return false;
+    /// @copydoc Value::asString()
+    String asString() const
+    {
+        return get().asString();
     }
 
+public:
 
-    /// @brief Parse quoted string from the input stream.
+    /// @brief Get the NULL value.
     /**
-    @param[in,out] is The input stream.
-    @param[out] str The parsed string.
-    @return `true` if string successfully parsed.
-    @throw error::SyntaxError in case of parsing error.
+    @return The static NULL lazy value.
     */
-    static bool parseQuotedString(IStream &is, String &str)
+    static LazyValue const& null()
     {
-        // remember the "quote" character
-        const Traits::char_type QUOTE = Traits::to_char_type(is.get());
+        static const LazyValue N;
+        return N;
+    }
 
-        OStringStream oss;
-        while (is)
-        {
-            Traits::int_type meta = is.get();
-            if (Traits::eq_int_type(meta, Traits::eof()))
-                return false; // end of stream
+private:
 
-            Traits::char_type ch = Traits::to_char_type(meta);
-            if (ch == QUOTE)
+    /// @brief Build the elements or members index.
+    /**
+    @throw error::SyntaxError in case of structure error.
+    */
+    void buildIndex() const
+    {
+        if (m_indexed)
+            return;
+        m_indexed = true;
+
+        m_object = (m_first != m_last && '{' == *m_first);
+        if (m_first == m_last || (!m_object && '[' != *m_first))
+            return; // scalar
+
+        const char CLOSE = m_object ? '}' : ']';
+        const char *p = m_first + 1;
+        if (!Parser::skipCommentsAndWS(p, m_last))
+            throw error::SyntaxError("no end of array or object");
+        if (CLOSE == *p)
+            return; // empty
+
+        while (1)
+        {
+            Item item;
+            if (m_object)
             {
-                str = oss.str();
-                return true; // OK
+                if ('\"' != *p && '\'' != *p)
+                    throw error::SyntaxError("no member name");
+                if (!Parser::parseQuotedString(p, m_last, item.name))
+                    throw error::SyntaxError("cannot parse member name");
+                if (!Parser::skipCommentsAndWS(p, m_last) || ':' != *p)
+                    throw error::SyntaxError("no member separator");
+                if (!Parser::skipCommentsAndWS(++p, m_last))
+                    throw error::SyntaxError("no member value");
             }
 
-            else if (ch == '\\') // escape
-            {
-                meta = is.get();
-                if (Traits::eq_int_type(meta, Traits::eof()))
-                    return false; // end of stream
-
-                ch = Traits::to_char_type(meta);
-                switch (ch)
-                {
-                    case '"':  oss.put('"');  break;
-                    case '\'': oss.put('\''); break;
-                    case '/':  oss.put('/');  break;
-                    case '\\': oss.put('\\'); break;
-                    case 'b':  oss.put('\b'); break;
-                    case 'f':  oss.put('\f'); break;
-                    case 'n':  oss.put('\n'); break;
-                    case 'r':  oss.put('\r'); break;
-                    case 't':  oss.put('\t'); break;
+            item.first = p;
+            p = skipValue(p, m_last);
+            item.last = p;
+            m_items.push_back(item);
 
-                    case 'u':
-                    {
-                        throw error::SyntaxError("unicode not implemented yet");
-                        //unsigned int unicode;
-                        //if ( !decodeUnicodeCodePoint( is, unicode ) )
-                        //    return false;
-                        //oss << codePointToUTF8(unicode);
-                    } break;
+            if (!Parser::skipCommentsAndWS(p, m_last))
+                throw error::SyntaxError("no end of array or object");
+            if (CLOSE == *p)
+                break;
+            if (',' != *p)
+                throw error::SyntaxError("no element separator");
+            if (!Parser::skipCommentsAndWS(++p, m_last))
+                throw error::SyntaxError("no end of array or object");
+        }
+    }
 
-                    default:
-                        throw error::SyntaxError("bad escape sequence in a string");
-                }
-            }
 
-            else
-                oss.put(ch); // just save
-        }
+    /// @brief Get the element or member.
+    /**
+    The lazy value is created on the first access.
 
-        return false;
+    @param[in] index The item index.
+    @return The element or member.
+    */
+    LazyValue const& item(size_t index) const
+    {
+        Item &i = m_items[index];
+        if (!i.value)
+            i.value = new LazyValue(i.first, i.last);
+        return *i.value;
     }
 
 
-    /// @brief Match the input with the pattern.
+    /// @brief Skip the JSON value.
     /**
-    @param[in,out] is The input stream.
-    @param[in] pattern The pattern to match.
-    @return `true` if matched, `false` if not match or end of stream.
+    The nested arrays and objects are skipped by brackets,
+    the strings and comments are skipped too.
+
+    @param[in] first The begin of value.
+    @param[in] last The end of input buffer.
+    @return The end of value.
+    @throw error::SyntaxError in case of structure error.
     */
-    static bool match(IStream &is, const char *pattern)
+    static const char* skipValue(const char *first, const char *last)
     {
-        for (size_t i = 0; pattern[i]; ++i)
+        size_t depth = 0;
+        while (first != last)
         {
-            const Traits::int_type meta = is.peek();
-            if (Traits::eq_int_type(meta, Traits::eof()))
-                return false; // end of stream
-
-            const Traits::char_type ch = Traits::to_char_type(meta);
-            if (!Traits::eq(ch, pattern[i]))
+            const char cx = *first;
+            switch (cx)
             {
-                //for (; 0 < i; --i) // rollback
-                //    is.putback(pattern[i-1]);
+                case '\"':
+                case '\'':
+                    first = ArrayParser::skipString(first + 1, last, cx);
+                    if (!first)
+                        throw error::SyntaxError("no end of string");
+                    if (0 == depth)
+                        return first;
+                    continue;
+
+                case '/':
+                case '#':
+                    if (0 == depth)
+                        return first; // comment after scalar
+                    Parser::skipCommentsAndWS(first, last);
+                    continue;
+
+                case '[':
+                case '{':
+                    depth += 1;
+                    break;
 
-                return false; // doesn't match
+                case ']':
+                case '}':
+                case ',':
+                    if (0 == depth)
+                        return first; // end of scalar
+                    if (',' != cx && 0 == --depth)
+                        return first + 1;
+                    break;
+
+                case ' ': case '\t': case '\n':
+                case '\r': case '\f': case '\v':
+                    if (0 == depth)
+                        return first; // end of scalar
+                    break;
             }
-            else
-                is.ignore(1);
+
+            ++first;
         }
 
-        return true; // match
+        if (depth)
+            throw error::SyntaxError("no end of array or object");
+        return first;
     }
+
+private:
+
+    /// @brief The element or member.
+    struct Item
+    {
+        String name; ///< @brief The member name. Empty for array elements.
+        const char *first; ///< @brief The begin of value.
+        const char *last; ///< @brief The end of value.
+        LazyValue *value; ///< @brief The lazy value, created on demand.
+
+        /// @brief The default constructor.
+        Item()
+            : first(0)
+            , last(0)
+            , value(0)
+        {}
+    };
+
+private:
+    const char *m_first; ///< @brief The begin of value.
+    const char *m_last; ///< @brief The end of value.
+    mutable std::vector<Item> m_items; ///< @brief The elements or members.
+    mutable Value m_value; ///< @brief The decoded value.
+    mutable bool m_indexed; ///< @brief The items are indexed.
+    mutable bool m_parsed; ///< @brief The value is decoded.
+    mutable bool m_object; ///< @brief The items are object members.
 };
 
 
-/// @brief Parse JSON value from the input stream.
-/** @relates Value
-@param[in,out] is The input stream.
-@param[in,out] jval The JSON value.
-@return The input stream.
-@throw error::SyntaxError in case of parsing error.
+/// @brief The arena-backed JSON document.
+/**
+The document owns the root JSON value and the arena. All strings,
+arrays and objects of the parsed document are allocated from the arena,
+so parsing takes just a few memory allocations and the whole document
+is released in one shot.
+
+This is useful for short-living documents: parse the response,
+convert it and throw it away. The document may be reused to parse
+the next response, the arena memory is released before.
+
+~~~{.cpp}
+json::Document doc;
+doc.parse(content.data(), content.size());
+Int64 id = doc.getRoot()["id"].asInt();
+~~~
+
+@warning Do not swap or move document's values to the long-living values,
+copy them instead: copies are always allocated on the heap.
 */
-inline IStream& operator>>(IStream &is, Value &jval)
+class Document:
+    private NonCopyable
 {
-    return Parser::parse(is, jval);
-}
+public:
+
+    /// @brief The main constructor.
+    /**
+    @param[in] blockSize The first arena block size in bytes.
+    */
+    explicit Document(size_t blockSize = 4096)
+        : m_arena(blockSize)
+    {}
 
+public:
 
-/// @brief Convert string to JSON value.
+    /// @brief Parse the document from the memory buffer.
+    /**
+    The previous content is released.
+
+    @param[in] data The JSON data.
+    @param[in] len The JSON data length in bytes.
+    @throw error::SyntaxError in case of parsing error.
+    */
+    void parse(const char *data, size_t len)
+    {
+        clear();
+
+        const char *last = data + len;
+        const char *end = Parser::parse(data, last, m_root, m_arena);
+        if (Parser::skipCommentsAndWS(end, last)) // check is 'data' fully parsed
+            throw error::SyntaxError("partially parsed");
+    }
+
+
+    /// @brief Release the document content.
+    /**
+    The biggest arena block is kept to parse the next document.
+    */
+    void clear()
+    {
+        Value().swap(m_root);
+        m_arena.reset();
+    }
+
+public:
+
+    /// @brief Get the root value.
+    Value& getRoot()
+    {
+        return m_root;
+    }
+
+
+    /// @brief Get the root value (read-only).
+    Value const& getRoot() const
+    {
+        return m_root;
+    }
+
+
+    /// @brief Get the arena.
+    Arena& getArena()
+    {
+        return m_arena;
+    }
+
+private:
+    Arena m_arena; ///< @brief The arena, should be destroyed last.
+    Value m_root; ///< @brief The root value.
+};
+
+    } // json namespace
+
+
+// HIVE_JSON_FLAT_OBJECTS
+#if defined(HIVE_DOXY_MODE)
+/// @hideinitializer @brief Use flat JSON objects.
 /**
-@param[in] str The JSON string.
-@return The parsed JSON value.
-@throw error::SyntaxError in case of parsing error.
+By default JSON object members are stored in `std::map`.
+Please define this macro to store members in hive::json::FlatObject
+instead: it's faster for small objects, but members are iterated
+(and formatted) in insertion order.
 */
-inline Value str2json(String const& str)
-{
-    Value jval;
-    IStringStream iss(str);
-    Parser::parse(iss, jval);
-    (iss >> std::ws).peek();
-    if (!iss.eof()) // check is 'str' if fully parsed
-        throw error::SyntaxError("partially parsed");
-    return jval;
-}
+#define HIVE_JSON_FLAT_OBJECTS
+#endif // defined(HIVE_DOXY_MODE)
 
-    } // json namespace
+
+// HIVE_JSON_INTERNED_KEYS
+#if defined(HIVE_DOXY_MODE)
+/// @hideinitializer @brief Intern JSON member names.
+/**
+Please define this macro to intern member names of parsed documents
+and member names used with hive::json::Value::operator[] on string literals
+in the global hive::json::KeyTable. This reduces memory usage
+of many similar documents if `std::string` is reference-counted.
+The parsed names are interned only up to the table limits.
+*/
+#define HIVE_JSON_INTERNED_KEYS
+#endif // defined(HIVE_DOXY_MODE)
+
+
+// HIVE_JSON_PARALLEL
+#if defined(HIVE_DOXY_MODE)
+/// @hideinitializer @brief Enable parallel parsing of JSON arrays.
+/**
+Please define this macro to enable hive::json::ArrayParser::parse()
+method, which parses big JSON arrays using a few threads.
+The boost.thread library should be linked.
+*/
+#define HIVE_JSON_PARALLEL
+#endif // defined(HIVE_DOXY_MODE)
+
+
+// HIVE_JSON_ON_COPY
+#if defined(HIVE_DOXY_MODE)
+/// @hideinitializer @brief The deep copy hook (test only).
+/**
+This macro is called each time a JSON value is copied
+(see hive::json::Value::Value(Value const&)). It's empty by default.
+
+It's not a part of the public API and might be changed or removed
+without notice. The test_copy test defines it before including
+json.hpp to count the copies. Applications should not define it:
+all translation units must see the same definition.
+*/
+#define HIVE_JSON_ON_COPY()
+#endif // defined(HIVE_DOXY_MODE)
+
+
+// HIVE_DISABLE_SIMD
+#if defined(HIVE_DOXY_MODE)
+/// @hideinitializer @brief Disable SIMD.
+/**
+By default the JSON parser uses SSE2 instructions (if available
+at compile time) to scan strings and whitespaces. Please define this
+macro to use the portable implementation instead.
+*/
+#define HIVE_DISABLE_SIMD
+#endif // defined(HIVE_DOXY_MODE)
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -126,6 +126,93 @@ inline char int2dec(int x)
     return -1; // error
 }
 
+
+/// @brief Check the UTF-8 sequence.
+/**
+The sequence is checked according to the Unicode standard (table 3-7):
+the overlong forms, the surrogates and the code points above U+10FFFF
+are invalid.
+
+@param[in] first The begin of input buffer, points to the leading byte.
+@param[in] last The end of input buffer.
+@return The sequence length in bytes [1..4],
+    `0` if the sequence is incomplete (the end of buffer is reached)
+    or `-1` if the sequence is invalid.
+*/
+inline int utf8_check(const char *first, const char *last)
+{
+    // the sequence length by five high bits of the leading byte
+    static const int LENGTH[32] =
+    {
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x00..0x7F
+        0, 0, 0, 0, 0, 0, 0, 0,                         // 0x80..0xBF
+        2, 2, 2, 2, 3, 3, 4, 0                          // 0xC0..0xFF
+    };
+
+    const UInt8 lead = UInt8(*first);
+    const int len = LENGTH[lead>>3];
+    if (!len || (1 != len && lead < 0xC2) || 0xF4 < lead)
+        return -1; // invalid leading byte
+    if (1 == len)
+        return 1; // ASCII
+
+    // the second byte range depends on the leading byte
+    UInt8 lo = 0x80, hi = 0xBF;
+    switch (lead)
+    {
+        case 0xE0: lo = 0xA0; break; // no overlong forms
+        case 0xED: hi = 0x9F; break; // no surrogates
+        case 0xF0: lo = 0x90; break; // no overlong forms
+        case 0xF4: hi = 0x8F; break; // up to U+10FFFF
+    }
+
+    for (int i = 1; i < len; ++i)
+    {
+        if (first+i == last)
+            return 0; // incomplete
+
+        const UInt8 ch = UInt8(first[i]);
+        if (ch < lo || hi < ch)
+            return -1; // invalid continuation byte
+        lo = 0x80; hi = 0xBF;
+    }
+
+    return len;
+}
+
+
+/// @brief Append the code point as UTF-8 sequence.
+/**
+@param[in,out] str The output string.
+@param[in] cp The code point. Should be valid: up to U+10FFFF, not a surrogate.
+@return The output string.
+*/
+inline String& utf8_append(String &str, UInt32 cp)
+{
+    if (cp < 0x80)
+        str.push_back(char(cp));
+    else if (cp < 0x800)
+    {
+        str.push_back(char(0xC0 | (cp>>6)));
+        str.push_back(char(0x80 | (cp&0x3F)));
+    }
+    else if (cp < 0x10000)
+    {
+        str.push_back(char(0xE0 | (cp>>12)));
+        str.push_back(char(0x80 | ((cp>>6)&0x3F)));
+        str.push_back(char(0x80 | (cp&0x3F)));
+    }
+    else
+    {
+        str.push_back(char(0xF0 | (cp>>18)));
+        str.push_back(char(0x80 | ((cp>>12)&0x3F)));
+        str.push_back(char(0x80 | ((cp>>6)&0x3F)));
+        str.push_back(char(0x80 | (cp&0x3F)));
+    }
+
+    return str;
+}
+
     } // misc namespace
 
 } // hive namespace
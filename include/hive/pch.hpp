@@ -39,6 +39,7 @@ Defines #HIVE_PCH macro if precompiled headers are enabled.
 #include <assert.h>
 #include <signal.h>
 #include <string.h>
+#include <locale.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
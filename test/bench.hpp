@@ -0,0 +1,329 @@
+/** @file
+@brief The test and benchmark helpers.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+This file is included once by each test or benchmark application.
+It replaces global `operator new` and `operator delete`
+to count heap allocations.
+*/
+#ifndef __HIVE_TEST_BENCH_HPP_
+#define __HIVE_TEST_BENCH_HPP_
+
+#include <hive/json.hpp>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <new>
+
+
+/// @name Allocation counters
+/// @{
+namespace bench
+{
+    static size_t g_allocs = 0; ///< @brief The number of allocations.
+    static size_t g_bytes = 0;  ///< @brief The number of allocated bytes.
+    static bool g_counting = true; ///< @brief The counters are enabled.
+    static const void *volatile g_sink = 0; ///< @brief The result sink.
+} // bench namespace
+/// @}
+
+
+void* operator new(size_t size)
+{
+    if (bench::g_counting) // might be disabled for multithreaded tests
+    {
+        bench::g_allocs += 1;
+        bench::g_bytes += size;
+    }
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) throw()
+{
+    free(p);
+}
+
+void operator delete[](void *p) throw()
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) throw()
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) throw()
+{
+    free(p);
+}
+
+
+/// @brief The test and benchmark helpers.
+namespace bench
+{
+    using namespace hive;
+
+
+/// @brief The allocation counter.
+/**
+Remembers the global counters on construction.
+*/
+class Allocs
+{
+public:
+
+    /// @brief The default constructor.
+    Allocs()
+        : m_allocs(g_allocs)
+        , m_bytes(g_bytes)
+    {}
+
+    /// @brief Get the number of allocations since construction.
+    size_t count() const
+    {
+        return g_allocs - m_allocs;
+    }
+
+    /// @brief Get the number of allocated bytes since construction.
+    size_t bytes() const
+    {
+        return g_bytes - m_bytes;
+    }
+
+private:
+    size_t m_allocs;
+    size_t m_bytes;
+};
+
+
+/// @brief The wall-clock timer.
+class Timer
+{
+public:
+
+    /// @brief The default constructor.
+    Timer()
+        : m_start(now())
+    {}
+
+    /// @brief Get the elapsed time in seconds.
+    double elapsed() const
+    {
+        return (now() - m_start).total_microseconds() * 1.0e-6;
+    }
+
+private:
+    static boost::posix_time::ptime now()
+    {
+        return boost::posix_time::microsec_clock::universal_time();
+    }
+
+private:
+    boost::posix_time::ptime m_start;
+};
+
+
+/// @brief Prevent the result from being optimized out.
+template<typename T> inline
+void use(T const& val)
+{
+    g_sink = &val;
+}
+
+
+/// @name Sample documents
+/// @{
+
+/// @brief Generate command or notification parameters.
+/**
+@param[in] seed The seed.
+@param[in] nparams The number of parameters.
+@return The parameters object.
+*/
+inline json::Value params(size_t seed, size_t nparams)
+{
+    json::Value jparams(json::Value::TYPE_OBJECT);
+    for (size_t i = 0; i < nparams; ++i)
+    {
+        OStringStream name;
+        name << "param" << i;
+        switch (i%4)
+        {
+            case 0: jparams[name.str()] = Int64(seed*31 + i); break;
+            case 1: jparams[name.str()] = (seed + i)*0.125; break;
+            case 2: jparams[name.str()] = (seed+i)%2 ? "on" : "off"; break;
+            case 3: jparams[name.str()] = "equipment value string #" + name.str(); break;
+        }
+    }
+    return jparams;
+}
+
+
+/// @brief Generate the command.
+/**
+@param[in] id The command identifier.
+@param[in] nparams The number of parameters.
+@return The command document.
+*/
+inline json::Value command(size_t id, size_t nparams = 4)
+{
+    json::Value jcmd;
+    jcmd["id"] = UInt64(id);
+    jcmd["timestamp"] = "2013-04-12T10:26:44.535114";
+    jcmd["userId"] = 1;
+    jcmd["command"] = id%2 ? "UpdateLedState" : "SetTemperature";
+    jcmd["parameters"] = params(id, nparams);
+    jcmd["lifetime"] = 600;
+    jcmd["flags"] = 0;
+    jcmd["status"] = json::Value();
+    jcmd["result"] = json::Value();
+    return jcmd;
+}
+
+
+/// @brief Generate the notification.
+/**
+@param[in] id The notification identifier.
+@param[in] nparams The number of parameters.
+@return The notification document.
+*/
+inline json::Value notification(size_t id, size_t nparams = 4)
+{
+    json::Value jntf;
+    jntf["id"] = UInt64(id);
+    jntf["timestamp"] = "2013-04-12T10:26:44.535114";
+    jntf["notification"] = "equipment";
+    jntf["parameters"] = params(id, nparams);
+    return jntf;
+}
+
+
+/// @brief Generate the device.
+/**
+@param[in] nequipment The number of equipment.
+@return The device document.
+*/
+inline json::Value device(size_t nequipment = 4)
+{
+    json::Value jdev;
+    jdev["id"] = "9f33566e-1f8f-11e2-8979-c42c030dd6a5";
+    jdev["key"] = "device-key";
+    jdev["name"] = "Simple Gateway Device";
+    jdev["status"] = "Online";
+    jdev["network"]["name"] = "Demo Network";
+    jdev["network"]["description"] = "The DeviceHive demo network";
+    jdev["deviceClass"]["name"] = "Simple Device Class";
+    jdev["deviceClass"]["version"] = "1.0";
+    jdev["deviceClass"]["isPermanent"] = false;
+    jdev["deviceClass"]["offlineTimeout"] = 600;
+
+    json::Value jeq(json::Value::TYPE_ARRAY);
+    for (size_t i = 0; i < nequipment; ++i)
+    {
+        OStringStream code;
+        code << "eq" << i;
+        json::Value e;
+        e["code"] = code.str();
+        e["name"] = "Equipment #" + code.str();
+        e["type"] = i%2 ? "Controllable LED" : "Temperature Sensor";
+        e["deviceClass"] = json::Value();
+        jeq.append(e);
+    }
+    jdev["equipment"] = jeq;
+    return jdev;
+}
+
+
+/// @brief Generate array of documents.
+/**
+@param[in] gen The document generator.
+@param[in] count The number of documents.
+@param[in] nparams The number of parameters.
+@return The array of documents.
+*/
+inline json::Value array(json::Value (*gen)(size_t, size_t), size_t count, size_t nparams = 4)
+{
+    json::Value jarr(json::Value::TYPE_ARRAY);
+    for (size_t i = 0; i < count; ++i)
+        jarr.append(gen(i+1, nparams));
+    return jarr;
+}
+
+/// @}
+
+
+/// @name Report helpers
+/// @{
+
+/// @brief Report the throughput.
+/**
+@param[in] name The measurement name.
+@param[in] bytes The total number of bytes processed.
+@param[in] secs The elapsed time in seconds.
+@param[in] docs The number of documents processed.
+@param[in] allocs The number of allocations.
+*/
+inline void report(const char *name, size_t bytes, double secs, size_t docs, size_t allocs)
+{
+    std::cout << "  " << std::left << std::setw(32) << name << std::right
+        << std::fixed << std::setprecision(1)
+        << std::setw(9) << (bytes/secs/1.0e6) << " MB/s"
+        << std::setw(10) << (docs/secs) << " docs/s"
+        << std::setw(9) << (double(allocs)/docs) << " allocs/doc\n";
+}
+
+/// @}
+
+
+/// @name Test helpers
+/// @{
+
+static int g_failures = 0; ///< @brief The number of failed checks.
+
+/// @brief Check the condition.
+/**
+Unlike assert() is not disabled in release build.
+*/
+#define CHECK(cond) \
+    do { if (!(cond)) { ++bench::g_failures; \
+        std::cerr << __FILE__ << ":" << __LINE__ \
+            << ": check failed: " << #cond << "\n"; } } while (0)
+
+
+/// @brief Check the expression throws.
+#define CHECK_THROW(expr, E) \
+    do { bool thrown_ = false; \
+        try { expr; } catch (E const&) { thrown_ = true; } \
+        CHECK(thrown_ && #expr " should throw " #E); } while (0)
+
+
+/// @brief Get the test result.
+/**
+@param[in] name The test name.
+@return The application exit code.
+*/
+inline int result(const char *name)
+{
+    if (g_failures)
+        std::cerr << name << ": " << g_failures << " check(s) failed\n";
+    else
+        std::cout << name << ": OK\n";
+    return g_failures ? 1 : 0;
+}
+
+/// @}
+
+} // bench namespace
+
+#endif // __HIVE_TEST_BENCH_HPP_
@@ -0,0 +1,62 @@
+/** @file
+@brief The arena-backed document benchmark.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+Counts heap allocations per parsed command for the poll response
+parsed to the heap-allocated value, to the new json::Document
+and to the reused json::Document (its arena blocks are kept).
+*/
+#include "bench.hpp"
+
+using namespace hive;
+
+
+int main(int argc, const char* argv[])
+{
+    const size_t N = (argc > 1) ? atoi(argv[1]) : 1000;
+    const int R = 50;
+
+    const String text = json::json2str(bench::array(bench::command, N));
+    std::cout << "JSON arena: " << N << " commands, "
+        << text.size() << " bytes\n";
+
+    { // heap
+        bench::Allocs allocs;
+        bench::Timer t;
+        for (int r = 0; r < R; ++r)
+        {
+            json::Value jval;
+            json::Parser::parse(text.data(), text.data() + text.size(), jval);
+            bench::use(jval);
+        }
+        bench::report("heap: parse + destroy", R*text.size(), t.elapsed(), R*N, allocs.count());
+    }
+
+    { // new document each time
+        bench::Allocs allocs;
+        bench::Timer t;
+        for (int r = 0; r < R; ++r)
+        {
+            json::Document doc;
+            doc.parse(text.data(), text.size());
+            bench::use(doc.getRoot());
+        }
+        bench::report("arena: new document", R*text.size(), t.elapsed(), R*N, allocs.count());
+    }
+
+    { // reused document
+        json::Document doc;
+        doc.parse(text.data(), text.size()); // warm up
+
+        bench::Allocs allocs;
+        bench::Timer t;
+        for (int r = 0; r < R; ++r)
+        {
+            doc.parse(text.data(), text.size());
+            bench::use(doc.getRoot());
+        }
+        bench::report("arena: reused document", R*text.size(), t.elapsed(), R*N, allocs.count());
+    }
+
+    return 0;
+}
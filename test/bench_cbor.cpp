@@ -0,0 +1,83 @@
+/** @file
+@brief The CBOR vs. JSON text benchmark.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+Compares size and encode/decode speed of CBOR and JSON text
+on command and notification payloads.
+*/
+#include "bench.hpp"
+
+#include <hive/cbor.hpp>
+
+using namespace hive;
+
+
+/// @brief Run the benchmark on the documents.
+/**
+@param[in] name The documents name.
+@param[in] docs The array of documents.
+*/
+void run(const char *name, json::Value const& docs)
+{
+    const size_t N = docs.size();
+    const int R = 20;
+
+    size_t textSize = 0, cborSize = 0;
+    std::vector<String> texts(N), cbors(N);
+    for (size_t i = 0; i < N; ++i)
+    {
+        texts[i] = json::json2str(docs[i]);
+        cbors[i] = cbor::json2cbor(docs[i]);
+        textSize += texts[i].size();
+        cborSize += cbors[i].size();
+    }
+
+    std::cout << name << ": " << N << " documents, text "
+        << textSize/N << " bytes/doc, CBOR " << cborSize/N << " bytes/doc ("
+        << std::fixed << std::setprecision(1) << 100.0*cborSize/textSize << "%)\n";
+
+    { // text encoding
+        bench::Allocs allocs;
+        bench::Timer t;
+        for (int r = 0; r < R; ++r)
+            for (size_t i = 0; i < N; ++i)
+                bench::use(json::json2str(docs[i]));
+        bench::report("json2str", R*textSize, t.elapsed(), R*N, allocs.count());
+    }
+
+    { // CBOR encoding
+        bench::Allocs allocs;
+        bench::Timer t;
+        for (int r = 0; r < R; ++r)
+            for (size_t i = 0; i < N; ++i)
+                bench::use(cbor::json2cbor(docs[i]));
+        bench::report("json2cbor", R*cborSize, t.elapsed(), R*N, allocs.count());
+    }
+
+    { // text decoding
+        bench::Allocs allocs;
+        bench::Timer t;
+        for (int r = 0; r < R; ++r)
+            for (size_t i = 0; i < N; ++i)
+                bench::use(json::str2json(texts[i]));
+        bench::report("str2json", R*textSize, t.elapsed(), R*N, allocs.count());
+    }
+
+    { // CBOR decoding
+        bench::Allocs allocs;
+        bench::Timer t;
+        for (int r = 0; r < R; ++r)
+            for (size_t i = 0; i < N; ++i)
+                bench::use(cbor::cbor2json(cbors[i]));
+        bench::report("cbor2json", R*cborSize, t.elapsed(), R*N, allocs.count());
+    }
+}
+
+
+int main()
+{
+    run("commands", bench::array(bench::command, 1000));
+    run("notifications", bench::array(bench::notification, 1000));
+    run("big notifications", bench::array(bench::notification, 1000, 40));
+    return 0;
+}
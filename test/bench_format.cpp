@@ -0,0 +1,142 @@
+/** @file
+@brief The JSON formatter benchmark.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+Formats and parses device, command and notification documents
+of different sizes:
+ - json2str() and json2hstr() to string;
+ - operator<<() and json::HumanFriendly to stream;
+ - str2json() from string.
+*/
+#include "bench.hpp"
+
+#include <streambuf>
+
+using namespace hive;
+
+
+/// @brief The null output buffer.
+/**
+Discards all the output, just counts the number of bytes.
+*/
+class NullBuf:
+    public std::streambuf
+{
+public:
+    NullBuf()
+        : m_size(0)
+    {}
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+protected:
+    int_type overflow(int_type ch)
+    {
+        m_size += 1;
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize n)
+    {
+        m_size += size_t(n);
+        return n;
+    }
+
+private:
+    size_t m_size;
+};
+
+
+/// @brief Run the benchmark on the documents.
+/**
+@param[in] name The documents name.
+@param[in] docs The array of documents.
+@param[in] R The number of repeats.
+*/
+void run(const char *name, json::Value const& docs, int R)
+{
+    const size_t N = docs.size();
+
+    size_t textSize = 0, htextSize = 0;
+    std::vector<String> texts(N);
+    for (size_t i = 0; i < N; ++i)
+    {
+        texts[i] = json::json2str(docs[i]);
+        textSize += texts[i].size();
+        htextSize += json::json2hstr(docs[i]).size();
+    }
+
+    std::cout << name << ": " << N << " documents, "
+        << textSize/N << " bytes/doc\n";
+
+    { // compact string
+        bench::Allocs allocs;
+        bench::Timer t;
+        for (int r = 0; r < R; ++r)
+            for (size_t i = 0; i < N; ++i)
+                bench::use(json::json2str(docs[i]));
+        bench::report("json2str", R*textSize, t.elapsed(), R*N, allocs.count());
+    }
+
+    { // human-friendly string
+        bench::Allocs allocs;
+        bench::Timer t;
+        for (int r = 0; r < R; ++r)
+            for (size_t i = 0; i < N; ++i)
+                bench::use(json::json2hstr(docs[i]));
+        bench::report("json2hstr", R*htextSize, t.elapsed(), R*N, allocs.count());
+    }
+
+    { // compact stream
+        NullBuf nb;
+        OStream os(&nb);
+        bench::Allocs allocs;
+        bench::Timer t;
+        for (int r = 0; r < R; ++r)
+            for (size_t i = 0; i < N; ++i)
+                os << docs[i];
+        bench::report("operator<<", nb.size(), t.elapsed(), R*N, allocs.count());
+    }
+
+    { // human-friendly stream
+        NullBuf nb;
+        OStream os(&nb);
+        bench::Allocs allocs;
+        bench::Timer t;
+        for (int r = 0; r < R; ++r)
+            for (size_t i = 0; i < N; ++i)
+                os << json::HumanFriendly(docs[i]);
+        bench::report("HumanFriendly", nb.size(), t.elapsed(), R*N, allocs.count());
+    }
+
+    { // parsing
+        bench::Allocs allocs;
+        bench::Timer t;
+        for (int r = 0; r < R; ++r)
+            for (size_t i = 0; i < N; ++i)
+                bench::use(json::str2json(texts[i]));
+        bench::report("str2json", R*textSize, t.elapsed(), R*N, allocs.count());
+    }
+}
+
+
+int main()
+{
+    json::Value devices(json::Value::TYPE_ARRAY);
+    json::Value bigDevices(json::Value::TYPE_ARRAY);
+    for (size_t i = 0; i < 100; ++i)
+    {
+        devices.append(bench::device(4));
+        bigDevices.append(bench::device(40));
+    }
+
+    run("devices", devices, 50);
+    run("big devices", bigDevices, 5);
+    run("commands", bench::array(bench::command, 1000), 20);
+    run("notifications", bench::array(bench::notification, 1000), 20);
+    run("big notifications", bench::array(bench::notification, 1000, 40), 5);
+    return 0;
+}
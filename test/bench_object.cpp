@@ -0,0 +1,75 @@
+/** @file
+@brief The JSON object member insert/lookup benchmark.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+Measures member insert and lookup on typical device objects
+of 5 to 20 members. Build with #HIVE_JSON_FLAT_OBJECTS
+(bench_object_flat target) to compare with `std::map` storage.
+*/
+#include "bench.hpp"
+
+using namespace hive;
+
+
+int main()
+{
+    const int R = 200000;
+
+#if defined(HIVE_JSON_FLAT_OBJECTS)
+    std::cout << "JSON object members (flat storage):\n";
+#else
+    std::cout << "JSON object members (std::map storage):\n";
+#endif // HIVE_JSON_FLAT_OBJECTS
+
+    const size_t sizes[] = { 5, 10, 20 };
+    for (size_t k = 0; k < sizeof(sizes)/sizeof(sizes[0]); ++k)
+    {
+        const size_t M = sizes[k];
+
+        // typical member names
+        std::vector<String> names;
+        const char* typical[] = { "id", "name", "key", "status", "network",
+            "deviceClass", "equipment", "timestamp", "parameters", "lifetime" };
+        for (size_t i = 0; i < M; ++i)
+        {
+            OStringStream name;
+            name << typical[i%10];
+            if (i >= 10)
+                name << i;
+            names.push_back(name.str());
+        }
+
+        json::Value jobj;
+        double insertTime = 0.0;
+        size_t insertAllocs = 0;
+        for (int r = 0; r < R/10; ++r)
+        {
+            json::Value tmp(json::Value::TYPE_OBJECT);
+            bench::Allocs allocs;
+            bench::Timer t;
+            for (size_t i = 0; i < M; ++i)
+                tmp[names[i]] = Int64(i);
+            insertTime += t.elapsed();
+            insertAllocs += allocs.count();
+            tmp.swap(jobj);
+        }
+
+        bench::Timer t;
+        Int64 sum = 0;
+        for (int r = 0; r < R; ++r)
+        {
+            for (size_t i = 0; i < M; ++i)
+                sum += jobj[names[(i*7)%M]].asInt();
+        }
+        const double lookupTime = t.elapsed();
+        bench::use(sum);
+
+        std::cout << std::fixed << std::setprecision(1)
+            << "  " << std::setw(2) << M << " members:"
+            << " insert " << std::setw(6) << 1.0e9*insertTime/(R/10)/M << " ns/member"
+            << " (" << double(insertAllocs)/(R/10)/M << " allocs),"
+            << " lookup " << std::setw(6) << 1.0e9*lookupTime/R/M << " ns/member\n";
+    }
+
+    return 0;
+}
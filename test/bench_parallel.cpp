@@ -0,0 +1,53 @@
+/** @file
+@brief The parallel JSON array parsing benchmark.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+Parses a multi-megabyte array of notifications (bulk import)
+using 1 to 8 threads and reports the speedup.
+Should be built with #HIVE_JSON_PARALLEL.
+*/
+#include "bench.hpp"
+
+using namespace hive;
+
+
+int main(int argc, const char* argv[])
+{
+    const size_t N = (argc > 1) ? atoi(argv[1]) : 50000;
+    const int R = 5;
+
+    bench::g_counting = false; // shared counters don't scale
+    const String text = json::json2str(bench::array(bench::notification, N, 8));
+    const json::Value expected = json::str2json(text);
+
+    std::cout << "JSON parallel parsing: " << N << " notifications, "
+        << text.size()/1024 << " KB, "
+        << boost::thread::hardware_concurrency() << " CPUs\n";
+
+    double base = 0.0;
+    for (size_t threads = 1; threads <= 8; ++threads)
+    {
+        bench::Timer t;
+        for (int r = 0; r < R; ++r)
+        {
+            json::Value jval;
+            json::ArrayParser::parse(text.data(), text.data() + text.size(), jval, threads);
+            if (0 == r && jval != expected)
+            {
+                std::cerr << "parallel result is different\n";
+                return 1;
+            }
+        }
+
+        const double secs = t.elapsed()/R;
+        if (1 == threads)
+            base = secs;
+
+        std::cout << "  " << threads << " thread(s): "
+            << std::fixed << std::setprecision(1)
+            << std::setw(8) << text.size()/secs/1.0e6 << " MB/s, speedup "
+            << std::setprecision(2) << base/secs << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+/** @file
+@brief The HTTP pipelining benchmark.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+Sends short requests to the loopback HTTP server keeping a fixed
+number of them in flight:
+ - send() on kept-alive connections (one request per connection at once);
+ - sendPipelined() on one connection, different pipeline depths.
+
+Reports requests per second, allocations and server connections.
+*/
+#include "bench.hpp"
+#include "loopback.hpp"
+
+using namespace hive;
+
+typedef boost::system::error_code ErrorCode;
+
+
+/// @brief The request generator.
+/**
+Keeps the fixed number of requests in flight.
+*/
+class Runner
+{
+public:
+
+    /// @brief The main constructor.
+    /**
+    @param[in] client The HTTP client.
+    @param[in] url The request URL.
+    @param[in] total The total number of requests.
+    @param[in] pipelined Use sendPipelined() or send().
+    */
+    Runner(http::Client::SharedPtr client, http::Url const& url, size_t total, bool pipelined)
+        : m_client(client)
+        , m_url(url)
+        , m_total(total)
+        , m_sent(0)
+        , m_done(0)
+        , m_failed(0)
+        , m_pipelined(pipelined)
+    {}
+
+    /// @brief Start the requests.
+    /**
+    @param[in] inflight The number of requests in flight.
+    */
+    void start(size_t inflight)
+    {
+        for (size_t i = 0; i < inflight; ++i)
+            next();
+    }
+
+    /// @brief Are all requests done?
+    bool isDone() const
+    {
+        return m_done == m_total;
+    }
+
+    /// @brief Get the number of failed requests.
+    size_t getFailed() const
+    {
+        return m_failed;
+    }
+
+private:
+
+    /// @brief Send the next request.
+    void next()
+    {
+        if (m_sent == m_total)
+            return;
+
+        m_sent += 1;
+        http::Request::SharedPtr req = http::Request::POST(m_url, "application/json", "{\"n\":1}");
+        http::Client::Callback cb = boost::bind(&Runner::onResponse, this, _1, _2, _3);
+        if (m_pipelined)
+            m_client->sendPipelined(req, cb, 10000);
+        else
+            m_client->send(req, cb, 10000);
+    }
+
+    void onResponse(ErrorCode err, http::Request::SharedPtr, http::Response::SharedPtr response)
+    {
+        m_done += 1;
+        if (err || !response || 200 != response->getStatusCode())
+            m_failed += 1;
+        next();
+    }
+
+private:
+    http::Client::SharedPtr m_client;
+    http::Url m_url;
+    size_t m_total;
+    size_t m_sent;
+    size_t m_done;
+    size_t m_failed;
+    bool m_pipelined;
+};
+
+
+/// @brief Run the benchmark.
+/**
+@param[in] name The measurement name.
+@param[in] N The number of requests.
+@param[in] inflight The number of requests in flight.
+@param[in] depth The pipeline depth, zero to use send().
+*/
+void run(const char *name, size_t N, size_t inflight, size_t depth)
+{
+    boost::asio::io_service ios;
+    bench::LoopbackServer server(ios);
+
+    http::Client::SharedPtr client = http::Client::create(ios);
+    client->setKeepAlive(inflight);
+    client->setPipelining(depth);
+
+    Runner runner(client, server.getUrl("/"), N, 0 < depth);
+    bench::Allocs allocs;
+    bench::Timer t;
+    runner.start(inflight);
+    while (!runner.isDone() && ios.run_one())
+        ;
+    const double secs = t.elapsed();
+
+    std::cout << "  " << std::left << std::setw(24) << name << std::right
+        << std::fixed << std::setprecision(1)
+        << std::setw(10) << N/secs << " req/s"
+        << std::setw(9) << double(allocs.count())/N << " allocs/req"
+        << std::setw(5) << server.getConnections() << " connections";
+    if (runner.getFailed())
+        std::cout << ", " << runner.getFailed() << " failed";
+    std::cout << "\n";
+}
+
+
+int main(int argc, const char* argv[])
+{
+    const size_t N = (argc > 1) ? atoi(argv[1]) : 10000;
+    const size_t inflight = 8;
+
+    std::cout << "HTTP loopback: " << N << " requests, "
+        << inflight << " in flight\n";
+    run("send(), keep-alive", N, inflight, 0);
+    run("sendPipelined(), depth 1", N, inflight, 1);
+    run("sendPipelined(), depth 2", N, inflight, 2);
+    run("sendPipelined(), depth 4", N, inflight, 4);
+    run("sendPipelined(), depth 8", N, inflight, 8);
+    return 0;
+}
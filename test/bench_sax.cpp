@@ -0,0 +1,88 @@
+/** @file
+@brief The DOM vs. SAX decoding benchmark.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+Decodes the poll response of 1000 commands into the command list:
+ - DOM: parse the JSON document and convert each element by json2cmd();
+ - SAX: parse events directly into commands by CommandListReader.
+*/
+#include <hive/pch.hpp>
+#include "bench.hpp"
+
+#include <DeviceHive/cloud6.hpp>
+
+using namespace hive;
+using namespace cloud6;
+
+
+/// @brief Decode commands via JSON document.
+void decodeDOM(String const& text, std::vector<Command> &commands)
+{
+    const json::Value jval = json::str2json(text);
+    const size_t N = jval.size();
+    commands.reserve(N);
+    for (size_t i = 0; i < N; ++i)
+        commands.push_back(ServerAPI::Serializer::json2cmd(jval[i]));
+}
+
+
+/// @brief Decode commands via JSON events.
+void decodeSAX(String const& text, std::vector<Command> &commands)
+{
+    ServerAPI::Serializer::CommandListReader reader(commands);
+    json::str2json(text.data(), text.size(), reader);
+}
+
+
+int main(int argc, const char* argv[])
+{
+    const size_t N = (argc > 1) ? atoi(argv[1]) : 1000;
+    const int R = 50;
+
+    const String text = json::json2str(bench::array(bench::command, N));
+    std::cout << "DOM vs. SAX: " << N << " commands, "
+        << text.size() << " bytes\n";
+
+    { // check both give the same result
+        std::vector<Command> a, b;
+        decodeDOM(text, a);
+        decodeSAX(text, b);
+        bool same = (a.size() == b.size());
+        for (size_t i = 0; same && i < a.size(); ++i)
+        {
+            same = a[i].id == b[i].id && a[i].name == b[i].name
+                && a[i].params == b[i].params && a[i].lifetime == b[i].lifetime;
+        }
+        if (!same)
+        {
+            std::cerr << "DOM and SAX results are different\n";
+            return 1;
+        }
+    }
+
+    {
+        bench::Allocs allocs;
+        bench::Timer t;
+        for (int r = 0; r < R; ++r)
+        {
+            std::vector<Command> commands;
+            decodeDOM(text, commands);
+            bench::use(commands);
+        }
+        bench::report("DOM: str2json + json2cmd", R*text.size(), t.elapsed(), R*N, allocs.count());
+    }
+
+    {
+        bench::Allocs allocs;
+        bench::Timer t;
+        for (int r = 0; r < R; ++r)
+        {
+            std::vector<Command> commands;
+            decodeSAX(text, commands);
+            bench::use(commands);
+        }
+        bench::report("SAX: CommandListReader", R*text.size(), t.elapsed(), R*N, allocs.count());
+    }
+
+    return 0;
+}
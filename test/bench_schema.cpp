@@ -0,0 +1,138 @@
+/** @file
+@brief The schema vs. exception-based deserializers benchmark.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+Converts parsed commands and notifications to the typed structures
+using the schema-based cloud6 json2cmd() and json2ntf() and using
+the exception-based deserializers (as they were written before).
+Both valid and partially invalid document sets are measured.
+*/
+#include <hive/pch.hpp>
+#include "bench.hpp"
+
+#include <DeviceHive/cloud6.hpp>
+
+using namespace hive;
+using namespace cloud6;
+
+typedef ServerAPI::Serializer Serializer;
+
+
+/// @brief The exception-based command deserializer.
+Command oldJson2cmd(json::Value const& jval)
+{
+    try
+    {
+        Command cmd;
+        cmd.id = jval["id"].asUInt();
+        cmd.name = jval["command"].asString();
+        cmd.params = jval["parameters"];
+        cmd.lifetime = int(jval["lifetime"].asInt());
+        cmd.flags = int(jval["flags"].asInt());
+        cmd.status = jval["status"].asString();
+        cmd.result = jval["result"].asString();
+        return cmd;
+    }
+    catch (std::exception const& ex)
+    {
+        OStringStream ess;
+        ess << "failed to deserialize Command:\n"
+            << ex.what();
+        throw std::runtime_error(ess.str().c_str());
+    }
+}
+
+
+/// @brief The exception-based notification deserializer.
+Notification oldJson2ntf(json::Value const& jval)
+{
+    try
+    {
+        Notification ntf;
+        ntf.id = jval["id"].asUInt();
+        ntf.name = jval["notification"].asString();
+        ntf.params = jval["parameters"];
+        return ntf;
+    }
+    catch (std::exception const& ex)
+    {
+        OStringStream ess;
+        ess << "failed to deserialize Notification:\n"
+            << ex.what();
+        throw std::runtime_error(ess.str().c_str());
+    }
+}
+
+
+/// @brief Run the deserializer on all the documents.
+/**
+@param[in] name The measurement name.
+@param[in] docs The array of documents.
+@param[in] conv The deserializer.
+@param[in] R The number of repeats.
+*/
+template<typename T>
+void run(const char *name, json::Value const& docs, T (*conv)(json::Value const&), int R)
+{
+    const size_t N = docs.size();
+    size_t failed = 0;
+
+    bench::Allocs allocs;
+    bench::Timer t;
+    for (int r = 0; r < R; ++r)
+        for (size_t i = 0; i < N; ++i)
+    {
+        try
+        {
+            bench::use(conv(docs[i]));
+        }
+        catch (std::exception const&)
+        {
+            failed += 1;
+        }
+    }
+    const double secs = t.elapsed();
+
+    std::cout << "  " << std::left << std::setw(32) << name << std::right
+        << std::fixed << std::setprecision(1)
+        << std::setw(10) << (R*N/secs) << " docs/s"
+        << std::setw(9) << double(allocs.count())/(R*N) << " allocs/doc"
+        << std::setw(7) << failed/R << " failed\n";
+}
+
+
+int main()
+{
+    const size_t N = 1000;
+    const int R = 20;
+
+    const json::Value commands = bench::array(bench::command, N);
+    const json::Value notifications = bench::array(bench::notification, N);
+
+    // every 10th document is invalid
+    json::Value badCommands = commands;
+    json::Value badNotifications = notifications;
+    for (size_t i = 0; i < N; i += 10)
+    {
+        badCommands[i]["lifetime"] = "forever";
+        badNotifications[i]["id"] = json::Value(json::Value::TYPE_ARRAY);
+    }
+
+    std::cout << "commands (" << N << " valid):\n";
+    run("exception-based", commands, oldJson2cmd, R);
+    run("schema json2cmd()", commands, Serializer::json2cmd, R);
+
+    std::cout << "commands (10% invalid):\n";
+    run("exception-based", badCommands, oldJson2cmd, R);
+    run("schema json2cmd()", badCommands, Serializer::json2cmd, R);
+
+    std::cout << "notifications (" << N << " valid):\n";
+    run("exception-based", notifications, oldJson2ntf, R);
+    run("schema json2ntf()", notifications, Serializer::json2ntf, R);
+
+    std::cout << "notifications (10% invalid):\n";
+    run("exception-based", badNotifications, oldJson2ntf, R);
+    run("schema json2ntf()", badNotifications, Serializer::json2ntf, R);
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+/** @file
+@brief The JSON value storage benchmark.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+Measures per-node memory and the cost of parse, copy and destroy
+for a large notification array. The layout before tagged union
+(all the alternatives are constructed) is emulated by LegacyValue
+to compare the node size.
+*/
+#include "bench.hpp"
+
+#include <vector>
+#include <map>
+
+using namespace hive;
+
+
+/// @brief The legacy JSON value layout.
+/**
+All the alternatives are members, as json::Value had before.
+*/
+struct LegacyValue
+{
+    json::Value::Type m_type;
+    union
+    {
+        double f;
+        UInt64 u;
+        Int64 i;
+    } m_val;
+    String m_str;
+    std::vector<LegacyValue> m_arr;
+    std::map<String, LegacyValue> m_obj;
+};
+
+
+/// @brief Count all the nodes in JSON tree.
+size_t countNodes(json::Value const& jval)
+{
+    size_t n = 1;
+    if (jval.isArray())
+    {
+        for (size_t i = 0; i < jval.size(); ++i)
+            n += countNodes(jval[i]);
+    }
+    else if (jval.isObject())
+    {
+        json::Value::MemberIterator m = jval.membersBegin();
+        for (; m != jval.membersEnd(); ++m)
+            n += countNodes(m->second);
+    }
+    return n;
+}
+
+
+int main(int argc, const char* argv[])
+{
+    const size_t N = (argc > 1) ? atoi(argv[1]) : 10000;
+    const int R = 10;
+
+    const String text = json::json2str(bench::array(bench::notification, N));
+    const size_t nodes = countNodes(json::str2json(text));
+
+    std::cout << "JSON value: " << N << " notifications, "
+        << nodes << " nodes, " << text.size() << " bytes\n";
+    std::cout << "  sizeof(json::Value)       " << sizeof(json::Value) << " bytes\n";
+    std::cout << "  sizeof(LegacyValue)       " << sizeof(LegacyValue) << " bytes\n";
+
+    { // memory
+        bench::Allocs allocs;
+        json::Value jval = json::str2json(text);
+        std::cout << "  per-node heap memory      " << std::fixed << std::setprecision(1)
+            << double(allocs.bytes())/nodes << " bytes\n";
+        std::cout << "  per-node allocations      "
+            << double(allocs.count())/nodes << "\n";
+    }
+
+    double parseTime = 0.0;
+    double copyTime = 0.0;
+    double destroyTime = 0.0;
+    for (int r = 0; r < R; ++r)
+    {
+        bench::Timer t1;
+        json::Value *a = new json::Value(json::str2json(text));
+        parseTime += t1.elapsed();
+
+        bench::Timer t2;
+        json::Value *b = new json::Value(*a);
+        copyTime += t2.elapsed();
+
+        bench::Timer t3;
+        delete a;
+        delete b;
+        destroyTime += t3.elapsed()/2;
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+        << "  parse                     " << 1.0e9*parseTime/R/nodes << " ns/node\n"
+        << "  copy                      " << 1.0e9*copyTime/R/nodes << " ns/node\n"
+        << "  destroy                   " << 1.0e9*destroyTime/R/nodes << " ns/node\n";
+
+    return 0;
+}
@@ -0,0 +1,272 @@
+/** @file
+@brief The loopback HTTP server for tests and benchmarks.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+The server runs on the same IO service as the client under test.
+It answers the requests one by one in the receive order, so pipelined
+requests are supported. The connections are kept alive by default,
+see setCloseAfter() and setResetOn() to simulate broken connections.
+*/
+#ifndef __HIVE_TEST_LOOPBACK_HPP_
+#define __HIVE_TEST_LOOPBACK_HPP_
+
+#include <hive/http.hpp>
+
+
+namespace bench
+{
+    using namespace hive;
+
+/// @brief The loopback HTTP server.
+class LoopbackServer
+{
+    typedef boost::asio::ip::tcp tcp;
+    typedef boost::system::error_code ErrorCode;
+
+    /// @brief The server connection.
+    struct Connection
+    {
+        explicit Connection(boost::asio::io_service &ios)
+            : socket(ios), timer(ios), requests(0)
+        {}
+
+        tcp::socket socket; ///< @brief The socket.
+        size_t requests; ///< @brief The number of requests on this connection.
+        boost::asio::deadline_timer timer; ///< @brief The response delay timer.
+        boost::asio::streambuf rx_buf; ///< @brief The receive buffer.
+        String response; ///< @brief The response being sent.
+    };
+
+    typedef boost::shared_ptr<Connection> ConnectionPtr;
+
+public:
+
+    /// @brief The main constructor.
+    /**
+    @param[in] ios The IO service.
+    @param[in] delay_ms The delay of each response, milliseconds.
+    */
+    explicit LoopbackServer(boost::asio::io_service &ios, size_t delay_ms = 0)
+        : m_ios(ios)
+        , m_acceptor(ios, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0))
+        , m_delay_ms(delay_ms)
+        , m_keepAlive(true)
+        , m_closeAfter(0)
+        , m_resetOn(0)
+        , m_connections(0)
+        , m_requests(0)
+        , m_badRequests(0)
+        , m_closed(0)
+    {
+        accept();
+    }
+
+public:
+
+    /// @brief Enable or disable persistent connections.
+    /**
+    If disabled, each response has "Connection: close" header
+    and the connection is closed after it.
+
+    @param[in] enabled The "keep-alive" flag, enabled by default.
+    */
+    void setKeepAlive(bool enabled)
+    {
+        m_keepAlive = enabled;
+    }
+
+
+    /// @brief Close connections after a few responses.
+    /**
+    The connection is closed without "Connection: close" header,
+    as the server does on idle timeout.
+
+    @param[in] responses The number of responses per connection, zero to keep alive.
+    */
+    void setCloseAfter(size_t responses)
+    {
+        m_closeAfter = responses;
+    }
+
+
+    /// @brief Reset connections on the request.
+    /**
+    The connection is reset (RST) once the request headers are received,
+    the request content is not read.
+
+    @param[in] request The request number on connection (1-based), zero to disable.
+    */
+    void setResetOn(size_t request)
+    {
+        m_resetOn = request;
+    }
+
+public:
+
+    /// @brief Get the server URL.
+    /**
+    @param[in] path The URL path.
+    @return The server URL.
+    */
+    http::Url getUrl(String const& path = "/") const
+    {
+        OStringStream oss;
+        oss << "http://127.0.0.1:" << m_acceptor.local_endpoint().port() << path;
+        return http::Url(oss.str());
+    }
+
+    /// @brief Get the number of accepted connections.
+    size_t getConnections() const
+    {
+        return m_connections;
+    }
+
+    /// @brief Get the number of received requests.
+    size_t getRequests() const
+    {
+        return m_requests;
+    }
+
+    /// @brief Get the number of requests without valid request line.
+    size_t getBadRequests() const
+    {
+        return m_badRequests;
+    }
+
+    /// @brief Get the number of connections closed by server.
+    size_t getClosed() const
+    {
+        return m_closed;
+    }
+
+private:
+
+    /// @brief Accept the next connection.
+    void accept()
+    {
+        ConnectionPtr c(new Connection(m_ios));
+        m_acceptor.async_accept(c->socket,
+            boost::bind(&LoopbackServer::onAccept, this, _1, c));
+    }
+
+    void onAccept(ErrorCode err, ConnectionPtr c)
+    {
+        if (err)
+            return;
+
+        m_connections += 1;
+        readHeaders(c);
+        accept();
+    }
+
+    /// @brief Read the next request headers.
+    void readHeaders(ConnectionPtr c)
+    {
+        boost::asio::async_read_until(c->socket, c->rx_buf, "\r\n\r\n",
+            boost::bind(&LoopbackServer::onHeaders, this, _1, _2, c));
+    }
+
+    void onHeaders(ErrorCode err, size_t len, ConnectionPtr c)
+    {
+        if (err)
+            return;
+
+        const char *data = boost::asio::buffer_cast<const char*>(c->rx_buf.data());
+        const String headers(data, len);
+        c->rx_buf.consume(len);
+
+        c->requests += 1;
+        if (c->requests == m_resetOn)
+        {
+            boost::system::error_code ignored;
+            c->socket.set_option(tcp::socket::linger(true, 0), ignored);
+            c->socket.close(ignored);
+            m_closed += 1;
+            return;
+        }
+
+        // "METHOD /path HTTP/1.x"
+        const String::size_type sp = headers.find(' ');
+        if (String::npos == sp || 0 == sp || headers.compare(sp, 2, " /") != 0
+            || headers.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZ") != sp)
+                m_badRequests += 1;
+
+        size_t contentLength = 0;
+        const String::size_type i = headers.find("Content-Length:");
+        if (String::npos != i)
+            contentLength = size_t(atoi(headers.c_str() + i + 15));
+
+        const size_t buffered = c->rx_buf.size();
+        if (buffered < contentLength)
+            boost::asio::async_read(c->socket, c->rx_buf,
+                boost::asio::transfer_exactly(contentLength - buffered),
+                boost::bind(&LoopbackServer::onContent, this, _1, contentLength, c));
+        else
+            onContent(ErrorCode(), contentLength, c);
+    }
+
+    void onContent(ErrorCode err, size_t contentLength, ConnectionPtr c)
+    {
+        if (err)
+            return;
+
+        c->rx_buf.consume(contentLength);
+        m_requests += 1;
+
+        OStringStream oss;
+        oss << "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n";
+        if (!m_keepAlive)
+            oss << "Connection: close\r\n";
+        oss << "\r\nOK";
+        c->response = oss.str();
+
+        if (0 < m_delay_ms)
+        {
+            c->timer.expires_from_now(boost::posix_time::milliseconds(m_delay_ms));
+            c->timer.async_wait(boost::bind(&LoopbackServer::writeResponse, this, _1, c));
+        }
+        else
+            writeResponse(ErrorCode(), c);
+    }
+
+    void writeResponse(ErrorCode err, ConnectionPtr c)
+    {
+        if (err)
+            return;
+
+        boost::asio::async_write(c->socket, boost::asio::buffer(c->response),
+            boost::bind(&LoopbackServer::onResponse, this, _1, c));
+    }
+
+    void onResponse(ErrorCode err, ConnectionPtr c)
+    {
+        if (err)
+            return;
+
+        if (!m_keepAlive || (0 < m_closeAfter && m_closeAfter <= c->requests))
+        {
+            boost::system::error_code ignored;
+            c->socket.shutdown(tcp::socket::shutdown_both, ignored);
+            c->socket.close(ignored);
+            m_closed += 1;
+        }
+        else
+            readHeaders(c);
+    }
+
+private:
+    boost::asio::io_service &m_ios;
+    tcp::acceptor m_acceptor;
+    size_t m_delay_ms;
+    bool m_keepAlive;
+    size_t m_closeAfter;
+    size_t m_resetOn;
+    size_t m_connections;
+    size_t m_requests;
+    size_t m_badRequests;
+    size_t m_closed;
+};
+
+} // bench namespace
+
+#endif // __HIVE_TEST_LOOPBACK_HPP_
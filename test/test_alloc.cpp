@@ -0,0 +1,160 @@
+/** @file
+@brief The serializer allocation tests.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+Counts heap allocations on the hot serializer paths:
+ - reading string fields of JSON values doesn't copy them;
+ - cloud6 command and notification deserialization allocates
+   only for the parameters copy;
+ - gateway JSON to binary conversion doesn't allocate at all.
+*/
+#include <hive/pch.hpp>
+#include "bench.hpp"
+
+#include <DeviceHive/cloud6.hpp>
+#include <DeviceHive/gateway.hpp>
+
+#include <streambuf>
+
+using namespace hive;
+
+
+/// @brief The fixed memory output buffer.
+/**
+Never allocates, the output is truncated if buffer is full.
+*/
+class FixedBuf:
+    public std::streambuf
+{
+public:
+    FixedBuf(char *buf, size_t len)
+    {
+        setp(buf, buf + len);
+    }
+
+    size_t size() const
+    {
+        return pptr() - pbase();
+    }
+};
+
+
+/// @brief Count allocations of copying the JSON value.
+size_t copyAllocs(json::Value const& jval)
+{
+    bench::Allocs allocs;
+    json::Value copy(jval);
+    return allocs.count();
+}
+
+
+/// @brief Test the string accessors.
+void testStrings()
+{
+    json::Value jshort("Online");
+    json::Value jlong("a long string value, not stored inline");
+    json::Value jobj;
+    jobj["status"] = jshort;
+    jobj["name"] = jlong;
+    json::Value const& cobj = jobj;
+
+    bench::Allocs allocs;
+    size_t len = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        len += jshort.asStringRef().size();
+        len += jlong.asStringRef().size();
+        len += cobj["status"].asStringRef().size();
+        len += cobj["name"].asStringRef().size();
+        len += cobj["missing"].asStringRef().size();
+    }
+    CHECK(len != 0);
+    CHECK(allocs.count() == 0);
+
+    { // short strings are stored inline
+        bench::Allocs a;
+        json::Value jval("Offline");
+        json::Value copy(jval);
+        CHECK(a.count() == 0);
+    }
+}
+
+
+/// @brief Test the cloud6 deserialization.
+void testCloud6()
+{
+    typedef cloud6::ServerAPI::Serializer Serializer;
+
+    const json::Value jcmd = json::str2json(json::json2str(bench::command(1)));
+    const size_t paramsAllocs = copyAllocs(jcmd["parameters"]);
+    CHECK(paramsAllocs != 0);
+
+    {
+        Serializer::json2cmd(jcmd); // warm up static schema
+        bench::Allocs allocs;
+        cloud6::Command cmd = Serializer::json2cmd(jcmd);
+        CHECK(allocs.count() == paramsAllocs);
+        CHECK(cmd.id == 1 && cmd.lifetime == 600);
+    }
+
+    const json::Value jntf = json::str2json(json::json2str(bench::notification(1)));
+    {
+        Serializer::json2ntf(jntf); // warm up static schema
+        bench::Allocs allocs;
+        cloud6::Notification ntf = Serializer::json2ntf(jntf);
+        CHECK(allocs.count() == copyAllocs(jntf["parameters"]));
+        CHECK(ntf.name == "equipment");
+    }
+}
+
+
+/// @brief Test the gateway JSON to binary conversion.
+void testGateway()
+{
+    using namespace gateway;
+    typedef API<boost::asio::serial_port>::Serializer Serializer;
+
+    Layout::SharedPtr item = Layout::create();
+    item->add("code", DT_STRING);
+    item->add("value", DT_INT16);
+
+    Layout::SharedPtr layout = Layout::create();
+    layout->add("id", DT_UINT32);
+    layout->add("state", DT_STRING);
+    layout->add("description", DT_STRING);
+    layout->add("enabled", DT_BOOL);
+    layout->add("temperature", DT_DOUBLE);
+    layout->add("items", DT_ARRAY, item);
+
+    json::Value jval;
+    jval["id"] = 42;
+    jval["state"] = "on";
+    jval["description"] = "a long string value, not stored inline";
+    jval["enabled"] = true;
+    jval["temperature"] = 36.6;
+    for (int i = 0; i < 10; ++i)
+    {
+        json::Value &e = jval["items"].append();
+        e["code"] = "eq";
+        e["value"] = i;
+    }
+
+    char buf[1024];
+    FixedBuf fb(buf, sizeof(buf));
+    OStream os(&fb);
+    io::BinaryOStream bs(os);
+
+    bench::Allocs allocs;
+    Serializer::json2bin(jval, bs, layout);
+    CHECK(allocs.count() == 0);
+    CHECK(fb.size() == 4 + (2+2) + (2+38) + 1 + 8 + 2 + 10*(2+2+2));
+}
+
+
+int main()
+{
+    testStrings();
+    testCloud6();
+    testGateway();
+    return bench::result("test_alloc");
+}
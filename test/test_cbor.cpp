@@ -0,0 +1,107 @@
+/** @file
+@brief The CBOR module tests.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+*/
+#include "bench.hpp"
+
+#include <hive/cbor.hpp>
+
+using namespace hive;
+
+
+/// @brief Check the JSON value survives the CBOR round trip.
+bool roundTrip(json::Value const& jval)
+{
+    const json::Value res = cbor::cbor2json(cbor::json2cbor(jval));
+    return res == jval && json::json2str(res) == json::json2str(jval);
+}
+
+
+/// @brief Make the string from bytes.
+String bytes(const char *data, size_t len)
+{
+    return String(data, len);
+}
+
+
+/// @brief Test the integer limits.
+void testIntegers()
+{
+    const UInt64 UMAX = std::numeric_limits<UInt64>::max();
+    const Int64 IMAX = std::numeric_limits<Int64>::max();
+    const Int64 IMIN = std::numeric_limits<Int64>::min();
+
+    // the biggest unsigned integer is decoded and encoded back exactly
+    const String umax = bytes("\x1B\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF", 9);
+    const json::Value jumax = cbor::cbor2json(umax);
+    CHECK(jumax.isUInteger() && jumax.asUInt() == UMAX);
+    CHECK(cbor::json2cbor(jumax) == umax);
+    CHECK(json::json2str(jumax) == "18446744073709551615");
+
+    // Int64 maximum plus one
+    const String imax1 = bytes("\x1B\x80\x00\x00\x00\x00\x00\x00\x00", 9);
+    CHECK(cbor::json2cbor(cbor::cbor2json(imax1)) == imax1);
+
+    // -1 is still negative
+    CHECK(cbor::json2cbor(json::Value(Int64(-1))) == "\x20");
+
+    CHECK(roundTrip(json::Value(UMAX)));
+    CHECK(roundTrip(json::Value(UInt64(IMAX) + 1)));
+    CHECK(roundTrip(json::Value(IMAX)));
+    CHECK(roundTrip(json::Value(IMIN)));
+    CHECK(roundTrip(json::Value(Int64(0))));
+    CHECK(roundTrip(json::str2json("[18446744073709551615, -9223372036854775808, 9223372036854775807]")));
+}
+
+
+/// @brief Test the documents.
+void testDocuments()
+{
+    CHECK(roundTrip(json::Value()));
+    CHECK(roundTrip(json::Value(true)));
+    CHECK(roundTrip(json::Value(0.1)));
+    CHECK(roundTrip(json::Value(1.5)));
+    CHECK(roundTrip(json::Value("")));
+    CHECK(roundTrip(json::Value("a long string value, not stored inline")));
+    CHECK(roundTrip(bench::device(10)));
+    CHECK(roundTrip(bench::array(bench::command, 100)));
+    CHECK(roundTrip(bench::array(bench::notification, 100, 20)));
+}
+
+
+/// @brief Test the floating-point values out of single precision range.
+void testDoubles()
+{
+    CHECK(roundTrip(json::Value(1e300)));
+    CHECK(roundTrip(json::Value(-1e300)));
+    CHECK(roundTrip(json::Value(1e-300)));
+    CHECK(roundTrip(json::Value(double(std::numeric_limits<float>::max()))));
+    CHECK(cbor::json2cbor(json::Value(1e300))[0] == char(0xFB));
+    CHECK(cbor::json2cbor(json::Value(1.5)) == bytes("\xFA\x3F\xC0\x00\x00", 5));
+}
+
+
+/// @brief Test the binary strings are written as byte strings.
+void testBinaryStrings()
+{
+    const String bin = "\xFF\x80 ok";
+    CHECK(cbor::json2cbor(json::Value(bin)) == "\x45" + bin);
+    CHECK(cbor::json2cbor(json::Value("ok")) == "\x62ok");
+    CHECK(cbor::json2cbor(json::Value("\xC3")) == "\x41\xC3"); // incomplete
+    CHECK(cbor::json2cbor(json::Value("\xC3\xBF")) == "\x62\xC3\xBF");
+    CHECK(roundTrip(json::Value(bin)));
+
+    json::Value jobj;
+    jobj[bin] = bin;
+    CHECK(roundTrip(jobj));
+}
+
+
+int main()
+{
+    testIntegers();
+    testDocuments();
+    testDoubles();
+    testBinaryStrings();
+    return bench::result("test_cbor");
+}
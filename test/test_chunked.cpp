@@ -0,0 +1,171 @@
+/** @file
+@brief The HTTP "chunked" transfer-coding tests.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+ - the "chunked" coding is detected by the last `Transfer-Encoding` token;
+ - the decoder result doesn't depend on how the input is split.
+*/
+#include "bench.hpp"
+
+#include <hive/http.hpp>
+
+using namespace hive;
+
+
+/// @brief The content collector.
+struct Collect
+{
+    String *content; ///< @brief The decoded content.
+
+    /// @brief Append the content data.
+    void operator()(const char *data, size_t len) const
+    {
+        content->append(data, len);
+    }
+};
+
+
+/// @brief The decoding result.
+struct Result
+{
+    String content; ///< @brief The decoded content.
+    size_t processed; ///< @brief The number of input bytes processed.
+    bool done; ///< @brief The "last chunk is received" flag.
+    bool failed; ///< @brief The "bad input" flag.
+
+    /// @brief Check the results are the same.
+    bool operator==(Result const& other) const
+    {
+        return content == other.content && processed == other.processed
+            && done == other.done && failed == other.failed;
+    }
+};
+
+
+/// @brief Decode the input split into parts.
+/**
+@param[in] input The chunked body.
+@param[in] split The split position.
+@return The decoding result.
+*/
+Result decode(String const& input, size_t split)
+{
+    http::ChunkedDecoder dec;
+    Result res;
+    Collect collect = { &res.content };
+
+    res.processed = dec.decode(input.data(), split, collect);
+    if (res.processed == split) // continue with the rest
+        res.processed += dec.decode(input.data() + split, input.size() - split, collect);
+    res.done = dec.isDone();
+    res.failed = dec.isFailed();
+    return res;
+}
+
+
+/// @brief Check the input is decoded the same way at any split position.
+/**
+@param[in] input The chunked body.
+@return The decoding result.
+*/
+Result decodeSplit(String const& input)
+{
+    const Result whole = decode(input, input.size());
+    for (size_t i = 0; i <= input.size(); ++i)
+        CHECK(decode(input, i) == whole);
+
+    // one byte at a time
+    http::ChunkedDecoder dec;
+    Result res;
+    Collect collect = { &res.content };
+    res.processed = 0;
+    for (size_t i = 0; i < input.size() && !dec.isDone() && !dec.isFailed(); ++i)
+        res.processed += dec.decode(input.data() + i, 1, collect);
+    res.done = dec.isDone();
+    res.failed = dec.isFailed();
+    CHECK(res == whole);
+
+    return whole;
+}
+
+
+/// @brief Test the "chunked" coding detection.
+void testIsChunked()
+{
+    struct Case { const char *te; bool chunked; };
+    static const Case CASES[] =
+    {
+        { "chunked", true },
+        { "Chunked", true },
+        { " chunked ", true },
+        { "gzip, chunked", true },
+        { "gzip,chunked", true },
+        { "x-notchunked", false },
+        { "gzip, x-notchunked", false },
+        { "chunked, gzip", false },
+        { "", false }
+    };
+
+    for (size_t i = 0; i < sizeof(CASES)/sizeof(CASES[0]); ++i)
+    {
+        http::Response::SharedPtr res = http::Response::create();
+        res->addHeader(http::header::Transfer_Encoding, CASES[i].te);
+        CHECK(res->isChunked() == CASES[i].chunked);
+    }
+
+    CHECK(!http::Response::create()->isChunked());
+}
+
+
+/// @brief Test the valid bodies.
+void testValid()
+{
+    const String body = "5\r\nhello\r\n7\r\n, world\r\n0\r\n\r\n";
+    Result res = decodeSplit(body + "tail");
+    CHECK(res.done && !res.failed && res.content == "hello, world");
+    CHECK(res.processed == body.size()); // the tail isn't processed
+
+    // extensions and trailers are ignored
+    res = decodeSplit("5;name=value\r\nhello\r\n6 ; x\r\n world\r\n"
+        "0;last\r\nExpires: never\r\nX-Trailer: 1\r\n\r\n");
+    CHECK(res.done && !res.failed && res.content == "hello world");
+
+    // hexadecimal sizes, bare LF
+    res = decodeSplit("A\n0123456789\nb\r\nabcdefghijk\r\n0\n\n");
+    CHECK(res.done && !res.failed && res.content == "0123456789abcdefghijk");
+
+    // incomplete
+    res = decodeSplit("5\r\nhel");
+    CHECK(!res.done && !res.failed && res.content == "hel");
+}
+
+
+/// @brief Test the invalid bodies.
+void testInvalid()
+{
+    // size doesn't fit size_t
+    Result res = decodeSplit("1" + String(sizeof(size_t)*2, '0') + "\r\n");
+    CHECK(res.failed && res.content.empty());
+    res = decodeSplit(String(sizeof(size_t)*2, 'F') + "\r\n");
+    CHECK(!res.failed); // the biggest size is still valid
+
+    // missing CRLF after chunk data
+    res = decodeSplit("5\r\nhelloX\r\n0\r\n\r\n");
+    CHECK(res.failed && res.content == "hello");
+    res = decodeSplit("5\r\nhello0\r\n\r\n");
+    CHECK(res.failed && res.content == "hello");
+
+    // no size
+    CHECK(decodeSplit("\r\nhello\r\n").failed);
+    CHECK(decodeSplit(";ext\r\n").failed);
+    CHECK(decodeSplit("x\r\n").failed);
+}
+
+
+int main()
+{
+    testIsChunked();
+    testValid();
+    testInvalid();
+    return bench::result("test_chunked");
+}
@@ -0,0 +1,216 @@
+/** @file
+@brief The cloud6 serializer tests.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+Checks the command list reader (poll path) converts commands
+exactly as json2cmd() does, both valid and invalid ones.
+Checks the incremental device registration patch
+and the device update.
+*/
+#include <hive/pch.hpp>
+#include "bench.hpp"
+
+#include <DeviceHive/cloud6.hpp>
+
+using namespace hive;
+using namespace cloud6;
+
+typedef ServerAPI::Serializer Serializer;
+
+
+/// @brief Check the commands are the same.
+bool same(Command const& a, Command const& b)
+{
+    return a.id == b.id && a.name == b.name
+        && a.params == b.params
+        && a.lifetime == b.lifetime
+        && a.flags == b.flags
+        && a.status == b.status
+        && a.result == b.result;
+}
+
+
+/// @brief Check DOM and reader conversions agree.
+/**
+@param[in] text The command list text.
+@return The number of converted commands or -1 if both failed.
+*/
+int agree(String const& text)
+{
+    std::vector<Command> dom;
+    bool domFailed = false;
+    try
+    {
+        const json::Value jval = json::str2json(text);
+        for (size_t i = 0; i < jval.size(); ++i)
+            dom.push_back(Serializer::json2cmd(jval[i]));
+    }
+    catch (std::exception const&)
+    {
+        domFailed = true;
+    }
+
+    std::vector<Command> sax;
+    bool saxFailed = false;
+    try
+    {
+        Serializer::CommandListReader reader(sax);
+        json::str2json(text.data(), text.size(), reader);
+    }
+    catch (std::exception const&)
+    {
+        saxFailed = true;
+    }
+
+    if (domFailed || saxFailed)
+        return (domFailed && saxFailed) ? -1 : -2;
+
+    if (dom.size() != sax.size())
+        return -2;
+    for (size_t i = 0; i < dom.size(); ++i)
+        if (!same(dom[i], sax[i]))
+            return -2;
+
+    return int(dom.size());
+}
+
+
+/// @brief Get the reader error message.
+String readerError(String const& text)
+{
+    try
+    {
+        std::vector<Command> commands;
+        Serializer::CommandListReader reader(commands);
+        json::str2json(text.data(), text.size(), reader);
+    }
+    catch (std::exception const& ex)
+    {
+        return ex.what();
+    }
+
+    return String();
+}
+
+
+/// @brief Test valid commands.
+void testValid()
+{
+    CHECK(agree(json::json2str(bench::array(bench::command, 100))) == 100);
+    CHECK(agree("[]") == 0);
+    CHECK(agree("[{\"id\":1,\"command\":\"go\",\"lifetime\":\"15\",\"flags\":2.0}]") == 1);
+    CHECK(agree("[{\"id\":\"42\",\"status\":null,\"result\":7}]") == 1);
+    CHECK(agree("[{\"id\":18446744073709551615,\"unknown\":[1,{\"a\":2}]}]") == 1);
+}
+
+
+/// @brief Test invalid commands.
+void testInvalid()
+{
+    CHECK(agree("[{\"id\":1,\"lifetime\":1e10}]") == -1);
+    CHECK(agree("[{\"id\":1,\"lifetime\":\"forever\"}]") == -1);
+    CHECK(agree("[{\"id\":1,\"flags\":-3000000000}]") == -1);
+    CHECK(agree("[{\"id\":1,\"flags\":9223372036854775808}]") == -1);
+    CHECK(agree("[{\"id\":\"abc\"}]") == -1);
+    CHECK(agree("[{\"id\":[1]}]") == -1);
+    CHECK(agree("[{\"id\":1,\"lifetime\":{}}]") == -1);
+
+    const String error = readerError("[{\"id\":1,\"lifetime\":1e10}]");
+    CHECK(error.find("/lifetime: out of range") != String::npos);
+}
+
+
+/// @brief Test the device registration patch.
+/**
+The nested network, device class and equipment are sent whole.
+*/
+void testDeviceDiff()
+{
+    const json::Value last = json::str2json("{\"name\":\"dev\",\"status\":\"Online\","
+        "\"network\":{\"name\":\"net\",\"key\":\"k\",\"description\":\"d\"},"
+        "\"deviceClass\":{\"name\":\"cls\",\"version\":\"1.0\",\"isPermanent\":false},"
+        "\"equipment\":[{\"name\":\"a\",\"code\":\"a\",\"type\":\"t\"}]}");
+
+    CHECK(Serializer::deviceDiff(last, last).empty());
+
+    json::Value cur = last;
+    cur["status"] = "Offline";
+    CHECK(Serializer::deviceDiff(last, cur) == json::str2json("{\"status\":\"Offline\"}"));
+
+    cur = last;
+    cur["deviceClass"]["version"] = "2.0";
+    json::Value patch = Serializer::deviceDiff(last, cur);
+    CHECK(patch.size() == 1 && patch["deviceClass"] == cur["deviceClass"]);
+
+    cur = last;
+    cur["network"]["description"] = "new";
+    cur["status"] = "Offline";
+    patch = Serializer::deviceDiff(last, cur);
+    CHECK(patch.size() == 2 && patch["network"] == cur["network"]);
+    CHECK(patch["network"]["name"].asString() == "net");
+
+    cur = last;
+    cur["equipment"][0]["type"] = "u";
+    patch = Serializer::deviceDiff(last, cur);
+    CHECK(patch.size() == 1 && patch["equipment"] == cur["equipment"]);
+}
+
+
+/// @brief Get the json2device() error.
+/**
+@param[in] text The device document text.
+@param[in] device The device to update.
+@return The error message or empty string if succeeded.
+*/
+String deviceError(String const& text, Device::SharedPtr device)
+{
+    try
+    {
+        Serializer::json2device(json::str2json(text), device);
+        return String();
+    }
+    catch (std::exception const& ex)
+    {
+        return ex.what();
+    }
+}
+
+
+/// @brief Test the device update.
+void testDevice()
+{
+    Device::SharedPtr device = Device::create("42", "dev", "key",
+        Device::Class::create("cls", "1.0"),
+        Network::create("net", "key", "desc"));
+
+    CHECK(deviceError("{\"id\":\"42\",\"name\":\"new\",\"status\":\"Online\","
+        "\"network\":{\"id\":7,\"name\":\"n\",\"description\":\"d\"},"
+        "\"deviceClass\":{\"id\":3,\"name\":\"c\",\"version\":\"2.0\","
+        "\"isPermanent\":true,\"offlineTimeout\":60}}", device).empty());
+    CHECK(device->name == "new" && device->status == "Online");
+    CHECK(device->network->id == 7 && device->network->name == "n"
+        && device->network->desc == "d");
+    CHECK(device->deviceClass->id == 3 && device->deviceClass->version == "2.0"
+        && device->deviceClass->isPermanent && device->deviceClass->offlineTimeout == 60);
+
+    // numeric identifier is converted to string
+    CHECK(deviceError("{\"id\":42}", device).empty());
+    CHECK(deviceError("{\"id\":43}", device).find("invalid identifier") != String::npos);
+    CHECK(deviceError("{}", device).find("identifier is empty") != String::npos);
+
+    // the nested error context is kept
+    const String netError = deviceError("{\"id\":\"42\",\"network\":{\"id\":\"x\"}}", device);
+    CHECK(netError.find("failed to update Device:\nfailed to update Network:") == 0);
+    const String clsError = deviceError("{\"id\":\"42\",\"deviceClass\":{\"isPermanent\":[]}}", device);
+    CHECK(clsError.find("failed to update Device:\nfailed to update Device Class:") == 0);
+}
+
+
+int main()
+{
+    testValid();
+    testInvalid();
+    testDeviceDiff();
+    testDevice();
+    return bench::result("test_cloud6");
+}
@@ -0,0 +1,111 @@
+/** @file
+@brief The JSON value copy tests.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+Checks no JSON value is deep copied while parsing or building
+a big array: all the values should be moved or swapped.
+*/
+#include <stddef.h>
+
+static size_t g_valueCopies = 0; ///< @brief The number of JSON value copies.
+#define HIVE_JSON_ON_COPY() (++g_valueCopies)
+
+#include "bench.hpp"
+
+#include <sstream>
+
+using namespace hive;
+
+
+/// @brief The copy counter.
+class Copies
+{
+public:
+    Copies()
+        : m_start(g_valueCopies)
+    {}
+
+    size_t count() const
+    {
+        return g_valueCopies - m_start;
+    }
+
+private:
+    size_t m_start;
+};
+
+
+int main()
+{
+    const size_t N = 10000;
+
+    // mixed 10k-element array: objects, arrays, strings and numbers
+    json::Value jarr(json::Value::TYPE_ARRAY);
+    for (size_t i = 0; i < N; ++i)
+    {
+        switch (i%4)
+        {
+            case 0: jarr.append(bench::notification(i)); break;
+            case 1: jarr.append().append(Int64(i)); break;
+            case 2: jarr.append("a long string value, not stored inline"); break;
+            case 3: jarr.append(i*0.5); break;
+        }
+    }
+    const String text = json::json2str(jarr);
+
+    { // the hook works
+        Copies copies;
+        json::Value copy(jarr);
+        CHECK(copies.count() > N);
+    }
+
+    { // in-place parser
+        Copies copies;
+        json::Value jval = json::str2json(text);
+        CHECK(copies.count() == 0);
+        CHECK(jval.size() == N);
+        CHECK(jval == jarr);
+    }
+
+    { // stream parser
+        Copies copies;
+        std::istringstream iss(text);
+        json::Value jval;
+        iss >> jval;
+        CHECK(copies.count() == 0);
+        CHECK(jval == jarr);
+    }
+
+    { // arena document
+        Copies copies;
+        json::Document doc;
+        doc.parse(text.data(), text.size());
+        CHECK(copies.count() == 0);
+        CHECK(doc.getRoot() == jarr);
+    }
+
+    { // incremental parser, split input
+        Copies copies;
+        json::Value jval;
+        json::ValueBuilder builder(jval);
+        json::IncrementalParser<json::ValueBuilder> parser(builder);
+        for (size_t i = 0; i < text.size(); i += 1000)
+            parser.feed(text.data() + i, std::min<size_t>(1000, text.size() - i));
+        parser.finish();
+        CHECK(copies.count() == 0);
+        CHECK(jval == jarr);
+    }
+
+#if defined(HIVE_HAS_RVALUE_REFS)
+    { // building by move
+        Copies copies;
+        json::Value jval;
+        jval.reserve(N);
+        for (size_t i = 0; i < N; ++i)
+            jval.append(bench::command(i));
+        CHECK(copies.count() == 0);
+    }
+#endif // defined(HIVE_HAS_RVALUE_REFS)
+
+    return bench::result("test_copy");
+}
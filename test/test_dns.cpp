@@ -0,0 +1,141 @@
+/** @file
+@brief The HTTP client DNS cache tests.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+ - the concurrent requests to the same host share one resolve;
+ - the resolve error is cached for negative time-to-live;
+ - the cached endpoints are dropped if connection fails.
+*/
+#include "bench.hpp"
+#include "loopback.hpp"
+
+using namespace hive;
+
+typedef boost::system::error_code ErrorCode;
+
+
+/// @brief The response callback.
+void onResponse(ErrorCode err, http::Request::SharedPtr,
+    http::Response::SharedPtr response, ErrorCode *result, int *finished)
+{
+    *result = err;
+    if (!err && (!response || 200 != response->getStatusCode()))
+        *result = boost::asio::error::invalid_argument;
+    *finished += 1;
+}
+
+
+/// @brief Send the request and wait for response.
+ErrorCode sendAndWait(boost::asio::io_service &ios,
+    http::Client::SharedPtr client, http::Url const& url)
+{
+    ErrorCode result;
+    int finished = 0;
+    ios.reset(); // might be stopped if there was no server
+    client->send(http::Request::GET(url),
+        boost::bind(onResponse, _1, _2, _3, &result, &finished), 5000);
+    while (!finished && ios.run_one())
+        ;
+    return result;
+}
+
+
+/// @brief Get the URL of the closed port.
+http::Url closedUrl(boost::asio::io_service &ios)
+{
+    boost::asio::ip::tcp::acceptor acceptor(ios,
+        boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    OStringStream oss;
+    oss << "http://127.0.0.1:" << acceptor.local_endpoint().port() << "/";
+    return http::Url(oss.str());
+}
+
+
+/// @brief Test the concurrent requests share one resolve.
+void testConcurrent()
+{
+    const int N = 8;
+
+    boost::asio::io_service ios;
+    bench::LoopbackServer server(ios);
+    http::Client::SharedPtr client = http::Client::create(ios);
+    client->setDnsCache(60000);
+
+    ErrorCode results[N];
+    int finished = 0;
+    for (int i = 0; i < N; ++i)
+    {
+        client->send(http::Request::GET(server.getUrl("/")),
+            boost::bind(onResponse, _1, _2, _3, &results[i], &finished), 5000);
+    }
+    while (finished < N && ios.run_one())
+        ;
+
+    for (int i = 0; i < N; ++i)
+        CHECK(!results[i]);
+    CHECK(client->getDnsResolves() == 1);
+
+    // sequential requests use the cache
+    CHECK(!sendAndWait(ios, client, server.getUrl("/")));
+    CHECK(!sendAndWait(ios, client, server.getUrl("/")));
+    CHECK(client->getDnsResolves() == 1);
+
+    // no cache
+    client->setDnsCache(0);
+    CHECK(!sendAndWait(ios, client, server.getUrl("/")));
+    CHECK(!sendAndWait(ios, client, server.getUrl("/")));
+    CHECK(client->getDnsResolves() == 3);
+}
+
+
+/// @brief Test the resolve error is cached.
+/**
+The unknown service name fails locally, no DNS server is required.
+*/
+void testNegative()
+{
+    const http::Url url("no-such-service://127.0.0.1/");
+
+    boost::asio::io_service ios;
+    http::Client::SharedPtr client = http::Client::create(ios);
+    client->setDnsCache(60000, 200);
+
+    const ErrorCode err = sendAndWait(ios, client, url);
+    CHECK(!!err);
+    CHECK(client->getDnsResolves() == 1);
+
+    // the same error within negative TTL
+    CHECK(sendAndWait(ios, client, url) == err);
+    CHECK(client->getDnsResolves() == 1);
+
+    // resolved again after negative TTL
+    boost::asio::deadline_timer(ios, boost::posix_time::milliseconds(300)).wait();
+    CHECK(sendAndWait(ios, client, url) == err);
+    CHECK(client->getDnsResolves() == 2);
+}
+
+
+/// @brief Test the cached endpoints are dropped after connection error.
+void testConnectError()
+{
+    boost::asio::io_service ios;
+    const http::Url url = closedUrl(ios);
+    http::Client::SharedPtr client = http::Client::create(ios);
+    client->setDnsCache(60000);
+
+    CHECK(!!sendAndWait(ios, client, url));
+    CHECK(client->getDnsResolves() == 1);
+    CHECK(!!sendAndWait(ios, client, url));
+    CHECK(client->getDnsResolves() == 2);
+}
+
+
+int main()
+{
+    log::Logger("/hive/http").setLevel(log::LEVEL_OFF); // expected errors
+
+    testConcurrent();
+    testNegative();
+    testConnectError();
+    return bench::result("test_dns");
+}
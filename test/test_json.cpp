@@ -0,0 +1,532 @@
+/** @file
+@brief The JSON module tests.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+*/
+#include "bench.hpp"
+
+#include <sstream>
+#include <float.h>
+#include <locale.h>
+
+using namespace hive;
+
+
+/// @brief Parse JSON from the stream.
+json::Value parseStream(String const& text)
+{
+    std::istringstream iss(text);
+    json::Value jval;
+    iss >> jval;
+    return jval;
+}
+
+
+/// @brief Test the big unsigned integers.
+/**
+The integers greater than Int64 maximum are kept unsigned.
+*/
+void testUnsigned()
+{
+    const UInt64 UMAX = std::numeric_limits<UInt64>::max();
+
+    json::Value jmax = json::str2json("18446744073709551615");
+    CHECK(jmax.isInteger() && jmax.isUInteger());
+    CHECK(jmax.asUInt() == UMAX);
+    CHECK(json::json2str(jmax) == "18446744073709551615");
+    CHECK(jmax.asString() == "18446744073709551615");
+    CHECK(jmax.asDouble() == double(UMAX));
+    CHECK_THROW(jmax.asInt(), json::error::CastError);
+
+    json::Value jarr = json::str2json("[9223372036854775808]");
+    CHECK(json::json2str(jarr) == "[9223372036854775808]");
+    CHECK(jarr[0] != json::Value(std::numeric_limits<Int64>::min()));
+    CHECK(jarr[0] == json::Value(UInt64(9223372036854775808ULL)));
+
+    // Int64 maximum is still signed
+    json::Value jimax = json::str2json("9223372036854775807");
+    CHECK(!jimax.isUInteger());
+    CHECK(jimax.asInt() == std::numeric_limits<Int64>::max());
+
+    // the stream parser is the same
+    CHECK(parseStream("18446744073709551615") == jmax);
+
+    // too big integers are floating-point
+    CHECK(json::str2json("18446744073709551616").isDouble());
+    CHECK(json::str2json("-9223372036854775809").isDouble());
+
+    // the SAX handler gets onUInteger() event
+    struct Handler: public json::Handler
+    {
+        Handler(): value(0) {}
+        void onUInteger(UInt64 val) { value = val; }
+        UInt64 value;
+    } h;
+    const String text = "18446744073709551615";
+    json::str2json(text.data(), text.size(), h);
+    CHECK(h.value == UMAX);
+}
+
+
+/// @brief Test the long numbers.
+/**
+The numbers longer than the stream parser's buffer are not truncated.
+*/
+void testLongNumbers()
+{
+    const String num = "0.1" + String(70, '0') + "1";
+    const String text = "[" + num + ", -" + num + "e+0]";
+
+    json::Value jval = parseStream(text);
+    CHECK(jval.size() == 2);
+    CHECK(jval[0].isDouble() && jval[0].asDouble() == 0.1);
+    CHECK(jval[1].isDouble() && jval[1].asDouble() == -0.1);
+    CHECK(jval == json::str2json(text));
+
+    const String digits(100, '9');
+    CHECK(parseStream(digits).isDouble());
+    CHECK_THROW(parseStream("1" + String(80, '0') + "."), json::error::SyntaxError);
+}
+
+
+/// @brief Check the double value is formatted and parsed back exactly.
+bool formatRoundTrip(double val)
+{
+    char buf[json::Formatter::MAX_NUMBER_LENGTH];
+    const size_t len = json::Formatter::formatDouble(buf, val);
+    const json::Value jval = json::str2json(String(buf, len));
+    if (!jval.isDouble())
+        return false;
+
+    const double res = jval.asDouble();
+    return 0 == memcmp(&res, &val, sizeof(val)); // -0.0 too
+}
+
+
+/// @brief Test the floating-point formatting.
+/**
+The formatted value is parsed back to exactly the same bits,
+using the shortest notation for short fractions.
+*/
+void testDoubles()
+{
+    const double VALUES[] =
+    {
+        0.1, 1.0/3, 5e-324, DBL_MIN, DBL_MAX, DBL_EPSILON, -0.0, 0.0,
+        1e21, 1e22, 1e15, 1e16, 1e-7, 123.456, 9007199254740993.0
+    };
+
+    for (size_t i = 0; i < sizeof(VALUES)/sizeof(VALUES[0]); ++i)
+    {
+        CHECK(formatRoundTrip(VALUES[i]));
+        CHECK(formatRoundTrip(-VALUES[i]));
+    }
+
+    // random bit patterns
+    UInt64 x = 88172645463325252ULL;
+    for (int i = 0; i < 100000; ++i)
+    {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17; // xorshift
+        double val = 0.0;
+        memcpy(&val, &x, sizeof(val));
+        if (val == val && val - val == 0.0) // finite
+            CHECK(formatRoundTrip(val));
+    }
+
+    CHECK(json::json2str(json::Value(0.1)) == "0.1");
+    CHECK(json::json2str(json::Value(-0.0)) == "-0.0");
+    CHECK(json::json2str(json::Value(1.0/3)) == "0.3333333333333333");
+    CHECK(json::json2str(json::Value(DBL_MAX)) == "1.7976931348623157e+308");
+    CHECK(json::json2str(json::Value(1e21)) == "1e+21");
+}
+
+
+/// @brief Test the binary (not UTF-8) strings.
+/**
+The invalid UTF-8 bytes are written as Latin-1 escapes,
+so they are read back as UTF-8 encoded U+0080..U+00FF.
+The conversion is not lossless.
+*/
+void testBinaryStrings()
+{
+    const String bin("\xFF\x80 ok", 5);
+    const String text = json::json2str(json::Value(bin));
+    CHECK(text == "\"\\u00ff\\u0080 ok\"");
+
+    const String back = json::str2json(text).asString();
+    CHECK(back == String("\xC3\xBF\xC2\x80 ok", 7));
+    CHECK(back != bin);
+
+    // valid UTF-8 is written as is and round-trips
+    const String utf8 = "\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82";
+    CHECK(json::str2json(json::json2str(json::Value(utf8))).asString() == utf8);
+}
+
+
+/// @brief Test the numbers under the comma decimal point locale.
+/**
+The JSON numbers always use the dot, whatever the C locale is.
+The test is skipped if no such locale is installed.
+*/
+void testLocale()
+{
+    const char* const names[] = { "de_DE.UTF-8", "de_DE.utf8", "de_DE",
+        "fr_FR.UTF-8", "fr_FR.utf8", "ru_RU.UTF-8", "ru_RU.utf8", 0 };
+
+    const char *name = 0;
+    for (size_t i = 0; names[i] && !name; ++i)
+        if (setlocale(LC_NUMERIC, names[i]))
+            name = names[i];
+    if (!name)
+    {
+        std::cout << "test_json: no comma decimal point locale, skipped\n";
+        return;
+    }
+
+    const String text = "[1.5,-25.0,1e+300,0.1]";
+    const json::Value jval = json::str2json(text);
+    CHECK(jval.size() == 4);
+    CHECK(jval[0].asDouble() == 1.5);
+    CHECK(jval[1].asDouble() == -25.0);
+    CHECK(jval[2].asDouble() == 1e300);
+    CHECK(jval[3].asDouble() == 0.1);
+    CHECK(parseStream(text) == jval);
+    CHECK(json::json2str(jval) == text);
+    CHECK_THROW(json::str2json("1,5"), json::error::SyntaxError);
+
+    setlocale(LC_NUMERIC, "C");
+}
+
+
+/// @brief Test the unicode escapes.
+/**
+The truncated escapes at the end of stream are reported as errors.
+*/
+void testUnicodeEscapes()
+{
+    const String text = "[\"\\u0041\", \"\\u00e9\", \"\\uD83D\\uDE00\"]";
+    const json::Value jval = parseStream(text);
+    CHECK(jval == json::str2json(text));
+    CHECK(jval[0].asString() == "A");
+    CHECK(jval[2].asString() == "\xF0\x9F\x98\x80");
+
+    CHECK_THROW(parseStream("\"\\u"), json::error::SyntaxError);
+    CHECK_THROW(parseStream("\"\\u0"), json::error::SyntaxError);
+    CHECK_THROW(parseStream("\"\\uD8"), json::error::SyntaxError);
+    CHECK_THROW(parseStream("\"\\uD83D\\u"), json::error::SyntaxError);
+}
+
+
+/// @brief Test the element and member access overloads.
+/**
+Any integer type is accepted as an element index,
+string literals, pointers and strings as a member name.
+*/
+void testIndexing()
+{
+    json::Value jarr = json::str2json("[10, 20, 30]");
+    json::Value const& carr = jarr;
+
+    const unsigned u = 1;
+    const UInt32 u32 = 2;
+    const long l = 0;
+    const int i = 1;
+    CHECK(jarr[u].asInt() == 20 && carr[u].asInt() == 20);
+    CHECK(jarr[u32].asInt() == 30 && carr[u32].asInt() == 30);
+    CHECK(jarr[l].asInt() == 10 && carr[l].asInt() == 10);
+    CHECK(jarr[i].asInt() == 20 && carr[i].asInt() == 20);
+    CHECK(jarr[0].asInt() == 10 && carr[0].asInt() == 10);
+    CHECK(jarr[size_t(2)].asInt() == 30);
+
+    json::Value jobj;
+    json::Value const& cobj = jobj;
+    const char *ptr = "ptr";
+    char buf[16] = "buf";
+    jobj["literal"] = 1;
+    jobj[ptr] = 2;
+    jobj[buf] = 3;
+    jobj[String("string")] = 4;
+    CHECK(cobj["literal"].asInt() == 1);
+    CHECK(cobj[ptr].asInt() == 2);
+    CHECK(cobj[buf].asInt() == 3);
+    CHECK(cobj["string"].asInt() == 4);
+    CHECK(cobj["missing"].isNull());
+
+    const String text = json::json2str(jarr);
+    json::LazyValue lazy(text.data(), text.data() + text.size());
+    CHECK(lazy[u].asInt() == 20 && lazy[0].asInt() == 10 && lazy[l].asInt() == 10);
+}
+
+
+/// @brief Parse JSON with incremental parser.
+/**
+@param[in] text The JSON text.
+@param[in] chunk The chunk size in bytes.
+@return The parsed JSON value.
+*/
+json::Value parseChunks(String const& text, size_t chunk)
+{
+    json::Value jval;
+    json::ValueBuilder builder(jval);
+    json::IncrementalParser<json::ValueBuilder> parser(builder);
+    for (size_t i = 0; i < text.size(); i += chunk)
+        parser.feed(text.data() + i, std::min(chunk, text.size() - i));
+    parser.finish();
+    return jval;
+}
+
+
+/// @brief Check incremental parser gives the same result as str2json().
+/**
+@param[in] text The JSON text.
+@param[in] fails The "invalid document" flag.
+@return `true` if parsed to the same value (or both failed if @a fails).
+*/
+bool sameIncremental(String const& text, bool fails = false)
+{
+    json::Value expected;
+    try
+    {
+        expected = json::str2json(text);
+        if (fails)
+            return false;
+    }
+    catch (json::error::SyntaxError const&)
+    {
+        if (!fails)
+            return false;
+    }
+
+    static const size_t CHUNKS[] = { 1, 2, 3, 7, 16, 1000 };
+    for (size_t i = 0; i < sizeof(CHUNKS)/sizeof(CHUNKS[0]); ++i)
+    {
+        try
+        {
+            const json::Value jval = parseChunks(text, CHUNKS[i]);
+            if (fails || jval != expected
+                || json::json2str(jval) != json::json2str(expected))
+                    return false;
+        }
+        catch (json::error::SyntaxError const&)
+        {
+            if (!fails)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+/// @brief Test the incremental parser.
+/**
+The documents are fed one byte at a time and in bigger chunks,
+so each token is split at every position.
+*/
+void testIncremental()
+{
+    CHECK(sameIncremental(json::json2str(bench::device(10))));
+    CHECK(sameIncremental(json::json2str(bench::array(bench::command, 20))));
+    CHECK(sameIncremental(json::json2str(bench::array(bench::notification, 20, 10))));
+    CHECK(sameIncremental("{\"a\" : [1, -2, 3.5, -4e-3, 5E+2, 18446744073709551615,"
+        " -9223372036854775808, 0.1000000000000000000000001],\n"
+        " \"b\": {\"\": \"\\\" \\\\ \\/ \\b \\f \\n \\r \\t \\u0041 \\uD83D\\uDE00\"},"
+        " \"c\": [true, false, null, [], {}, [[]]],"
+        " \"\xC3\xA9\": \"\xF0\x9F\x98\x80\" } "));
+    CHECK(sameIncremental("// comment\n/* block */ [1, /* inside */ 2] // end"));
+
+    // top-level scalars
+    CHECK(sameIncremental("12345"));
+    CHECK(sameIncremental("-0.5e10"));
+    CHECK(sameIncremental("\"text\""));
+    CHECK(sameIncremental(" true "));
+    CHECK(sameIncremental("null"));
+
+    // both fail
+    CHECK(sameIncremental("[1, 2", true));
+    CHECK(sameIncremental("{\"a\" 1}", true));
+    CHECK(sameIncremental("[tru]", true));
+    CHECK(sameIncremental("\"\\x\"", true));
+    CHECK(sameIncremental("\"\xFF\"", true));
+    CHECK(sameIncremental("[1] 2", true));
+}
+
+
+/// @brief Check lazy value gives the same values as DOM.
+/**
+The member and element access is checked before the whole
+value is decoded, so the lazy index is used.
+
+@param[in] lazy The lazy value.
+@param[in] jval The expected value.
+@return `true` if the same.
+*/
+bool sameLazy(json::LazyValue const& lazy, json::Value const& jval)
+{
+    if (lazy.getType() != jval.getType())
+        return false;
+
+    if (jval.isArray())
+    {
+        if (lazy.size() != jval.size() || !lazy[jval.size()].isNull())
+            return false;
+        for (size_t i = jval.size(); 0 < i; --i) // backward
+            if (!sameLazy(lazy[i-1], jval[i-1]))
+                return false;
+    }
+    else if (jval.isObject())
+    {
+        json::Value::MemberIterator i = jval.membersBegin();
+        const json::Value::MemberIterator e = jval.membersEnd();
+        for (; i != e; ++i)
+        {
+            const String name(i->first.data(), i->first.size());
+            if (!sameLazy(lazy[name], i->second))
+                return false;
+        }
+
+        if (!lazy["no such member"].isNull())
+            return false;
+    }
+    else if (lazy.size() != 0 || !lazy[size_t(0)].isNull() || !lazy["a"].isNull())
+        return false;
+
+    return lazy.get() == jval
+        && json::json2str(lazy) == json::json2str(jval);
+}
+
+
+/// @brief Check lazy value of the JSON text is the same as DOM.
+bool sameLazy(String const& text)
+{
+    json::LazyValue lazy(text.data(), text.data() + text.size());
+    return sameLazy(lazy, json::str2json(text));
+}
+
+
+/// @brief Test the lazy value access.
+void testLazy()
+{
+    CHECK(sameLazy(json::json2str(bench::device(10))));
+    CHECK(sameLazy(json::json2str(bench::array(bench::command, 20))));
+    CHECK(sameLazy(json::json2str(bench::array(bench::notification, 20, 10))));
+    CHECK(sameLazy(" { \"a\" : [ 1 , -2.5e3 , \"]}\" , { } , [ ] , null ] ,\n"
+        "\"b\":{\"c\":{\"d\":[true,false]}}, \"\\u0041\\\"\": \"x\\\"y\", \"\": 0 } "));
+    CHECK(sameLazy("[[[[1]]], [[2, [3]]], \"[\", \"{\", \"\\\\\"]"));
+    CHECK(sameLazy("42"));
+    CHECK(sameLazy("\"text\""));
+    CHECK(sameLazy("[]"));
+
+    // the last member wins, as in Value
+    const String dup = "{\"a\": 1, \"b\": 2, \"a\": 3}";
+    json::LazyValue lazy(dup.data(), dup.data() + dup.size());
+    CHECK(lazy["a"].asInt() == json::str2json(dup)["a"].asInt());
+    CHECK(lazy.get() == json::str2json(dup));
+}
+
+
+/// @brief Test the key table limits.
+void testKeyTable()
+{
+    json::KeyTable table(3, 8);
+    CHECK(table.tryIntern("id", 2) != 0);
+    CHECK(table.tryIntern("too long name", 13) == 0);
+    CHECK(table.tryIntern("name", 4) != 0);
+    CHECK(table.tryIntern("status", 6) != 0);
+    CHECK(table.tryIntern("result", 6) == 0); // table is full
+    CHECK(table.tryIntern("id", 2) == table.find("id", 2)); // still found
+    CHECK(table.size() == 3);
+
+    // explicit interning ignores the limits
+    table.intern("result", 6);
+    CHECK(table.size() == 4);
+
+#if defined(HIVE_JSON_INTERNED_KEYS)
+    // data-driven member names don't grow the global table forever
+    json::KeyTable &global = json::KeyTable::global();
+    for (int i = 0; i < 2*json::KeyTable::DEFAULT_MAX_KEYS; ++i)
+    {
+        OStringStream oss;
+        oss << "{\"name" << i << "\": " << i << "}";
+        json::Value jval = json::str2json(oss.str());
+        CHECK(jval.size() == 1);
+    }
+    CHECK(global.size() <= json::KeyTable::DEFAULT_MAX_KEYS);
+#endif // HIVE_JSON_INTERNED_KEYS
+}
+
+
+/// @brief Test the string and whitespace scanning at block boundaries.
+/**
+The special character is placed at every position of 0..40 bytes long
+string, so it's checked in the SSE2 (16 bytes) or SWAR (8 bytes) block
+and in the byte-by-byte tail. The test_json_nosimd build uses the
+portable implementation, both builds should give the same results.
+*/
+void testScanBoundaries()
+{
+    struct Special { const char *text; const char *value; };
+    static const Special SPECIAL[] =
+    {
+        { "\\\"", "\"" },
+        { "\\\\", "\\" },
+        { "\\n", "\n" },
+        { "\xC3\xA9", "\xC3\xA9" },
+        { "\xF0\x9F\x98\x80", "\xF0\x9F\x98\x80" },
+        { "\x01", "\x01" },
+        { "\x1F", "\x1F" },
+        { "\t", "\t" },
+        { "\x7F", "\x7F" },
+        { " ", " " }
+    };
+    const size_t S = sizeof(SPECIAL)/sizeof(SPECIAL[0]);
+
+    for (size_t len = 0; len <= 40; ++len)
+        for (size_t pos = 0; pos <= len; ++pos)
+    {
+        const String head(pos, 'a');
+        const String tail(len - pos, 'z');
+
+        for (size_t i = 0; i < S; ++i)
+        {
+            const String text = "\"" + head + SPECIAL[i].text + tail + "\"";
+            const json::Value jval = json::str2json(text);
+            CHECK(jval.asString() == head + SPECIAL[i].value + tail);
+        }
+
+        CHECK_THROW(json::str2json("\"" + head + "\xFF" + tail + "\""), json::error::SyntaxError);
+        CHECK_THROW(json::str2json("\"" + head + "\xC3(" + tail + "\""), json::error::SyntaxError);
+        CHECK_THROW(json::str2json("\"" + head + tail), json::error::SyntaxError); // no quote
+    }
+
+    // all the whitespaces, the 0x08 and 0x0E are not
+    const String WS = " \t\n\r\f\v";
+    for (size_t len = 0; len <= 40; ++len)
+    {
+        String ws;
+        for (size_t i = 0; i < len; ++i)
+            ws += WS[i % WS.size()];
+
+        const json::Value jval = json::str2json("[" + ws + "1" + ws + "," + ws + "\"x\"" + ws + "]" + ws);
+        CHECK(jval.size() == 2 && jval[0].asInt() == 1 && jval[1].asString() == "x");
+
+        CHECK_THROW(json::str2json("[" + ws + "\x08" + "1]"), json::error::SyntaxError);
+        CHECK_THROW(json::str2json("[" + ws + "\x0E" + "1]"), json::error::SyntaxError);
+    }
+}
+
+
+int main()
+{
+    testUnsigned();
+    testLongNumbers();
+    testDoubles();
+    testUnicodeEscapes();
+    testBinaryStrings();
+    testLocale();
+    testIndexing();
+    testKeyTable();
+    testIncremental();
+    testLazy();
+    testScanBoundaries();
+    return bench::result("test_json");
+}
@@ -0,0 +1,110 @@
+/** @file
+@brief The JSON patch tests.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+Checks the diff() -> apply() and mergeDiff() -> merge() identities.
+*/
+#include "bench.hpp"
+
+using namespace hive;
+
+
+/// @brief Check the JSON Patch gives the target value.
+bool patchIdentity(String const& from, String const& to)
+{
+    const json::Value jfrom = json::str2json(from);
+    const json::Value jto = json::str2json(to);
+
+    json::Value res = jfrom;
+    json::Patch::apply(res, json::Patch::diff(jfrom, jto));
+    return res == jto;
+}
+
+
+/// @brief Check the JSON Merge Patch gives the target value.
+bool mergeIdentity(String const& from, String const& to)
+{
+    const json::Value jfrom = json::str2json(from);
+    const json::Value jto = json::str2json(to);
+
+    json::Value res = jfrom;
+    json::Patch::merge(res, json::Patch::mergeDiff(jfrom, jto));
+    return res == jto;
+}
+
+
+/// @brief Test the JSON Patch.
+void testDiff()
+{
+    // equal values give empty patch
+    const json::Value dev = bench::device(10);
+    CHECK(json::Patch::diff(dev, dev).empty());
+
+    CHECK(patchIdentity("{\"a\":1}", "{\"a\":2}"));
+    CHECK(patchIdentity("{\"a\":1,\"b\":2}", "{\"b\":3,\"c\":[1]}"));
+    CHECK(patchIdentity("1", "{\"a\":1}"));
+    CHECK(patchIdentity("{\"a\":{\"b\":{\"c\":1}}}", "{\"a\":{\"b\":{\"c\":2,\"d\":null}}}"));
+
+    // escaped member names
+    CHECK(patchIdentity("{\"a/b\":1,\"m~n\":2}", "{\"a/b\":3,\"m~n\":4,\"~/\":5}"));
+    const json::Value esc = json::Patch::diff(json::str2json("{\"a/b\":1}"),
+        json::str2json("{\"a/b\":2}"));
+    CHECK(esc.size() == 1 && esc[0]["path"].asString() == "/a~1b");
+    const json::Value esc2 = json::Patch::diff(json::str2json("{\"m~n\":1}"),
+        json::str2json("{}"));
+    CHECK(esc2.size() == 1 && esc2[0]["path"].asString() == "/m~0n"
+        && esc2[0]["op"].asString() == "remove");
+
+    // array insert and remove
+    CHECK(patchIdentity("[1,2,3,4,5]", "[1,2,9,3,4,5]"));
+    CHECK(patchIdentity("[1,2,3,4,5]", "[1,3,4,5]"));
+    CHECK(patchIdentity("[1,2,3,4,5]", "[]"));
+    CHECK(patchIdentity("[]", "[1,2,3]"));
+    CHECK(patchIdentity("[1,2,3]", "[4,5,6,7,8]"));
+    CHECK(patchIdentity("[[1,2],{\"a\":[3]}]", "[[1],{\"a\":[3,4]},5]"));
+
+    // one element changed in the long array gives one operation
+    json::Value dev2 = dev;
+    dev2["equipment"][5]["name"] = "changed";
+    const json::Value patch = json::Patch::diff(dev, dev2);
+    CHECK(patch.size() == 1 && patch[0]["path"].asString() == "/equipment/5/name");
+    json::Value res = dev;
+    json::Patch::apply(res, patch);
+    CHECK(res == dev2);
+
+    // failed operation doesn't change the target
+    json::Value target = json::str2json("{\"a\":1}");
+    CHECK_THROW(json::Patch::apply(target, json::str2json(
+        "[{\"op\":\"remove\",\"path\":\"/a\"},{\"op\":\"remove\",\"path\":\"/x\"}]")),
+        json::error::SyntaxError);
+    CHECK(target == json::str2json("{\"a\":1}"));
+}
+
+
+/// @brief Test the JSON Merge Patch.
+void testMergeDiff()
+{
+    CHECK(json::Patch::mergeDiff(bench::device(4), bench::device(4)).empty());
+
+    CHECK(mergeIdentity("{\"a\":1}", "{\"a\":2}"));
+    CHECK(mergeIdentity("{\"a\":1,\"b\":2}", "{\"b\":3,\"c\":[1]}"));
+    CHECK(mergeIdentity("{\"a\":{\"b\":1,\"c\":2}}", "{\"a\":{\"c\":3}}"));
+    CHECK(mergeIdentity("{\"a/b\":1,\"m~n\":2}", "{\"a/b\":3,\"~/\":5}"));
+    CHECK(mergeIdentity("{\"a\":[1,2,3]}", "{\"a\":[1,3]}"));
+    CHECK(mergeIdentity("[1,2]", "{\"a\":1}"));
+    CHECK(mergeIdentity("{\"a\":1}", "[1,2]"));
+
+    // changed members only
+    const json::Value patch = json::Patch::mergeDiff(
+        json::str2json("{\"a\":1,\"b\":{\"c\":1,\"d\":2},\"e\":3}"),
+        json::str2json("{\"a\":1,\"b\":{\"c\":1,\"d\":5}}"));
+    CHECK(patch == json::str2json("{\"b\":{\"d\":5},\"e\":null}"));
+}
+
+
+int main()
+{
+    testDiff();
+    testMergeDiff();
+    return bench::result("test_patch");
+}
@@ -0,0 +1,129 @@
+/** @file
+@brief The HTTP pipelining and retry tests.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+ - the queued (not yet written) pipelined request that times out
+   should not break the pipeline and abort the requests in flight;
+ - the request retried after the failed write on kept-alive connection
+   should be sent once, without the unsent data of the failed attempt;
+ - the requests are not pipelined to the server which closes connections.
+*/
+#include "bench.hpp"
+#include "loopback.hpp"
+
+using namespace hive;
+
+typedef boost::system::error_code ErrorCode;
+
+
+/// @brief The response callback.
+void onResponse(ErrorCode err, http::Request::SharedPtr,
+    http::Response::SharedPtr response, ErrorCode *result, int *finished)
+{
+    *result = err;
+    if (!err && (!response || 200 != response->getStatusCode()))
+        *result = boost::asio::error::invalid_argument;
+    *finished += 1;
+}
+
+
+/// @brief Test the queued request timeout.
+void testQueuedTimeout()
+{
+    boost::asio::io_service ios;
+    bench::LoopbackServer server(ios, 200);
+
+    http::Client::SharedPtr client = http::Client::create(ios);
+    client->setKeepAlive(1);
+    client->setPipelining(1);
+
+    ErrorCode a, b, c;
+    int finished = 0;
+    client->sendPipelined(http::Request::POST(server.getUrl("/a"), "application/json", "{}"),
+        boost::bind(onResponse, _1, _2, _3, &a, &finished), 5000);
+    client->sendPipelined(http::Request::POST(server.getUrl("/b"), "application/json", "{}"),
+        boost::bind(onResponse, _1, _2, _3, &b, &finished), 50);
+    client->sendPipelined(http::Request::POST(server.getUrl("/c"), "application/json", "{}"),
+        boost::bind(onResponse, _1, _2, _3, &c, &finished), 5000);
+
+    while (finished < 3 && ios.run_one())
+        ;
+
+    CHECK(finished == 3);
+    CHECK(!a); // in flight, not aborted
+    CHECK(b == boost::asio::error::timed_out);
+    CHECK(!c); // queued after the timed out one
+    CHECK(server.getConnections() == 1);
+    CHECK(server.getRequests() == 2);
+}
+
+
+/// @brief Test the retry after the failed write.
+void testRetryAfterWriteError()
+{
+    boost::asio::io_service ios;
+    bench::LoopbackServer server(ios);
+    server.setResetOn(2); // the second request on each connection
+
+    http::Client::SharedPtr client = http::Client::create(ios);
+    client->setKeepAlive(1);
+
+    ErrorCode a, b;
+    int finished = 0;
+    client->send(http::Request::GET(server.getUrl("/a")),
+        boost::bind(onResponse, _1, _2, _3, &a, &finished), 5000);
+    while (finished < 1 && ios.run_one())
+        ;
+
+    // too big to be buffered by the socket, so the write fails
+    const String content(32*1024*1024, 'x');
+    client->send(http::Request::PUT(server.getUrl("/b"), "text/plain", content),
+        boost::bind(onResponse, _1, _2, _3, &b, &finished), 10000);
+    while (finished < 2 && ios.run_one())
+        ;
+
+    CHECK(!a);
+    CHECK(!b);
+    CHECK(server.getConnections() == 2);
+    CHECK(server.getRequests() == 2);
+    CHECK(server.getBadRequests() == 0);
+}
+
+
+/// @brief Test the server which closes connections.
+void testNoKeepAlive()
+{
+    boost::asio::io_service ios;
+    bench::LoopbackServer server(ios);
+    server.setKeepAlive(false);
+
+    http::Client::SharedPtr client = http::Client::create(ios);
+    client->setPipelining(4);
+
+    const int N = 4;
+    ErrorCode errs[N];
+    int finished = 0;
+    for (int i = 0; i < N; ++i)
+    {
+        http::Request::SharedPtr req = http::Request::POST(server.getUrl("/"), "application/json", "{}");
+        req->setVersion(1, 0); // as cloud6 does
+        client->sendPipelined(req, boost::bind(onResponse, _1, _2, _3, &errs[i], &finished), 5000);
+    }
+    while (finished < N && ios.run_one())
+        ;
+
+    CHECK(finished == N);
+    for (int i = 0; i < N; ++i)
+        CHECK(!errs[i]);
+    CHECK(server.getConnections() == size_t(N));
+    CHECK(server.getRequests() == size_t(N));
+}
+
+
+int main()
+{
+    testQueuedTimeout();
+    testRetryAfterWriteError();
+    testNoKeepAlive();
+    return bench::result("test_pipeline");
+}
@@ -0,0 +1,142 @@
+/** @file
+@brief The HTTP keep-alive connection pool tests.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+ - the request on broken kept-alive connection is sent again
+   only if it's idempotent (the server might have processed it);
+ - the idle connections closed by the server are not reused;
+ - the pool hits and misses match the connections used.
+*/
+#include "bench.hpp"
+#include "loopback.hpp"
+
+using namespace hive;
+
+typedef boost::system::error_code ErrorCode;
+
+
+/// @brief The response callback.
+void onResponse(ErrorCode err, http::Request::SharedPtr,
+    http::Response::SharedPtr response, ErrorCode *result, int *finished)
+{
+    *result = err;
+    if (!err && (!response || 200 != response->getStatusCode()))
+        *result = boost::asio::error::invalid_argument;
+    *finished += 1;
+}
+
+
+/// @brief Send the request and wait for response.
+ErrorCode sendAndWait(boost::asio::io_service &ios,
+    http::Client::SharedPtr client, http::Request::SharedPtr request)
+{
+    ErrorCode result;
+    int finished = 0;
+    client->send(request, boost::bind(onResponse, _1, _2, _3, &result, &finished), 5000);
+    while (!finished && ios.run_one())
+        ;
+    return result;
+}
+
+
+/// @brief Test the retry on broken connection.
+/**
+@param[in] idempotent Send PUT or POST request.
+*/
+void testRetry(bool idempotent)
+{
+    boost::asio::io_service ios;
+    bench::LoopbackServer server(ios);
+    server.setResetOn(2); // the second request on each connection
+
+    http::Client::SharedPtr client = http::Client::create(ios);
+    client->setKeepAlive(1);
+
+    CHECK(!sendAndWait(ios, client, http::Request::GET(server.getUrl("/a"))));
+
+    const http::Url url = server.getUrl("/b");
+    const ErrorCode err = sendAndWait(ios, client, idempotent
+        ? http::Request::PUT(url, "application/json", "{}")
+        : http::Request::POST(url, "application/json", "{}"));
+
+    if (idempotent) // sent again
+    {
+        CHECK(!err);
+        CHECK(server.getConnections() == 2);
+        CHECK(server.getRequests() == 2);
+    }
+    else // might be processed, not sent again
+    {
+        CHECK(!!err);
+        CHECK(server.getConnections() == 1);
+        CHECK(server.getRequests() == 1);
+    }
+}
+
+
+/// @brief Test the pool counters on sequential requests.
+/**
+@param[in] closeAfter The number of responses per server connection,
+    zero to keep alive.
+@param[in] maxPerHost The maximum number of idle client connections,
+    zero to disable persistent connections.
+*/
+void testCounters(size_t closeAfter, size_t maxPerHost)
+{
+    const size_t N = 4;
+
+    boost::asio::io_service ios;
+    bench::LoopbackServer server(ios);
+    server.setCloseAfter(closeAfter);
+
+    http::Client::SharedPtr client = http::Client::create(ios);
+    client->setKeepAlive(maxPerHost);
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        const size_t closed = server.getClosed();
+        CHECK(!sendAndWait(ios, client, http::Request::GET(server.getUrl("/"))));
+
+        // wait the server closes connection and client sees it
+        if (closeAfter && 0 == (i+1)%closeAfter)
+        {
+            while (server.getClosed() == closed && ios.run_one())
+                ;
+            boost::asio::deadline_timer(ios, boost::posix_time::milliseconds(10)).wait();
+        }
+    }
+
+    CHECK(server.getRequests() == N);
+    if (!maxPerHost) // no pool
+    {
+        CHECK(server.getConnections() == N);
+        CHECK(client->getPoolHits() == 0);
+        CHECK(client->getPoolMisses() == 0);
+    }
+    else if (!closeAfter) // one connection reused
+    {
+        CHECK(server.getConnections() == 1);
+        CHECK(client->getPoolHits() == N-1);
+        CHECK(client->getPoolMisses() == 1);
+    }
+    else // closed connections are not reused
+    {
+        CHECK(server.getConnections() == N/closeAfter);
+        CHECK(client->getPoolHits() == N - N/closeAfter);
+        CHECK(client->getPoolMisses() == N/closeAfter);
+    }
+}
+
+
+int main()
+{
+    log::Logger("/hive/http").setLevel(log::LEVEL_OFF); // expected errors
+
+    testRetry(true);
+    testRetry(false);
+    testCounters(0, 0);
+    testCounters(0, 2);
+    testCounters(1, 2);
+    testCounters(2, 2);
+    return bench::result("test_pool");
+}
@@ -0,0 +1,171 @@
+/** @file
+@brief The TLS session resumption test.
+@author Sergey Polichnoy <sergey.polichnoy@dataart.com>
+
+Sends a few sequential HTTPS requests (each on a new connection)
+to the in-process Boost.Asio SSL server and counts the full and
+resumed TLS handshakes, with session resumption enabled and disabled.
+The server certificate is generated by `make certs`.
+*/
+#include "bench.hpp"
+
+#include <hive/http.hpp>
+
+using namespace hive;
+
+namespace ssl = boost::asio::ssl;
+using boost::asio::ip::tcp;
+
+
+/// @brief The simple HTTPS server.
+/**
+Answers "200 OK" to any request and closes the connection.
+*/
+class Server
+{
+    typedef ssl::stream<tcp::socket> Stream;
+    typedef boost::shared_ptr<Stream> StreamPtr;
+    typedef boost::shared_ptr<boost::asio::streambuf> BufferPtr;
+
+public:
+
+    /// @brief The main constructor.
+    /**
+    @param[in] ios The IO service.
+    @param[in] tls13 Use TLS 1.3 session tickets or TLS 1.2 session IDs.
+    */
+    Server(boost::asio::io_service &ios, bool tls13)
+        : m_ios(ios)
+        , m_context(ssl::context::sslv23)
+        , m_acceptor(ios, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0))
+    {
+        m_context.use_certificate_chain_file("test_tls.crt");
+        m_context.use_private_key_file("test_tls.key", ssl::context::pem);
+        SSL_CTX_set_session_id_context(m_context.native_handle(),
+            (const unsigned char*)"test_tls", 8);
+        if (!tls13)
+            SSL_CTX_set_max_proto_version(m_context.native_handle(), TLS1_2_VERSION);
+        accept();
+    }
+
+    /// @brief Get the server URL.
+    String getUrl() const
+    {
+        OStringStream oss;
+        oss << "https://localhost:" << m_acceptor.local_endpoint().port() << "/";
+        return oss.str();
+    }
+
+private:
+
+    /// @brief Accept the next connection.
+    void accept()
+    {
+        StreamPtr s(new Stream(m_ios, m_context));
+        m_acceptor.async_accept(s->lowest_layer(),
+            boost::bind(&Server::onAccept, this, _1, s));
+    }
+
+    void onAccept(boost::system::error_code err, StreamPtr s)
+    {
+        if (!err)
+            s->async_handshake(ssl::stream_base::server,
+                boost::bind(&Server::onHandshake, this, _1, s));
+        accept();
+    }
+
+    void onHandshake(boost::system::error_code err, StreamPtr s)
+    {
+        if (err)
+            return;
+
+        BufferPtr buf(new boost::asio::streambuf());
+        boost::asio::async_read_until(*s, *buf, "\r\n\r\n",
+            boost::bind(&Server::onRequest, this, _1, s, buf));
+    }
+
+    void onRequest(boost::system::error_code err, StreamPtr s, BufferPtr)
+    {
+        if (err)
+            return;
+
+        static const char RESPONSE[] = "HTTP/1.1 200 OK\r\n"
+            "Content-Length: 2\r\nConnection: close\r\n\r\nOK";
+        boost::asio::async_write(*s, boost::asio::buffer(RESPONSE, sizeof(RESPONSE)-1),
+            boost::bind(&Server::onResponse, this, _1, s));
+    }
+
+    void onResponse(boost::system::error_code, StreamPtr s)
+    {
+        boost::system::error_code ignored;
+        s->lowest_layer().close(ignored);
+    }
+
+private:
+    boost::asio::io_service &m_ios;
+    ssl::context m_context;
+    tcp::acceptor m_acceptor;
+};
+
+
+/// @brief The response callback.
+void onResponse(boost::system::error_code err, http::Request::SharedPtr,
+    http::Response::SharedPtr response, int *ok)
+{
+    if (!err && response && 200 == response->getStatusCode()
+        && response->getContent() == "OK")
+            *ok += 1;
+}
+
+
+/// @brief Send a few sequential requests.
+/**
+@param[in] tls13 Use TLS 1.3 or TLS 1.2.
+@param[in] resumption The TLS session resumption flag.
+@param[out] full The number of full handshakes.
+@param[out] resumed The number of resumed handshakes.
+@return The number of successful requests.
+*/
+int run(bool tls13, bool resumption, size_t &full, size_t &resumed)
+{
+    boost::asio::io_service ios;
+    Server server(ios, tls13);
+
+    http::Client::SharedPtr client = http::Client::create(ios);
+    client->setTlsResumption(resumption);
+
+    const http::Url url(server.getUrl());
+    int ok = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        client->send(http::Request::GET(url),
+            boost::bind(onResponse, _1, _2, _3, &ok), 5000);
+        while (ok == i && ios.run_one()) // wait response
+            ;
+    }
+
+    full = client->getTlsFullHandshakes();
+    resumed = client->getTlsResumedHandshakes();
+    return ok;
+}
+
+
+/// @brief Test the resumption with the TLS version.
+void testResumption(bool tls13)
+{
+    size_t full = 0, resumed = 0;
+
+    CHECK(run(tls13, true, full, resumed) == 3);
+    CHECK(full == 1 && resumed == 2);
+
+    CHECK(run(tls13, false, full, resumed) == 3);
+    CHECK(full == 3 && resumed == 0);
+}
+
+
+int main()
+{
+    testResumption(true);  // session tickets
+    testResumption(false); // session IDs
+    return bench::result("test_tls");
+}